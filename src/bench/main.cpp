@@ -0,0 +1,965 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "game/enemy_mesh.hpp"
+#include "game/frame_pipeline.hpp"
+#include "game/headless_services.hpp"
+#include "game/job_system.hpp"
+#include "game/render_commands.hpp"
+#include "game/rng.hpp"
+#include "game/scene_recorder.hpp"
+#include "game/snapshot.hpp"
+#include "game/software_raster.hpp"
+#include "game/space_shooter.hpp"
+#include "game/spatial_grid.hpp"
+#include "game/starfield.hpp"
+#include "game/swept_collision.hpp"
+#include "game/text_layout.hpp"
+#include "game/frame_context.hpp"
+
+// Micro-benchmarks for the simulation core: bench [broadphase|swept|jobs|starfield|ui|mesh|snapshot|rng|render|raster]
+// Stress scenarios with per-tick percentiles and regression gating:
+//   bench stress [--json FILE] [--baseline FILE] [--threshold PCT]
+// Enemy fire up to 40k live shots, exit code 1 over the frame budget:
+//   bench projectiles [--budget-ms MS]
+
+typedef std::chrono::steady_clock BenchClock;
+
+// Median of `reps` runs of fn, in microseconds
+template <typename Fn>
+static double MedianMicros(int reps, Fn&& fn) {
+    std::vector<double> samples;
+    for (int r = 0; r < reps; r++) {
+        auto start = BenchClock::now();
+        fn();
+        auto end = BenchClock::now();
+        samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// Bullet-vs-enemy first-hit search, brute force against the uniform grid
+static void BenchBroadphase() {
+    struct Density { int bullets; int enemies; };
+    const Density densities[] = {
+        {50, 20}, {200, 100}, {1000, 200}, {2000, 1000}, {10000, 1000}, {10000, 5000}
+    };
+    const Viewport vp(800, 600);
+    const FrameContext frame(vp);
+    const float enemyRadius = frame.enemyRadius;
+    const float bulletRadius = frame.bulletRadius;
+    
+    std::printf("%-16s %12s %12s %9s %8s\n", "bullets x enemy", "brute (us)", "grid (us)", "speedup", "hits");
+    for (const Density& d : densities) {
+        SeededRandom rng(7);
+        std::vector<Vec2> bullets(d.bullets), enemies(d.enemies);
+        for (auto& b : bullets) b = Vec2((float)rng.GetRandomValue(0, vp.width), (float)rng.GetRandomValue(0, vp.height));
+        for (auto& e : enemies) e = Vec2((float)rng.GetRandomValue(0, vp.width), (float)rng.GetRandomValue(0, vp.height));
+        
+        long bruteHits = 0, gridHits = 0;
+        int reps = d.bullets * d.enemies > 5000000 ? 5 : 25;
+        
+        double brute = MedianMicros(reps, [&] {
+            bruteHits = 0;
+            for (const Vec2& b : bullets) {
+                for (int i = 0; i < d.enemies; i++) {
+                    if (CirclesOverlap(enemies[i], enemyRadius, b, bulletRadius)) {
+                        bruteHits += i + 1;
+                        break;
+                    }
+                }
+            }
+        });
+        
+        SpatialGrid grid;
+        double gridTime = MedianMicros(reps, [&] {
+            gridHits = 0;
+            grid.Begin((float)vp.width, (float)vp.height, 2 * enemyRadius);
+            for (int i = 0; i < d.enemies; i++) grid.Insert(i, enemies[i]);
+            grid.Finish();
+            for (const Vec2& b : bullets) {
+                int hit = -1;
+                grid.Query(b, enemyRadius + bulletRadius, [&](int i) {
+                    if ((hit < 0 || i < hit) && CirclesOverlap(enemies[i], enemyRadius, b, bulletRadius)) hit = i;
+                });
+                if (hit >= 0) gridHits += hit + 1;
+            }
+        });
+        
+        char label[32];
+        std::snprintf(label, sizeof(label), "%d x %d", d.bullets, d.enemies);
+        std::printf("%-16s %12.1f %12.1f %8.1fx %8s\n", label, brute, gridTime,
+                    gridTime > 0 ? brute / gridTime : 0.0, bruteHits == gridHits ? "match" : "DIFFER");
+    }
+}
+
+// One tick of bullets against drifting enemies at several bullet speeds:
+// the discrete overlap test at the end positions against swept tests
+// batched through the scalar and the widest SIMD kernel. Both swept passes
+// must match a brute-force reference; the discrete pass loses the hits a
+// bullet steps over.
+static void BenchSwept() {
+    struct Case { int bullets; int enemies; float speed; };
+    const Case cases[] = {
+        {1000, 200, 6}, {1000, 200, 40}, {10000, 1000, 6}, {10000, 1000, 40}, {20000, 5000, 40}
+    };
+    const Viewport vp(800, 600);
+    const FrameContext frame(vp);
+    const float radii = frame.enemyRadius + frame.bulletRadius;
+    const Vec2 enemyMotion(0, 1.5f);
+    ParticleKernel best = BestParticleKernel();
+    SweptTestFn kernels[2] = {GetSweptKernel(ParticleKernel::Scalar), GetSweptKernel(best)};
+    
+    std::printf("%-16s %6s %14s %12s %12s %10s %10s %6s\n", "bullets x enemy", "speed", "discrete (us)", "scalar (us)",
+                (std::string(ParticleKernelName(best)) + " (us)").c_str(), "disc hits", "swept hits", "check");
+    for (const Case& c : cases) {
+        SeededRandom rng(7);
+        std::vector<Vec2> bullets(c.bullets), enemies(c.enemies);
+        for (auto& b : bullets) b = Vec2((float)rng.GetRandomValue(0, vp.width), (float)rng.GetRandomValue(0, vp.height));
+        for (auto& e : enemies) e = Vec2((float)rng.GetRandomValue(0, vp.width), (float)rng.GetRandomValue(0, vp.height));
+        const Vec2 bulletMotion(0, -c.speed);
+        const Vec2 relative(enemyMotion.x - bulletMotion.x, enemyMotion.y - bulletMotion.y);
+        auto enemyEnd = [&](int i) { return Vec2(enemies[i].x + enemyMotion.x, enemies[i].y + enemyMotion.y); };
+        auto bulletEnd = [&](int b) { return Vec2(bullets[b].x + bulletMotion.x, bullets[b].y + bulletMotion.y); };
+        
+        // Earliest contact, lowest enemy index on ties, summed as a checksum
+        std::vector<int> hit(c.bullets);
+        std::vector<float> toi(c.bullets);
+        SweptPairBatch batch;
+        auto flush = [&](SweptTestFn fn) {
+            fn(SweptPairArrays{batch.x, batch.y, batch.dx, batch.dy, batch.radius, batch.toi}, batch.count);
+            for (int k = 0; k < batch.count; k++) {
+                int s = batch.slot[k];
+                if (batch.toi[k] < toi[s] || (batch.toi[k] == toi[s] && hit[s] >= 0 && batch.id[k] < hit[s])) {
+                    toi[s] = batch.toi[k];
+                    hit[s] = batch.id[k];
+                }
+            }
+            batch.count = 0;
+        };
+        auto add = [&](SweptTestFn fn, int b, int i) {
+            if (batch.Full()) flush(fn);
+            batch.Add(b, i, Vec2(enemies[i].x - bullets[b].x, enemies[i].y - bullets[b].y), relative, radii);
+        };
+        auto checksum = [&] {
+            long sum = 0;
+            for (int b = 0; b < c.bullets; b++) sum += hit[b] + 1;
+            return sum;
+        };
+        
+        std::fill(hit.begin(), hit.end(), -1);
+        std::fill(toi.begin(), toi.end(), SWEPT_MISS);
+        for (int b = 0; b < c.bullets; b++) {
+            for (int i = 0; i < c.enemies; i++) add(kernels[0], b, i);
+        }
+        flush(kernels[0]);
+        long reference = checksum();
+        
+        int reps = c.bullets >= 10000 ? 9 : 25;
+        SpatialGrid grid;
+        long discreteHits = 0;
+        double discrete = MedianMicros(reps, [&] {
+            discreteHits = 0;
+            grid.Begin((float)vp.width, (float)vp.height, 2 * frame.enemyRadius);
+            for (int i = 0; i < c.enemies; i++) grid.Insert(i, enemyEnd(i));
+            grid.Finish();
+            for (int b = 0; b < c.bullets; b++) {
+                Vec2 end = bulletEnd(b);
+                int found = -1;
+                grid.Query(end, radii, [&](int i) {
+                    if ((found < 0 || i < found) && CirclesOverlap(enemyEnd(i), frame.enemyRadius, end, frame.bulletRadius)) found = i;
+                });
+                if (found >= 0) discreteHits++;
+            }
+        });
+        
+        double swept[2];
+        bool match = true;
+        long sweptHits = 0;
+        for (int k = 0; k < 2; k++) {
+            swept[k] = MedianMicros(reps, [&] {
+                std::fill(hit.begin(), hit.end(), -1);
+                std::fill(toi.begin(), toi.end(), SWEPT_MISS);
+                grid.Begin((float)vp.width, (float)vp.height, 2 * frame.enemyRadius);
+                for (int i = 0; i < c.enemies; i++) grid.Insert(i, enemyEnd(i));
+                grid.Finish();
+                float reach = radii + std::fabs(enemyMotion.y);
+                for (int b = 0; b < c.bullets; b++) {
+                    Vec2 end = bulletEnd(b);
+                    grid.QueryBox(Vec2(bullets[b].x - reach, end.y - reach), Vec2(bullets[b].x + reach, bullets[b].y + reach),
+                                  [&](int i) { add(kernels[k], b, i); });
+                }
+                flush(kernels[k]);
+            });
+            match = match && checksum() == reference;
+            sweptHits = c.bullets - std::count(hit.begin(), hit.end(), -1);
+        }
+        
+        char label[32];
+        std::snprintf(label, sizeof(label), "%d x %d", c.bullets, c.enemies);
+        std::printf("%-16s %6.0f %14.1f %12.1f %12.1f %10ld %10ld %6s\n", label, c.speed, discrete, swept[0], swept[1],
+                    discreteHits, sweptHits, match ? "match" : "DIFFER");
+    }
+}
+
+// Full ticks of a crowded game with 1..N threads; hashes must all match
+static void BenchJobScaling() {
+    const int ticks = 60;
+    int maxThreads = (int)std::thread::hardware_concurrency();
+    if (maxThreads < 4) maxThreads = 4;
+    
+    std::printf("%-8s %12s %9s %18s\n", "threads", "tick (us)", "speedup", "state hash");
+    double baseline = 0;
+    uint64_t baselineHash = 0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        FixedClock clock;
+        SeededRandom random(99);
+        AutopilotInput input;
+        FixedViewport viewport(Viewport(1920, 1080));
+        SpaceShooter game(Services{clock, random, input, viewport});
+        JobSystem jobs(threads - 1);
+        game.SetJobSystem(&jobs);
+        game.SetParticleBudget(400000);
+        game.Update();  // leave the menu
+        
+        SeededRandom placement(5);
+        for (int i = 0; i < 20000; i++) {
+            game.SpawnBullet(Vec2((float)placement.GetRandomValue(0, 1920), (float)placement.GetRandomValue(0, 1080)),
+                             Vec2(0, -4));
+        }
+        for (int i = 0; i < 5000; i++) {
+            game.SpawnEnemy(ENEMY_ARMOURED,
+                            Vec2((float)placement.GetRandomValue(0, 1920), (float)placement.GetRandomValue(-1000, 0)),
+                            Vec2(0, 2), 1000);
+        }
+        for (int i = 0; i < 15000; i++) {
+            game.SpawnExplosion(Vec2((float)placement.GetRandomValue(0, 1920), (float)placement.GetRandomValue(0, 1080)),
+                                Palette::Orange);
+        }
+        
+        auto start = BenchClock::now();
+        for (int t = 0; t < ticks; t++) game.Update();
+        auto end = BenchClock::now();
+        double perTick = std::chrono::duration<double, std::micro>(end - start).count() / ticks;
+        uint64_t hash = game.StateHash();
+        if (threads == 1) {
+            baseline = perTick;
+            baselineHash = hash;
+        }
+        std::printf("%-8d %12.1f %8.2fx   %016llx%s\n", threads, perTick, baseline / perTick,
+                    (unsigned long long)hash, hash == baselineHash ? "" : "  MISMATCH");
+    }
+}
+
+// One-off generation vs the per-frame scroll update the renderer pays
+static void BenchStarfield() {
+    const float densities[] = {1.0f, 10.0f, 50.0f};
+    std::printf("%-8s %8s %14s %14s\n", "density", "stars", "generate (us)", "advance (us)");
+    for (float density : densities) {
+        Starfield starfield;
+        starfield.SetDensity(density);
+        double generate = MedianMicros(11, [&] {
+            starfield.Resize(Viewport(1080, 2400));
+            starfield.Resize(Viewport(1920, 1080));
+        }) / 2;
+        double advance = MedianMicros(101, [&] { starfield.Advance(1.0f / 60.0f); });
+        std::printf("%-8.0f %8d %14.1f %14.3f\n", density, starfield.StarCount(), generate, advance);
+    }
+}
+
+// Cost per random value: the old xorshift64* with a modulo, PCG32 one value
+// at a time, PCG32 in batches as explosions use it, and a whole explosion
+static void BenchRng() {
+    const int count = 1 << 20;
+    std::vector<float> out(count);
+    SeededRandom xorshift(1);
+    Rng rng(1, RNG_EXPLOSIONS);
+    double modulo = MedianMicros(11, [&] {
+        for (int i = 0; i < count; i++) out[i] = (float)xorshift.GetRandomValue(0, 360);
+    });
+    double single = MedianMicros(11, [&] {
+        for (int i = 0; i < count; i++) out[i] = (float)rng.Range(0, 360);
+    });
+    double batched = MedianMicros(11, [&] { rng.FillRange(out.data(), count, 0, 360, 1.0f); });
+    
+    ParticleManager particles(ParticleManager::EXPLOSION_PARTICLES * 1000);
+    double explosions = MedianMicros(11, [&] {
+        particles.Clear();
+        for (int i = 0; i < 1000; i++) particles.AddExplosion(Vec2(100, 100), Palette::Orange, rng);
+    });
+    std::printf("%-26s %10s\n", "generator", "ns/value");
+    std::printf("%-26s %10.2f\n", "xorshift64* + modulo", modulo * 1000 / count);
+    std::printf("%-26s %10.2f\n", "pcg32 Range", single * 1000 / count);
+    std::printf("%-26s %10.2f\n", "pcg32 FillRange", batched * 1000 / count);
+    std::printf("explosion (%d particles):  %.3f us\n", ParticleManager::EXPLOSION_PARTICLES, explosions / 1000);
+}
+
+// Stand-in for raylib's MeasureText: default font is roughly 0.6 em per glyph
+static int FakeMeasureText(const char* text, int fontSize) {
+    return (int)(std::strlen(text) * fontSize * 6 / 10);
+}
+
+// HUD updates over 10 s of 60 FPS play with the score changing once a second
+static void BenchUiText() {
+    const int frames = 600;
+    CachedText score, wave, health;
+    TextDrawList list;
+    Viewport vp(800, 600);
+    long formats = CachedText::FormatCount();
+    long measures = CachedText::MeasureCount();
+    long rebuilds = 0;
+    double micros = MedianMicros(1, [&] {
+        for (int f = 0; f < frames; f++) {
+            bool changed = score.SetInt("SCORE: %d", (f / 60) * 10, 20, FakeMeasureText);
+            changed |= wave.SetInt("WAVE: %d", 1 + f / 1200, 16, FakeMeasureText);
+            changed |= health.Set("HEALTH:", 20, FakeMeasureText);
+            if (changed || list.NeedsRebuild(vp)) {
+                list.Begin(vp);
+                list.Add(score, 10, 10, Palette::Orange);
+                list.Add(wave, 10, 35, Palette::Blue);
+                list.Add(health, 620, 10, Palette::Red);
+                rebuilds++;
+            }
+        }
+    });
+    std::printf("frames %d: %ld formats, %ld measures, %ld layout rebuilds (%.1f us total)\n", frames,
+                CachedText::FormatCount() - formats, CachedText::MeasureCount() - measures, rebuilds, micros);
+    std::printf("uncached HUD would do %d formats and %d measures\n", frames * 2, frames * 3);
+}
+
+// Per-enemy sinf/cosf transform (the old DrawEnemy) against the batched
+// table-driven EnemyMesh build, plus the table's worst-case error
+static void BenchEnemyMesh() {
+    const int counts[] = {100, 1000, 10000};
+    const FrameContext frame(Viewport(1920, 1080));
+    std::printf("%-8s %14s %14s %9s\n", "enemies", "per-enemy (us)", "batched (us)", "speedup");
+    for (int count : counts) {
+        SeededRandom rng(3);
+        Archetype enemies("enemies", ENEMY_COMPONENTS, count);
+        for (int i = 0; i < count; i++) {
+            int row = SpawnEnemyRow(enemies, BuiltinEnemyTables(), i % 2,
+                                    Vec2((float)rng.GetRandomValue(0, 1920), (float)rng.GetRandomValue(0, 1080)), Vec2(0, 1));
+            enemies.Column(COL_ROTATION)[row] = (float)rng.GetRandomValue(0, 359);
+            enemies.Column(COL_PREV_ROTATION)[row] = enemies.Column(COL_ROTATION)[row] - 2.0f;
+        }
+        
+        // Same geometry as the batch, with a sin/cos pair per enemy and per
+        // indicator segment the way DrawTriangle/DrawCircle produced it
+        std::vector<MeshVertex> naive;
+        double perEnemy = MedianMicros(25, [&] {
+            naive.clear();
+            const float* rotation = enemies.Column(COL_ROTATION);
+            const float* prevRotation = enemies.Column(COL_PREV_ROTATION);
+            for (int i = 0; i < enemies.Size(); i++) {
+                Vec2 p = Interpolate(enemies.PrevPosition(i), enemies.Position(i), 0.5f);
+                float rad = (prevRotation[i] + (rotation[i] - prevRotation[i]) * 0.5f) * DEG_TO_RAD;
+                float c = cosf(rad), s = sinf(rad);
+                Rgba color = enemies.Colors()[i];
+                const float hull[3][2] = {{0, -15}, {-12, 12}, {12, 12}};
+                MeshVertex v[3];
+                for (int k = 0; k < 3; k++) {
+                    v[k] = MeshVertex{p.x + hull[k][0] * c - hull[k][1] * s, p.y + hull[k][0] * s + hull[k][1] * c, color};
+                    naive.push_back(v[k]);
+                }
+                for (int k = 0; k < 3; k++) {
+                    naive.push_back(v[k]);
+                    naive.push_back(v[(k + 1) % 3]);
+                }
+                if (enemies.Health()[i] <= 1) continue;
+                for (int k = 0; k < EnemyMesh::INDICATOR_SEGMENTS; k++) {
+                    float a0 = k * (360.0f / EnemyMesh::INDICATOR_SEGMENTS) * DEG_TO_RAD;
+                    float a1 = (k + 1) * (360.0f / EnemyMesh::INDICATOR_SEGMENTS) * DEG_TO_RAD;
+                    naive.push_back(MeshVertex{p.x, p.y, color});
+                    naive.push_back(MeshVertex{p.x + cosf(a1) * 3, p.y + sinf(a1) * 3, color});
+                    naive.push_back(MeshVertex{p.x + cosf(a0) * 3, p.y + sinf(a0) * 3, color});
+                }
+            }
+        });
+        EnemyMesh mesh;
+        double batched = MedianMicros(25, [&] { mesh.Build(enemies, BuiltinEnemyTables(), frame, 0.5f); });
+        std::printf("%-8d %14.1f %14.1f %8.2fx\n", count, perEnemy, batched, batched > 0 ? perEnemy / batched : 0.0);
+    }
+    
+    float maxError = 0;
+    for (int i = 0; i < 360 * 64; i++) {
+        float deg = i / 64.0f, s, c;
+        SinCosDegrees(deg, s, c);
+        maxError = std::max(maxError, std::max(std::fabs(s - std::sin(deg * DEG_TO_RAD)),
+                                               std::fabs(c - std::cos(deg * DEG_TO_RAD))));
+    }
+    std::printf("table max error %.2e\n", maxError);
+}
+
+// Starts the game on the first poll, then holds fire and sweeps like the
+// autopilot without ever confirming again, so a game over cannot reset state
+class StressInput : public InputSource {
+public:
+    InputState Poll() override {
+        InputState in;
+        in.confirmPressed = polls == 0;
+        in.fire = true;
+        bool right = (polls / 90) % 2 == 0;
+        in.moveRight = right;
+        in.moveLeft = !right;
+        polls++;
+        return in;
+    }
+    
+private:
+    uint64_t polls = 0;
+};
+
+struct StressResult {
+    std::string name;
+    int ticks = 0;
+    double mean = 0, p50 = 0, p90 = 0, p99 = 0, max = 0;   // microseconds per tick
+    uint64_t hash = 0;
+    int wave = 0;
+    int bullets = 0, enemies = 0, particles = 0;           // at the end of the run
+};
+
+// One scenario: `setup` runs once after the game starts, `refill` before
+// every tick outside the timed region, so only the tick itself is measured
+template <typename Setup, typename Refill>
+static StressResult RunStress(const char* name, int ticks, int particleBudget, Setup&& setup, Refill&& refill) {
+    FixedClock clock;   // one 60 Hz tick per Update
+    SeededRandom random(2024);
+    StressInput input;
+    FixedViewport viewport(Viewport(1920, 1080));
+    SpaceShooter game(Services{clock, random, input, viewport});
+    game.SetParticleBudget(particleBudget);
+    game.SetInvulnerable(true);
+    game.Update();  // leave the menu
+    SeededRandom placement(77);
+    setup(game, placement);
+    
+    std::vector<double> samples;
+    samples.reserve(ticks);
+    for (int t = 0; t < ticks; t++) {
+        refill(game, placement, t);
+        auto start = BenchClock::now();
+        game.Update();
+        auto end = BenchClock::now();
+        samples.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    
+    StressResult r;
+    r.name = name;
+    r.ticks = ticks;
+    for (double v : samples) r.mean += v;
+    r.mean /= ticks;
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double p) { return samples[(size_t)(p * (samples.size() - 1) + 0.5)]; };
+    r.p50 = pct(0.50);
+    r.p90 = pct(0.90);
+    r.p99 = pct(0.99);
+    r.max = samples.back();
+    r.hash = game.StateHash();
+    r.wave = game.GetWave();
+    r.bullets = game.GetBullets().Size();
+    r.enemies = game.GetEnemies().Size();
+    r.particles = game.GetParticles().Count();
+    return r;
+}
+
+// Two draws in a fixed order; argument evaluation order is unspecified
+static Vec2 RandomPoint(SeededRandom& rng, int width, int minY, int maxY) {
+    float x = (float)rng.GetRandomValue(0, width);
+    float y = (float)rng.GetRandomValue(minY, maxY);
+    return Vec2(x, y);
+}
+
+// An autopilot game with the services it refers to
+struct BenchGame {
+    FixedClock clock;   // one 60 Hz tick per Update
+    SeededRandom random;
+    AutopilotInput input;
+    FixedViewport viewport;
+    SpaceShooter game;
+    
+    BenchGame(int width, int height, uint64_t seed = 2024)
+        : random(seed), viewport(Viewport(width, height)), game(Services{clock, random, input, viewport}) {}
+};
+
+// Plays `ticks` of autopilot with an invulnerable player, then adds
+// unkillable armoured enemies in the top half, bullets below the top
+// quarter and explosions anywhere until `particles` are live
+static void PopulateBenchGame(SpaceShooter& game, int width, int height, int ticks, int bullets, int enemies,
+                              int particles) {
+    game.SetParticleBudget(particles > 0 ? 65536 : ParticleManager::DEFAULT_CAPACITY);
+    game.SetInvulnerable(true);
+    for (int t = 0; t < ticks; t++) game.Update();
+    SeededRandom placement(77);
+    for (int i = 0; i < enemies; i++) {
+        game.SpawnEnemy(ENEMY_ARMOURED, RandomPoint(placement, width, 0, height / 2), Vec2(0, 0.5f), 1 << 30);
+    }
+    for (int i = 0; i < bullets; i++) game.SpawnBullet(RandomPoint(placement, width, height / 4, height), Vec2(0, -10));
+    while (game.GetParticles().Count() < particles) {
+        game.SpawnExplosion(RandomPoint(placement, width, 0, height), Palette::Orange);
+    }
+}
+
+// Save/load time and size at a few game sizes. Every state is round-tripped
+// into a second game, which must match the original's hash now and after
+// another 600 ticks on the same input.
+static void BenchSnapshot() {
+    struct Case {
+        const char* name;
+        int ticks;       // autopilot play before the snapshot
+        int bullets;     // extra entities spawned on top
+        int enemies;
+        int particles;
+    };
+    const Case cases[] = {
+        {"menu", 0, 0, 0, 0},
+        {"early_game", 600, 0, 0, 0},
+        {"wave_5", 4 * 20 * DEFAULT_TICK_RATE, 0, 0, 0},
+        {"stress_10k_1k_50k", 60, 10000, 1000, 50000},
+    };
+    std::printf("%-20s %9s %9s %10s %10s %s\n", "state", "entities", "particles", "save (us)", "load (us)", "bytes");
+    for (const Case& c : cases) {
+        BenchGame original(1920, 1080);
+        SpaceShooter& game = original.game;
+        PopulateBenchGame(game, 1920, 1080, c.ticks, c.bullets, c.enemies, c.particles);
+        
+        int entities = game.GetBullets().Size() + game.GetEnemies().Size();
+        int particles = game.GetParticles().Count();
+        SnapshotWriter snapshot;
+        double save = MedianMicros(51, [&] { game.SaveSnapshot(snapshot); });
+        
+        // Another seed, so only the snapshot can make them agree
+        BenchGame restored(1920, 1080, 1);
+        SpaceShooter& copy = restored.game;
+        copy.SetInvulnerable(true);
+        bool loaded = true;
+        double load = MedianMicros(51, [&] { loaded = copy.LoadSnapshot(snapshot.Data(), snapshot.Size()) && loaded; });
+        
+        // One poll per tick at 60 FPS, so this lines the sweeps up
+        restored.input.Seek(copy.GetTickCount());
+        bool same = loaded && copy.StateHash() == game.StateHash();
+        for (int t = 0; t < 600; t++) {
+            game.Update();
+            copy.Update();
+        }
+        same = same && copy.StateHash() == game.StateHash();
+        
+        std::printf("%-20s %9d %9d %10.1f %10.1f %zu%s\n", c.name, entities, particles,
+                    save, load, snapshot.Size(), same ? "" : "  ROUND TRIP MISMATCH");
+    }
+}
+
+// Scene recording and null-backend replay per frame at a few loads, then
+// whole frames (update, record, replay) serial against pipelined. The null
+// backend costs next to nothing, so the pipelined column mostly shows the
+// hand-over cost; with raylib submitting, the overlap hides the shorter of
+// the two stages.
+static void BenchRender() {
+    struct Case {
+        const char* name;
+        int bullets;     // extra entities spawned after 600 ticks of play
+        int enemies;
+        int particles;
+    };
+    const Case cases[] = {
+        {"early_game", 0, 0, 0},
+        {"1k_200_5k", 1000, 200, 5000},
+        {"10k_1k_50k", 10000, 1000, 50000},
+    };
+    const SceneFrameInfo info{1.0, 1.0f / 60.0f, 60};
+    std::printf("%-12s %9s %11s %11s %9s %11s %11s\n", "scene", "commands", "record (us)", "replay (us)",
+                "KB/frame", "serial (ms)", "piped (ms)");
+    for (const Case& c : cases) {
+        BenchGame bench(1920, 1080);
+        SpaceShooter& game = bench.game;
+        PopulateBenchGame(game, 1920, 1080, 600, c.bullets, c.enemies, c.particles);
+        
+        // The first record also carries the star bake; time the steady state
+        SceneRecorder scene(FakeMeasureText);
+        RenderCommandList list;
+        NullRenderBackend backend;
+        scene.Record(game, info, list);
+        double record = MedianMicros(51, [&] { scene.Record(game, info, list); });
+        double replay = MedianMicros(51, [&] { backend.Submit(list); });
+        
+        // 300 frames each way, restarting from the same state
+        SnapshotWriter start;
+        game.SaveSnapshot(start);
+        struct Producer {
+            SpaceShooter* game;
+            SceneRecorder* scene;
+            const SceneFrameInfo* info;
+        } producer{&game, &scene, &info};
+        double frameMs[2];
+        for (int threaded = 0; threaded < 2; threaded++) {
+            game.LoadSnapshot(start.Data(), start.Size());
+            FramePipeline pipeline(threaded != 0);
+            pipeline.SetProducer([](RenderCommandList& out, void* user) {
+                Producer* p = static_cast<Producer*>(user);
+                p->game->Update();
+                p->scene->Record(*p->game, *p->info, out);
+            }, &producer);
+            const int frames = 300;
+            auto begin = BenchClock::now();
+            if (threaded) pipeline.Start();
+            for (int f = 0; f < frames; f++) {
+                if (!threaded) pipeline.Start();
+                const RenderCommandList& frame = pipeline.Finish();
+                if (threaded && f + 1 < frames) pipeline.Start();
+                backend.Submit(frame);
+            }
+            frameMs[threaded] = std::chrono::duration<double, std::milli>(BenchClock::now() - begin).count() / frames;
+        }
+        std::printf("%-12s %9zu %11.1f %11.1f %9.1f %11.3f %11.3f\n", c.name, list.Commands().size(), record, replay,
+                    list.Bytes() / 1024.0, frameMs[0], frameMs[1]);
+    }
+}
+
+// Software rasterizer fill cost at desktop and phone resolution, from 1
+// thread up to every core. Each row's image has to match the 1-thread one.
+static void BenchRaster() {
+    struct Case {
+        const char* name;
+        int width, height;
+        int bullets, enemies, particles;
+    };
+    const Case cases[] = {
+        {"early_game", 800, 600, 0, 0, 0},
+        {"1k_200_5k", 1080, 2400, 1000, 200, 5000},
+        {"10k_1k_50k", 1080, 2400, 10000, 1000, 50000},
+    };
+    int cores = (int)std::thread::hardware_concurrency();
+    if (cores < 1) cores = 1;
+    std::printf("%-12s %9s %7s %8s %9s %10s %9s %9s %s\n", "scene", "size", "threads", "prims", "bin (ms)", "raster (ms)",
+                "Mfrag/s", "overdraw", "deepest");
+    for (const Case& c : cases) {
+        BenchGame bench(c.width, c.height);
+        SpaceShooter& game = bench.game;
+        PopulateBenchGame(game, c.width, c.height, 600, c.bullets, c.enemies, c.particles);
+        
+        SceneRecorder scene(&SoftwareRenderBackend::MeasureText);
+        RenderCommandList list;
+        scene.Record(game, SceneFrameInfo{10.0, 1.0f / 60.0f, 60}, list);
+        std::vector<uint32_t> reference;
+        for (int threads = 1; threads <= cores; threads *= 2) {
+            JobSystem jobs(threads - 1);
+            SoftwareRenderBackend raster(c.width, c.height);
+            raster.SetJobSystem(&jobs);
+            raster.Submit(list);   // warm-up: bins and star layers
+            std::vector<double> bin, fill;
+            for (int r = 0; r < 15; r++) {
+                raster.Submit(list);
+                bin.push_back(raster.Stats().binMs);
+                fill.push_back(raster.Stats().rasterMs);
+            }
+            std::sort(bin.begin(), bin.end());
+            std::sort(fill.begin(), fill.end());
+            double rasterMs = fill[fill.size() / 2];
+            
+            // Overdraw in a separate pass so tracking does not skew the timing
+            raster.SetOverdrawTracking(true);
+            raster.Submit(list);
+            const RasterStats& stats = raster.Stats();
+            if (threads == 1) reference = raster.Pixels();
+            bool same = raster.Pixels() == reference;
+            char size[16];
+            std::snprintf(size, sizeof(size), "%dx%d", c.width, c.height);
+            std::printf("%-12s %9s %7d %8d %9.2f %11.2f %9.0f %9.2f %9d%s\n", c.name, size, threads, stats.primitives,
+                        bin[bin.size() / 2], rasterMs, rasterMs > 0 ? stats.fragments / (rasterMs * 1000.0) : 0.0,
+                        (double)stats.fragments / ((double)c.width * c.height), stats.maxOverdraw,
+                        same ? "" : "  IMAGE DIFFERS");
+            if (threads < cores && threads * 2 > cores) threads = cores / 2;
+        }
+    }
+}
+
+// Enemy fire at bullet-hell density on a 1080x2400 phone viewport. Parked,
+// unkillable turrets over-supply one pattern while the projectile budget
+// caps the live count, so shots keep leaving the screen and being replaced
+// at a steady N. The tick covers firing, movement, despawn and the player
+// hit test; recording the frame is timed on its own. Returns the number of
+// cases from 20k shots up whose p99 tick plus record exceeds `budgetMs`.
+static int BenchProjectiles(double budgetMs) {
+    struct Pattern { const char* name; EnemyWeapon weapon; };
+    // 16 shots every 3 ticks from 64 turrets: ~340 shots a tick, more than
+    // leave the screen even at the largest budget
+    const Pattern patterns[] = {
+        {"radial", {FIRE_RADIAL, 16, 0.05f, 3.0f, 0, 0, 4.0f, Palette::Yellow}},
+        {"spiral", {FIRE_SPIRAL, 16, 0.05f, 3.0f, 0, 7.0f, 4.0f, Palette::SkyBlue}},
+        {"aimed_fan", {FIRE_AIMED_FAN, 16, 0.05f, 3.0f, 60.0f, 0, 4.0f, Palette::Pink}},
+    };
+    const int budgets[] = {5000, 10000, 20000, 40000};
+    const int turrets = 64;
+    const int warmup = 400;
+    const int ticks = 600;
+    const SceneFrameInfo info{1.0, 1.0f / 60.0f, 60};
+    int cores = (int)std::thread::hardware_concurrency();
+    if (cores < 2) cores = 2;
+    
+    std::printf("%-10s %6s %7s %7s %10s %10s %12s %12s %8s %6s\n", "pattern", "shots", "min", "threads", "p50 (us)",
+                "p99 (us)", "hit test (us)", "record (us)", "frame %", "hash");
+    int over = 0;
+    for (const Pattern& pattern : patterns) {
+        for (int budget : budgets) {
+            uint64_t baselineHash = 0;
+            for (int threads = 1; threads <= cores; threads = threads == 1 ? cores : cores + 1) {
+                FixedClock clock;
+                SeededRandom random(2024);
+                StressInput input;
+                FixedViewport viewport(Viewport(1080, 2400));
+                SpaceShooter game(Services{clock, random, input, viewport});
+                JobSystem jobs(threads - 1);
+                game.SetJobSystem(&jobs);
+                EnemyTables tables = BuiltinEnemyTables();
+                tables.types[ENEMY_ARMOURED].weapon = pattern.weapon;
+                game.SetEnemyTables(tables);
+                game.SetProjectileBudget(budget);
+                game.SetInvulnerable(true);
+                game.Update();  // leave the menu
+                SeededRandom placement(77);
+                for (int i = 0; i < turrets; i++) {
+                    game.SpawnEnemy(ENEMY_ARMOURED,
+                                    Vec2((float)placement.GetRandomValue(60, 1020), (float)placement.GetRandomValue(100, 1400)),
+                                    Vec2(0, 0), 1 << 30);
+                }
+                for (int t = 0; t < warmup; t++) game.Update();
+                
+                std::vector<double> samples;
+                int minLive = budget;
+                for (int t = 0; t < ticks; t++) {
+                    auto start = BenchClock::now();
+                    game.Update();
+                    samples.push_back(std::chrono::duration<double, std::micro>(BenchClock::now() - start).count());
+                    minLive = std::min(minLive, game.GetProjectiles().Count());
+                }
+                std::sort(samples.begin(), samples.end());
+                double p50 = samples[samples.size() / 2];
+                double p99 = samples[(size_t)(0.99 * (samples.size() - 1) + 0.5)];
+                
+                const Player& player = game.GetPlayer();
+                const FrameContext& frame = game.GetFrameContext();
+                volatile int sink = 0;
+                double hitTest = MedianMicros(51, [&] {
+                    sink += game.GetProjectiles().FindHit(player.prevPosition, player.position, frame.playerRadius,
+                                                          frame.scale);
+                });
+                SceneRecorder scene(FakeMeasureText);
+                RenderCommandList list;
+                scene.Record(game, info, list);
+                double record = MedianMicros(51, [&] { scene.Record(game, info, list); });
+                
+                double frameShare = (p99 + record) / (1e6 / 60.0) * 100.0;
+                uint64_t hash = game.StateHash();
+                if (threads == 1) baselineHash = hash;
+                if (budget >= 20000 && (p99 + record) / 1000.0 > budgetMs) over++;
+                std::printf("%-10s %6d %7d %7d %10.1f %10.1f %12.1f %12.1f %7.1f%% %6s\n", pattern.name, budget, minLive,
+                            threads, p50, p99, hitTest, record, frameShare, hash == baselineHash ? "match" : "DIFFER");
+            }
+        }
+    }
+    std::printf("budget: p99 tick + record under %.2f ms from 20000 shots up: %s\n", budgetMs,
+                over == 0 ? "ok" : "EXCEEDED");
+    return over;
+}
+
+static std::vector<StressResult> RunStressScenarios() {
+    std::vector<StressResult> results;
+    
+    // 10k bullets flying up through 1k parked, nearly unkillable enemies
+    results.push_back(RunStress("bullets_10k_vs_enemies_1k", 600, ParticleManager::DEFAULT_CAPACITY,
+        [](SpaceShooter& game, SeededRandom& rng) {
+            for (int i = 0; i < 1000; i++) game.SpawnEnemy(ENEMY_ARMOURED, RandomPoint(rng, 1920, 0, 600), Vec2(0, 0), 1 << 30);
+        },
+        [](SpaceShooter& game, SeededRandom& rng, int) {
+            while (game.GetBullets().Size() < 10000) game.SpawnBullet(RandomPoint(rng, 1920, 200, 1080), Vec2(0, -10));
+        }));
+    
+    // 100k live particles, topped up with explosions
+    results.push_back(RunStress("particles_100k", 600, 131072,
+        [](SpaceShooter&, SeededRandom&) {},
+        [](SpaceShooter& game, SeededRandom& rng, int) {
+            while (game.GetParticles().Count() < 100000) {
+                game.SpawnExplosion(RandomPoint(rng, 1920, 0, 1080), Palette::Orange);
+            }
+        }));
+    
+    // 500 explosions every 30 ticks: spiky emit and removal, watch p99
+    results.push_back(RunStress("explosion_bursts", 1200, 65536,
+        [](SpaceShooter&, SeededRandom&) {},
+        [](SpaceShooter& game, SeededRandom& rng, int tick) {
+            if (tick % 30 != 0) return;
+            for (int i = 0; i < 500; i++) game.SpawnExplosion(RandomPoint(rng, 1920, 0, 1080), Palette::Purple);
+        }));
+    
+    // Plain game with the stock spawner until wave 20 (20 s per wave)
+    results.push_back(RunStress("wave_20_survival", (19 * 20 + 1) * DEFAULT_TICK_RATE, ParticleManager::DEFAULT_CAPACITY,
+        [](SpaceShooter&, SeededRandom&) {},
+        [](SpaceShooter&, SeededRandom&, int) {}));
+    
+    return results;
+}
+
+static bool WriteStressJson(const char* path, const std::vector<StressResult>& results) {
+    std::FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+    std::fprintf(f, "{\n  \"unit\": \"us_per_tick\",\n  \"scenarios\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const StressResult& r = results[i];
+        std::fprintf(f, "    {\"name\": \"%s\", \"ticks\": %d, \"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, "
+                        "\"p99\": %.3f, \"max\": %.3f, \"wave\": %d, \"bullets\": %d, \"enemies\": %d, "
+                        "\"particles\": %d, \"state_hash\": \"%016llx\"}%s\n",
+                     r.name.c_str(), r.ticks, r.mean, r.p50, r.p90, r.p99, r.max, r.wave, r.bullets, r.enemies,
+                     r.particles, (unsigned long long)r.hash, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    return std::fclose(f) == 0;
+}
+
+// Pulls `"key": number` for the named scenario out of a file written by
+// WriteStressJson; no general JSON parsing needed
+static bool ReadBaselineValue(const std::string& json, const std::string& name, const char* key, double& value) {
+    size_t at = json.find("\"name\": \"" + name + "\"");
+    if (at == std::string::npos) return false;
+    size_t end = json.find('}', at);
+    size_t field = json.find(std::string("\"") + key + "\": ", at);
+    if (field == std::string::npos || field > end) return false;
+    value = std::strtod(json.c_str() + field + std::strlen(key) + 4, nullptr);
+    return true;
+}
+
+// Returns the number of scenarios whose median tick regressed past the threshold
+static int CompareBaseline(const char* path, const std::vector<StressResult>& results, double thresholdPct) {
+    std::FILE* f = std::fopen(path, "r");
+    if (!f) {
+        std::fprintf(stderr, "cannot read baseline %s\n", path);
+        return -1;
+    }
+    std::string json;
+    char chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) json.append(chunk, n);
+    std::fclose(f);
+    
+    int regressions = 0;
+    std::printf("%-28s %12s %12s %9s\n", "vs baseline (p50)", "base (us)", "now (us)", "change");
+    for (const StressResult& r : results) {
+        double base;
+        if (!ReadBaselineValue(json, r.name, "p50", base) || base <= 0) {
+            std::printf("%-28s %12s\n", r.name.c_str(), "missing");
+            continue;
+        }
+        double change = (r.p50 - base) / base * 100.0;
+        bool bad = change > thresholdPct;
+        if (bad) regressions++;
+        std::printf("%-28s %12.1f %12.1f %+8.1f%%%s\n", r.name.c_str(), base, r.p50, change, bad ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+static int BenchStress(int argc, char** argv) {
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    double thresholdPct = 15.0;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--json") == 0) jsonPath = argv[i + 1];
+        else if (std::strcmp(argv[i], "--baseline") == 0) baselinePath = argv[i + 1];
+        else if (std::strcmp(argv[i], "--threshold") == 0) thresholdPct = std::atof(argv[i + 1]);
+        else {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+    
+    std::vector<StressResult> results = RunStressScenarios();
+    std::printf("%-28s %7s %9s %9s %9s %9s %9s %5s\n", "scenario (us/tick)", "ticks", "mean", "p50", "p90", "p99",
+                "max", "wave");
+    for (const StressResult& r : results) {
+        std::printf("%-28s %7d %9.1f %9.1f %9.1f %9.1f %9.1f %5d\n", r.name.c_str(), r.ticks, r.mean, r.p50, r.p90,
+                    r.p99, r.max, r.wave);
+    }
+    
+    if (jsonPath && !WriteStressJson(jsonPath, results)) {
+        std::fprintf(stderr, "cannot write %s\n", jsonPath);
+        return 2;
+    }
+    if (baselinePath) {
+        int regressions = CompareBaseline(baselinePath, results, thresholdPct);
+        if (regressions < 0) return 2;
+        if (regressions > 0) {
+            std::printf("%d scenario(s) slower than baseline by more than %.0f%%\n", regressions, thresholdPct);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* which = argc > 1 ? argv[1] : "all";
+    bool all = std::strcmp(which, "all") == 0;
+    
+    // Long-running; only on request
+    if (std::strcmp(which, "stress") == 0) {
+        return BenchStress(argc, argv);
+    }
+    if (std::strcmp(which, "projectiles") == 0) {
+        // A quarter of a 60 Hz frame by default, leaving room for a phone
+        // core several times slower than the machine running the bench
+        double budgetMs = 1000.0 / 60.0 / 4.0;
+        for (int i = 2; i + 1 < argc; i += 2) {
+            if (std::strcmp(argv[i], "--budget-ms") == 0) budgetMs = std::atof(argv[i + 1]);
+            else {
+                std::fprintf(stderr, "unknown option %s\n", argv[i]);
+                return 2;
+            }
+        }
+        return BenchProjectiles(budgetMs) > 0 ? 1 : 0;
+    }
+    
+    if (all || std::strcmp(which, "broadphase") == 0) {
+        std::printf("== broadphase ==\n");
+        BenchBroadphase();
+    }
+    if (all || std::strcmp(which, "swept") == 0) {
+        std::printf("== swept ==\n");
+        BenchSwept();
+    }
+    if (all || std::strcmp(which, "jobs") == 0) {
+        std::printf("== jobs ==\n");
+        BenchJobScaling();
+    }
+    if (all || std::strcmp(which, "starfield") == 0) {
+        std::printf("== starfield ==\n");
+        BenchStarfield();
+    }
+    if (all || std::strcmp(which, "ui") == 0) {
+        std::printf("== ui ==\n");
+        BenchUiText();
+    }
+    if (all || std::strcmp(which, "mesh") == 0) {
+        std::printf("== mesh ==\n");
+        BenchEnemyMesh();
+    }
+    if (all || std::strcmp(which, "snapshot") == 0) {
+        std::printf("== snapshot ==\n");
+        BenchSnapshot();
+    }
+    if (all || std::strcmp(which, "rng") == 0) {
+        std::printf("== rng ==\n");
+        BenchRng();
+    }
+    if (all || std::strcmp(which, "render") == 0) {
+        std::printf("== render ==\n");
+        BenchRender();
+    }
+    if (all || std::strcmp(which, "raster") == 0) {
+        std::printf("== raster ==\n");
+        BenchRaster();
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include "alloc_counter.hpp"
+
+#ifdef ENABLE_ALLOC_COUNTER
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+static thread_local uint64_t threadAllocations = 0;
+static std::atomic<bool> checksArmed(false);
+
+static void DefaultViolationHandler(const char* scope, uint64_t allocations) {
+    std::fprintf(stderr, "%llu heap allocation(s) inside %s after warm-up\n",
+                 (unsigned long long)allocations, scope);
+    assert(false && "heap allocation in an allocation-free scope");
+}
+
+static std::atomic<AllocationViolationFn> violationHandler(&DefaultViolationHandler);
+
+uint64_t ThreadAllocationCount() {
+    return threadAllocations;
+}
+
+void SetAllocationChecksArmed(bool armed) {
+    checksArmed.store(armed, std::memory_order_relaxed);
+}
+
+bool AllocationChecksArmed() {
+    return checksArmed.load(std::memory_order_relaxed);
+}
+
+void SetAllocationViolationHandler(AllocationViolationFn handler) {
+    violationHandler.store(handler ? handler : &DefaultViolationHandler);
+}
+
+AllocFreeScope::~AllocFreeScope() {
+    uint64_t allocations = ThreadAllocationCount() - start;
+    if (allocations > 0 && AllocationChecksArmed()) {
+        violationHandler.load()(name, allocations);
+    }
+}
+
+// Counting replacements for the global allocation functions. The default
+// nothrow forms call these, but libstdc++ and libc++ implement the aligned
+// forms directly on the C allocator, so those are replaced as well.
+void* operator new(std::size_t size) {
+    threadAllocations++;
+    if (size == 0) size = 1;
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    threadAllocations++;
+    if (size == 0) size = 1;
+    size_t alignment = (size_t)align < sizeof(void*) ? sizeof(void*) : (size_t)align;
+#if defined(_WIN32)
+    if (void* p = _aligned_malloc(size, alignment)) return p;
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment, size) == 0) return p;
+#endif
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return operator new(size, align);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void operator delete[](void* p, std::align_val_t align) noexcept {
+    operator delete(p, align);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t align) noexcept {
+    operator delete(p, align);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t align) noexcept {
+    operator delete(p, align);
+}
+
+#endif  // ENABLE_ALLOC_COUNTER
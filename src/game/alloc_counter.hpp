@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+// Debug-only heap allocation tracking. With ENABLE_ALLOC_COUNTER defined
+// (debug builds) the global operator new is replaced to count allocations
+// per thread, and ALLOC_FREE_SCOPE("name") reports any allocation made on
+// the current thread inside the scope once checks are armed. Arm them after
+// warm-up, when pools, arenas and caches have reached their steady size.
+// Without the define everything here compiles to nothing.
+
+typedef void (*AllocationViolationFn)(const char* scope, uint64_t allocations);
+
+#ifdef ENABLE_ALLOC_COUNTER
+
+// Heap allocations made by the calling thread so far
+uint64_t ThreadAllocationCount();
+
+void SetAllocationChecksArmed(bool armed);
+bool AllocationChecksArmed();
+// Called for every violating scope; the default prints and asserts
+void SetAllocationViolationHandler(AllocationViolationFn handler);
+
+class AllocFreeScope {
+public:
+    explicit AllocFreeScope(const char* name) : name(name), start(ThreadAllocationCount()) {}
+    ~AllocFreeScope();
+    
+    AllocFreeScope(const AllocFreeScope&) = delete;
+    AllocFreeScope& operator=(const AllocFreeScope&) = delete;
+    
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#define ALLOC_CONCAT_(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_(a, b)
+#define ALLOC_FREE_SCOPE(name) AllocFreeScope ALLOC_CONCAT(allocFreeScope_, __LINE__)(name)
+
+#else
+
+#define ALLOC_FREE_SCOPE(name) ((void)0)
+
+#endif  // ENABLE_ALLOC_COUNTER
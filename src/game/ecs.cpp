@@ -0,0 +1,256 @@
+#include "ecs.hpp"
+#include "snapshot.hpp"
+
+// Which float columns each component owns
+static uint32_t FloatColumnMask(uint32_t components) {
+    uint32_t cols = 0;
+    if (components & COMP_POSITION) cols |= (1u << COL_X) | (1u << COL_Y);
+    if (components & COMP_PREV_POSITION) cols |= (1u << COL_PREV_X) | (1u << COL_PREV_Y);
+    if (components & COMP_VELOCITY) cols |= (1u << COL_VX) | (1u << COL_VY);
+    if (components & COMP_COLLIDER) cols |= 1u << COL_RADIUS;
+    if (components & COMP_LIFETIME) cols |= (1u << COL_LIFE) | (1u << COL_MAX_LIFE);
+    if (components & COMP_SHAPE) cols |= 1u << COL_SIZE;
+    if (components & COMP_SPIN) cols |= (1u << COL_ROTATION) | (1u << COL_PREV_ROTATION) | (1u << COL_SPIN);
+    if (components & COMP_WEAPON) cols |= (1u << COL_FIRE_TIMER) | (1u << COL_FIRE_ANGLE);
+    return cols;
+}
+
+Archetype::Archetype(const char* name, uint32_t components, int initialCapacity, int maxCapacity)
+    : name(name), mask(components), limit(maxCapacity > initialCapacity ? maxCapacity : initialCapacity) {
+    uint32_t cols = FloatColumnMask(mask);
+    for (int c = 0; c < FLOAT_COLUMN_COUNT; c++) {
+        if (cols & (1u << c)) usedFloats[usedFloatCount++] = c;
+    }
+    Resize(initialCapacity > 0 ? initialCapacity : 0);
+}
+
+void Archetype::Resize(int newCapacity) {
+    for (int k = 0; k < usedFloatCount; k++) {
+        floats[usedFloats[k]].resize(newCapacity);
+    }
+    if (mask & COMP_HEALTH) health.resize(newCapacity);
+    if (mask & COMP_SHAPE) {
+        colors.resize(newCapacity);
+        shapes.resize(newCapacity);
+    }
+    if (mask & COMP_KIND) kinds.resize(newCapacity);
+    alive.resize(newCapacity);
+    
+    if (mask & COMP_HANDLE) {
+        uint32_t old = (uint32_t)slots.size();
+        owners.resize(newCapacity);
+        slots.resize(newCapacity);
+        // Thread new slots onto the free list so low slots are used first
+        for (uint32_t i = (uint32_t)newCapacity; i-- > old;) {
+            slots[i] = Slot{UINT32_MAX, 0, freeHead};
+            freeHead = i;
+        }
+    }
+    capacity = newCapacity;
+}
+
+bool Archetype::Grow() {
+    if (capacity >= limit) return false;
+    int next = capacity > 0 ? capacity * 2 : 16;
+    Resize(next < limit ? next : limit);
+    return true;
+}
+
+void Archetype::ReleaseStorage() {
+    for (auto& column : floats) column.clear();
+    health.clear();
+    colors.clear();
+    shapes.clear();
+    kinds.clear();
+    alive.clear();
+    owners.clear();
+    slots.clear();
+    freeHead = UINT32_MAX;
+    count = 0;
+    capacity = 0;
+}
+
+void Archetype::SetCapacity(int newCapacity) {
+    if (newCapacity < 0) newCapacity = 0;
+    Clear();
+    ReleaseStorage();
+    limit = newCapacity;
+    Resize(newCapacity);
+}
+
+int Archetype::Spawn() {
+    if (count == capacity && !Grow()) {
+        dropped++;
+        return -1;
+    }
+    int row = count++;
+    for (int k = 0; k < usedFloatCount; k++) {
+        floats[usedFloats[k]][row] = 0.0f;
+    }
+    if (mask & COMP_HEALTH) health[row] = 0;
+    if (mask & COMP_SHAPE) {
+        colors[row] = Rgba{255, 255, 255, 255};
+        shapes[row] = ShapeKind::Dot;
+    }
+    if (mask & COMP_KIND) kinds[row] = 0;
+    alive[row] = 1;
+    
+    if (mask & COMP_HANDLE) {
+        uint32_t slot = freeHead;
+        freeHead = slots[slot].nextFree;
+        slots[slot].row = (uint32_t)row;
+        owners[row] = slot;
+    }
+    return row;
+}
+
+PoolHandle Archetype::HandleAt(int row) const {
+    if (!(mask & COMP_HANDLE)) return PoolHandle();
+    uint32_t slot = owners[row];
+    return PoolHandle{slot, slots[slot].generation};
+}
+
+int Archetype::RowOf(PoolHandle handle) const {
+    if (!(mask & COMP_HANDLE) || handle.slot >= slots.size()) return -1;
+    const Slot& s = slots[handle.slot];
+    if (s.generation != handle.generation || s.row == UINT32_MAX) return -1;
+    return (int)s.row;
+}
+
+bool Archetype::Despawn(PoolHandle handle) {
+    int row = RowOf(handle);
+    if (row < 0) return false;
+    RemoveAt(row);
+    return true;
+}
+
+void Archetype::Release(uint32_t slot) {
+    Slot& s = slots[slot];
+    s.row = UINT32_MAX;
+    s.generation++;
+    s.nextFree = freeHead;
+    freeHead = slot;
+}
+
+void Archetype::RemoveAt(int row) {
+    int last = --count;
+    uint32_t slot = (mask & COMP_HANDLE) ? owners[row] : 0;
+    if (row != last) {
+        for (int k = 0; k < usedFloatCount; k++) {
+            float* column = floats[usedFloats[k]].data();
+            column[row] = column[last];
+        }
+        if (!health.empty()) health[row] = health[last];
+        if (!colors.empty()) {
+            colors[row] = colors[last];
+            shapes[row] = shapes[last];
+        }
+        if (!kinds.empty()) kinds[row] = kinds[last];
+        alive[row] = alive[last];
+        if (mask & COMP_HANDLE) {
+            owners[row] = owners[last];
+            slots[owners[row]].row = (uint32_t)row;
+        }
+    }
+    if (mask & COMP_HANDLE) Release(slot);
+}
+
+void Archetype::RemoveDead() {
+    const float* life = Column(COL_LIFE);
+    // The row moved into a hole is checked again before moving on
+    int i = 0;
+    while (i < count) {
+        bool dead = !alive[i] || (life && life[i] <= 0);
+        if (dead) RemoveAt(i);
+        else i++;
+    }
+}
+
+void Archetype::Clear() {
+    if (mask & COMP_HANDLE) {
+        for (int row = count; row-- > 0;) Release(owners[row]);
+    }
+    count = 0;
+}
+
+// Only the live rows of each column are written; the handle slot table is
+// written whole because free slots keep their generations and list order
+void Archetype::Save(SnapshotWriter& out) const {
+    out.PutU32(mask);
+    out.PutI32(count);
+    out.PutI32(capacity);
+    out.PutI32(limit);
+    out.PutU64((uint64_t)dropped);
+    for (int k = 0; k < usedFloatCount; k++) {
+        out.PutArray32(floats[usedFloats[k]].data(), count);
+    }
+    if (mask & COMP_HEALTH) out.PutArray32(health.data(), count);
+    if (mask & COMP_SHAPE) {
+        out.PutBytes(colors.data(), sizeof(Rgba) * count);
+        out.PutBytes(shapes.data(), sizeof(ShapeKind) * count);
+    }
+    if (mask & COMP_KIND) out.PutBytes(kinds.data(), count);
+    out.PutBytes(alive.data(), count);
+    if (mask & COMP_HANDLE) {
+        out.PutArray32(owners.data(), count);
+        out.PutArray32(slots.data(), capacity * 3);
+        out.PutU32(freeHead);
+    }
+}
+
+bool Archetype::Load(SnapshotReader& in) {
+    static_assert(sizeof(Slot) == 12, "Slot is written as three 32-bit words");
+    if (in.GetU32() != mask) {
+        in.Fail("entity components differ");
+        return false;
+    }
+    int savedCount = in.GetI32();
+    int savedCapacity = in.GetI32();
+    int savedLimit = in.GetI32();
+    uint64_t savedDropped = in.GetU64();
+    if (!in.Ok()) return false;
+    if (savedCount < 0 || savedCapacity < savedCount || savedLimit < savedCapacity || savedLimit > (1 << 26)) {
+        in.Fail("bad entity counts");
+        return false;
+    }
+    
+    if (savedCapacity != capacity) {
+        ReleaseStorage();
+        Resize(savedCapacity);
+    }
+    limit = savedLimit;
+    dropped = (long)savedDropped;
+    count = savedCount;
+    for (int k = 0; k < usedFloatCount; k++) {
+        in.GetArray32(floats[usedFloats[k]].data(), count);
+    }
+    if (mask & COMP_HEALTH) in.GetArray32(health.data(), count);
+    if (mask & COMP_SHAPE) {
+        in.GetBytes(colors.data(), sizeof(Rgba) * count);
+        in.GetBytes(shapes.data(), sizeof(ShapeKind) * count);
+    }
+    if (mask & COMP_KIND) in.GetBytes(kinds.data(), count);
+    in.GetBytes(alive.data(), count);
+    if (mask & COMP_HANDLE) {
+        in.GetArray32(owners.data(), count);
+        in.GetArray32(slots.data(), capacity * 3);
+        freeHead = in.GetU32();
+        // Every index used later must stay inside the table
+        bool valid = freeHead == UINT32_MAX || freeHead < (uint32_t)capacity;
+        for (int row = 0; valid && row < count; row++) {
+            valid = owners[row] < (uint32_t)capacity && slots[owners[row]].row == (uint32_t)row;
+        }
+        for (int i = 0; valid && i < capacity; i++) {
+            valid = slots[i].nextFree == UINT32_MAX || slots[i].nextFree < (uint32_t)capacity;
+        }
+        if (!valid) in.Fail("bad entity handles");
+    }
+    if (!in.Ok()) {
+        // Back to an empty, consistent table
+        int keep = capacity;
+        ReleaseStorage();
+        Resize(keep);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "pool.hpp"
+#include "types.hpp"
+
+class SnapshotReader;
+class SnapshotWriter;
+
+// Minimal archetype ECS. An Archetype stores every entity with the same set
+// of components as parallel, tightly packed columns (structure of arrays);
+// systems are plain functions that loop over the columns they need. Adding
+// a new kind of entity means choosing a component mask and filling in
+// columns, not writing a new struct with its own Update and Draw.
+//
+// Rows are dense: removal swaps the last row into the hole, so row order is
+// not spawn order. Anything that kills an entity mid-tick clears its alive
+// flag and RemoveDead() sweeps the archetype at the end of the tick.
+
+enum Component : uint32_t {
+    COMP_POSITION      = 1 << 0,   // x, y
+    COMP_PREV_POSITION = 1 << 1,   // position at the start of the tick, for interpolation
+    COMP_VELOCITY      = 1 << 2,   // vx, vy per tick
+    COMP_COLLIDER      = 1 << 3,   // radius at scale 1; multiply by FrameContext::scale
+    COMP_HEALTH        = 1 << 4,   // hit points
+    COMP_LIFETIME      = 1 << 5,   // seconds left and initial lifetime; dead at <= 0
+    COMP_SHAPE         = 1 << 6,   // render shape kind, colour and size
+    COMP_SPIN          = 1 << 7,   // rotation in degrees and spin per 60 Hz tick
+    COMP_HANDLE        = 1 << 8,   // stable generational handles (PoolHandle)
+    COMP_KIND          = 1 << 9,   // index into a type table, e.g. EnemyTables::types
+    COMP_WEAPON        = 1 << 10,  // seconds to the next volley and spiral angle in degrees
+};
+
+enum FloatColumn {
+    COL_X, COL_Y,                     // COMP_POSITION
+    COL_PREV_X, COL_PREV_Y,           // COMP_PREV_POSITION
+    COL_VX, COL_VY,                   // COMP_VELOCITY
+    COL_RADIUS,                       // COMP_COLLIDER
+    COL_LIFE, COL_MAX_LIFE,           // COMP_LIFETIME
+    COL_SIZE,                         // COMP_SHAPE
+    COL_ROTATION, COL_PREV_ROTATION,  // COMP_SPIN
+    COL_SPIN,
+    COL_FIRE_TIMER, COL_FIRE_ANGLE,   // COMP_WEAPON
+    FLOAT_COLUMN_COUNT
+};
+
+enum class ShapeKind : uint8_t {
+    Dot,      // filled circle of `size`, fading with lifetime if it has one
+    Bullet,   // circle of the collider radius with a bright core
+    Ship,     // rotating triangle hull
+    Shot,     // enemy projectile: circle of the collider radius
+};
+
+class Archetype {
+public:
+    // Grows by doubling from initialCapacity up to maxCapacity (0 = fixed)
+    Archetype(const char* name, uint32_t components, int initialCapacity, int maxCapacity = 0);
+    
+    const char* Name() const { return name; }
+    uint32_t Components() const { return mask; }
+    bool Has(uint32_t components) const { return (mask & components) == components; }
+    
+    // Appends a row with every column zeroed and alive set, and returns its
+    // index (always Size() - 1), or -1 if the archetype is at its limit
+    int Spawn();
+    // Requires COMP_HANDLE
+    PoolHandle HandleAt(int row) const;
+    int RowOf(PoolHandle handle) const;   // -1 if the handle is stale
+    bool Despawn(PoolHandle handle);
+    
+    void RemoveAt(int row);
+    // Removes rows with alive cleared or, with COMP_LIFETIME, life <= 0
+    void RemoveDead();
+    void Clear();
+    // Reallocates to exactly `capacity` rows (fixed size) and drops all rows
+    void SetCapacity(int capacity);
+    
+    // Live rows, capacity and handle slots, exactly; Load reallocates only
+    // if the capacity differs and fails on a different component mask
+    void Save(SnapshotWriter& out) const;
+    bool Load(SnapshotReader& in);
+    
+    int Size() const { return count; }
+    int Capacity() const { return capacity; }
+    int Limit() const { return limit; }
+    // Spawns rejected at the limit, since construction
+    long Dropped() const { return dropped; }
+    bool Empty() const { return count == 0; }
+    
+    // Column storage; columns of absent components are null
+    float* Column(FloatColumn c) { return floats[c].empty() ? nullptr : floats[c].data(); }
+    const float* Column(FloatColumn c) const { return floats[c].empty() ? nullptr : floats[c].data(); }
+    int* Health() { return health.empty() ? nullptr : health.data(); }
+    const int* Health() const { return health.empty() ? nullptr : health.data(); }
+    Rgba* Colors() { return colors.empty() ? nullptr : colors.data(); }
+    const Rgba* Colors() const { return colors.empty() ? nullptr : colors.data(); }
+    ShapeKind* Shapes() { return shapes.empty() ? nullptr : shapes.data(); }
+    const ShapeKind* Shapes() const { return shapes.empty() ? nullptr : shapes.data(); }
+    uint8_t* Kinds() { return kinds.empty() ? nullptr : kinds.data(); }
+    const uint8_t* Kinds() const { return kinds.empty() ? nullptr : kinds.data(); }
+    uint8_t* Alive() { return alive.data(); }
+    const uint8_t* Alive() const { return alive.data(); }
+    
+    // Convenience accessors for single rows
+    Vec2 Position(int row) const { return Vec2(floats[COL_X][row], floats[COL_Y][row]); }
+    Vec2 PrevPosition(int row) const { return Vec2(floats[COL_PREV_X][row], floats[COL_PREV_Y][row]); }
+    bool IsAlive(int row) const { return alive[row] != 0; }
+    void Kill(int row) { alive[row] = 0; }
+    
+private:
+    struct Slot {
+        uint32_t row;
+        uint32_t generation;
+        uint32_t nextFree;
+    };
+    
+    bool Grow();
+    void Resize(int newCapacity);
+    void ReleaseStorage();
+    void Release(uint32_t slot);
+    
+    const char* name;
+    uint32_t mask;
+    int count = 0;
+    int capacity = 0;
+    int limit;
+    long dropped = 0;
+    
+    std::vector<float> floats[FLOAT_COLUMN_COUNT];
+    int usedFloats[FLOAT_COLUMN_COUNT];   // indices of the columns this archetype has
+    int usedFloatCount = 0;
+    std::vector<int> health;
+    std::vector<Rgba> colors;
+    std::vector<ShapeKind> shapes;
+    std::vector<uint8_t> kinds;
+    std::vector<uint8_t> alive;
+    
+    // COMP_HANDLE only
+    std::vector<uint32_t> owners;   // row -> slot
+    std::vector<Slot> slots;
+    uint32_t freeHead = UINT32_MAX;
+};
@@ -0,0 +1,123 @@
+#include "enemy_mesh.hpp"
+#include <cmath>
+
+// Power of two so the wrap is a mask; one extra entry saves a wrap on lookup
+static const int SINCOS_STEPS = 1024;
+
+struct SinCosTable {
+    float sine[SINCOS_STEPS + 1];
+    
+    SinCosTable() {
+        for (int i = 0; i <= SINCOS_STEPS; i++) {
+            sine[i] = (float)std::sin(i * (2.0 * 3.14159265358979323846 / SINCOS_STEPS));
+        }
+    }
+};
+
+static const SinCosTable& Table() {
+    static const SinCosTable table;
+    return table;
+}
+
+void SinCosDegrees(float degrees, float& s, float& c) {
+    const SinCosTable& table = Table();
+    float pos = degrees * (SINCOS_STEPS / 360.0f);
+    float whole = std::floor(pos);
+    float frac = pos - whole;
+    int i = (int)whole & (SINCOS_STEPS - 1);
+    // cos(x) = sin(x + 90 degrees)
+    int j = (i + SINCOS_STEPS / 4) & (SINCOS_STEPS - 1);
+    s = table.sine[i] + (table.sine[i + 1] - table.sine[i]) * frac;
+    c = table.sine[j] + (table.sine[j + 1] - table.sine[j]) * frac;
+}
+
+constexpr Rgba EnemyMesh::OUTLINE;
+constexpr Rgba EnemyMesh::INDICATOR;
+
+void EnemyMesh::Build(const Archetype& enemies, const EnemyTables& tables, const FrameContext& frame, float alpha) {
+    hulls.clear();
+    outlines.clear();
+    indicators.clear();
+    
+    float scale = frame.scale;
+    // Ship corners relative to its centre, before rotation, per type
+    float typeHulls[MAX_ENEMY_TYPES][3][2];
+    for (int t = 0; t < tables.typeCount; t++) {
+        for (int k = 0; k < 3; k++) {
+            typeHulls[t][k][0] = tables.types[t].hull[k].x * scale;
+            typeHulls[t][k][1] = tables.types[t].hull[k].y * scale;
+        }
+    }
+    
+    // Unit circle for the health indicator, shared by every enemy
+    float indicatorRadius = 3 * scale;
+    float ring[INDICATOR_SEGMENTS + 1][2];
+    for (int k = 0; k <= INDICATOR_SEGMENTS; k++) {
+        float s, c;
+        SinCosDegrees(k * (360.0f / INDICATOR_SEGMENTS), s, c);
+        ring[k][0] = c * indicatorRadius;
+        ring[k][1] = s * indicatorRadius;
+    }
+    
+    const float* x = enemies.Column(COL_X);
+    const float* y = enemies.Column(COL_Y);
+    const float* prevX = enemies.Column(COL_PREV_X);
+    const float* prevY = enemies.Column(COL_PREV_Y);
+    const float* rotation = enemies.Column(COL_ROTATION);
+    const float* prevRotation = enemies.Column(COL_PREV_ROTATION);
+    const int* health = enemies.Health();
+    const Rgba* colors = enemies.Colors();
+    const uint8_t* kinds = enemies.Kinds();
+    int n = enemies.Size();
+    
+    // Size the streams up front and write through pointers; no push_back in the loop
+    int live = 0, armoured = 0;
+    for (int i = 0; i < n; i++) {
+        if (!enemies.IsAlive(i)) continue;
+        live++;
+        if (health[i] > 1) armoured++;
+    }
+    // Reserving for the whole archetype means only its growth can reallocate here
+    hulls.reserve(enemies.Capacity() * 3);
+    outlines.reserve(enemies.Capacity() * 6);
+    indicators.reserve(enemies.Capacity() * INDICATOR_SEGMENTS * 3);
+    hulls.resize(live * 3);
+    outlines.resize(live * 6);
+    indicators.resize(armoured * INDICATOR_SEGMENTS * 3);
+    MeshVertex* hullOut = hulls.data();
+    MeshVertex* outlineOut = outlines.data();
+    MeshVertex* indicatorOut = indicators.data();
+    
+    for (int i = 0; i < n; i++) {
+        if (!enemies.IsAlive(i)) continue;
+        Vec2 position(prevX[i] + (x[i] - prevX[i]) * alpha, prevY[i] + (y[i] - prevY[i]) * alpha);
+        float angle = prevRotation[i] + (rotation[i] - prevRotation[i]) * alpha;
+        float s, c;
+        SinCosDegrees(angle, s, c);
+        
+        const float (*hull)[2] = typeHulls[kinds[i]];
+        for (int k = 0; k < 3; k++) {
+            float hx = hull[k][0];
+            float hy = hull[k][1];
+            hullOut[k] = MeshVertex{position.x + hx * c - hy * s, position.y + hx * s + hy * c, colors[i]};
+        }
+        for (int k = 0; k < 3; k++) {
+            const MeshVertex& a = hullOut[k];
+            const MeshVertex& b = hullOut[(k + 1) % 3];
+            outlineOut[2 * k] = MeshVertex{a.x, a.y, OUTLINE};
+            outlineOut[2 * k + 1] = MeshVertex{b.x, b.y, OUTLINE};
+        }
+        hullOut += 3;
+        outlineOut += 6;
+        
+        if (health[i] > 1) {
+            for (int k = 0; k < INDICATOR_SEGMENTS; k++) {
+                // Counter-clockwise on screen to match raylib's DrawTriangle winding
+                indicatorOut[0] = MeshVertex{position.x, position.y, INDICATOR};
+                indicatorOut[1] = MeshVertex{position.x + ring[k + 1][0], position.y + ring[k + 1][1], INDICATOR};
+                indicatorOut[2] = MeshVertex{position.x + ring[k][0], position.y + ring[k][1], INDICATOR};
+                indicatorOut += 3;
+            }
+        }
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include "ecs.hpp"
+#include "enemy_tables.hpp"
+#include "frame_context.hpp"
+#include "types.hpp"
+
+// Sine and cosine of an angle in degrees from a shared table, interpolated
+// between entries; max error is around 1e-5, far below a pixel
+void SinCosDegrees(float degrees, float& s, float& c);
+
+// Transforms every live enemy's ship into flat vertex streams in one pass so
+// the renderer can submit all hulls, all outlines and all health indicators
+// as one batch each instead of per-enemy draw calls. Storage is reused
+// between frames.
+class EnemyMesh {
+public:
+    // Colour of the outline and health-indicator geometry
+    static constexpr Rgba OUTLINE {80, 80, 80, 255};
+    static constexpr Rgba INDICATOR {255, 161, 0, 255};
+    static const int INDICATOR_SEGMENTS = 8;
+    
+    // `enemies` needs POSITION, PREV_POSITION, SPIN, SHAPE, HEALTH and KIND;
+    // each ship takes its hull from its type in `tables`
+    void Build(const Archetype& enemies, const EnemyTables& tables, const FrameContext& frame, float alpha);
+    
+    // Three vertices per triangle
+    const std::vector<MeshVertex>& Hulls() const { return hulls; }
+    // Two vertices per segment
+    const std::vector<MeshVertex>& Outlines() const { return outlines; }
+    // Three vertices per triangle, drawn last
+    const std::vector<MeshVertex>& Indicators() const { return indicators; }
+    
+private:
+    std::vector<MeshVertex> hulls;
+    std::vector<MeshVertex> outlines;
+    std::vector<MeshVertex> indicators;
+};
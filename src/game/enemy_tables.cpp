@@ -0,0 +1,344 @@
+#include "enemy_tables.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "viewport.hpp"
+
+static const char TABLES_MAGIC[4] = {'S', 'D', 'E', 'T'};
+static const uint16_t TABLES_VERSION = 2;
+static const uint16_t TABLES_HEADER_SIZE = 16;
+
+// ---------------------------------------------------------------------------
+// Built-in set
+
+static constexpr EnemyType MakeShip(Rgba color, int health, EnemyWeapon weapon) {
+    return EnemyType{
+        {Vec2(0, -15), Vec2(-12, 12), Vec2(12, 12)},
+        color, health, 1.0f, BASE_ENEMY_RADIUS, 2.0f,
+        6, Palette::Red,
+        10,
+        weapon,
+    };
+}
+
+static constexpr EnemyWeapon UNARMED{FIRE_NONE, 0, 0, 0, 0, 0, 0, Rgba{0, 0, 0, 0}};
+// Armoured ships return fire, fighters do not: three slow shots at the
+// player every 2.5 s
+static constexpr EnemyWeapon ARMOURED_FAN{FIRE_AIMED_FAN, 3, 2.5f, 3.0f, 30.0f, 0, 4.0f, Palette::Pink};
+
+// The original rules: a spawn every 2 s shrinking to 0.5 s over 45 s, a new
+// wave every 20 s, speed +100% a minute, and an armoured chance of
+// 20% + 5% per wave. The roll covers [0, 100], so from wave 17 every enemy
+// is armoured and the last entry repeats.
+static constexpr int BUILTIN_WAVES = 17;
+
+static constexpr EnemyTables MakeBuiltinTables() {
+    EnemyTables t{};
+    t.schedule = WaveSchedule{20.0f, 2.0f, 30.0f, 0.5f, 60.0f};
+    t.typeCount = BUILTIN_ENEMY_TYPE_COUNT;
+    t.types[ENEMY_FIGHTER] = MakeShip(Palette::Red, 1, UNARMED);
+    t.types[ENEMY_ARMOURED] = MakeShip(Palette::Purple, 2, ARMOURED_FAN);
+    t.waveCount = BUILTIN_WAVES;
+    for (int wave = 1; wave <= BUILTIN_WAVES; wave++) {
+        WaveSpec& spec = t.waves[wave - 1];
+        spec.baseType = ENEMY_FIGHTER;
+        spec.pickCount = 1;
+        spec.picks[0] = WavePick{ENEMY_ARMOURED, (uint8_t)(20 + wave * 5)};
+    }
+    return t;
+}
+
+static constexpr EnemyTables BUILTIN_TABLES = MakeBuiltinTables();
+
+static_assert(BUILTIN_TABLES.waves[0].picks[0].percent == 25, "wave 1 is 25% armoured");
+static_assert(BUILTIN_TABLES.waves[BUILTIN_WAVES - 1].picks[0].percent > 100, "the last wave is all armoured");
+static_assert(BUILTIN_TABLES.types[ENEMY_ARMOURED].health == 2, "armoured enemies take two hits");
+static_assert(BUILTIN_TABLES.types[ENEMY_FIGHTER].weapon.pattern == FIRE_NONE, "fighters do not shoot");
+
+const EnemyTables& BuiltinEnemyTables() {
+    return BUILTIN_TABLES;
+}
+
+// ---------------------------------------------------------------------------
+// Binary form
+
+static void PutU8(std::vector<unsigned char>& out, uint8_t v) {
+    out.push_back(v);
+}
+
+static void PutU16(std::vector<unsigned char>& out, uint16_t v) {
+    out.push_back((unsigned char)v);
+    out.push_back((unsigned char)(v >> 8));
+}
+
+static void PutU32(std::vector<unsigned char>& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out.push_back((unsigned char)(v >> (8 * i)));
+}
+
+static void PutF32(std::vector<unsigned char>& out, float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    PutU32(out, bits);
+}
+
+static void PutRgba(std::vector<unsigned char>& out, Rgba c) {
+    PutU8(out, c.r);
+    PutU8(out, c.g);
+    PutU8(out, c.b);
+    PutU8(out, c.a);
+}
+
+static uint32_t Fnv1a32(const unsigned char* data, size_t size) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        h ^= data[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void SerializeEnemyTables(const EnemyTables& tables, std::vector<unsigned char>& out) {
+    out.assign(TABLES_HEADER_SIZE, 0);
+    const WaveSchedule& s = tables.schedule;
+    PutF32(out, s.waveSeconds);
+    PutF32(out, s.firstInterval);
+    PutF32(out, s.intervalRampSeconds);
+    PutF32(out, s.minInterval);
+    PutF32(out, s.speedRampSeconds);
+    for (int i = 0; i < tables.typeCount; i++) {
+        const EnemyType& type = tables.types[i];
+        for (const Vec2& corner : type.hull) {
+            PutF32(out, corner.x);
+            PutF32(out, corner.y);
+        }
+        PutRgba(out, type.color);
+        PutU16(out, (uint16_t)type.health);
+        PutF32(out, type.speed);
+        PutF32(out, type.radius);
+        PutF32(out, type.spin);
+        PutU16(out, (uint16_t)type.trailOneIn);
+        PutRgba(out, type.trailColor);
+        PutU16(out, (uint16_t)type.score);
+        const EnemyWeapon& weapon = type.weapon;
+        PutU8(out, weapon.pattern);
+        PutU8(out, weapon.shots);
+        PutF32(out, weapon.interval);
+        PutF32(out, weapon.speed);
+        PutF32(out, weapon.spread);
+        PutF32(out, weapon.turn);
+        PutF32(out, weapon.radius);
+        PutRgba(out, weapon.color);
+    }
+    for (int w = 0; w < tables.waveCount; w++) {
+        const WaveSpec& spec = tables.waves[w];
+        PutU8(out, spec.baseType);
+        PutU8(out, spec.pickCount);
+        for (int p = 0; p < spec.pickCount; p++) {
+            PutU8(out, spec.picks[p].type);
+            PutU8(out, spec.picks[p].percent);
+        }
+    }
+    
+    unsigned char* header = out.data();
+    std::memcpy(header, TABLES_MAGIC, 4);
+    header[4] = (unsigned char)TABLES_VERSION;
+    header[5] = (unsigned char)(TABLES_VERSION >> 8);
+    header[6] = (unsigned char)TABLES_HEADER_SIZE;
+    header[7] = (unsigned char)(TABLES_HEADER_SIZE >> 8);
+    header[8] = (unsigned char)tables.typeCount;
+    header[9] = (unsigned char)tables.waveCount;
+    uint32_t checksum = Fnv1a32(out.data() + TABLES_HEADER_SIZE, out.size() - TABLES_HEADER_SIZE);
+    for (int i = 0; i < 4; i++) header[12 + i] = (unsigned char)(checksum >> (8 * i));
+}
+
+uint64_t EnemyTablesHash(const EnemyTables& tables) {
+    std::vector<unsigned char> bytes;
+    SerializeEnemyTables(tables, bytes);
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char b : bytes) {
+        h ^= b;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// Bounds-checked cursor; a read past the end returns zeros and latches
+struct TableReader {
+    const unsigned char* p;
+    const unsigned char* end;
+    bool overrun = false;
+    
+    const unsigned char* Take(size_t n) {
+        if ((size_t)(end - p) < n) {
+            overrun = true;
+            p = end;
+            return nullptr;
+        }
+        const unsigned char* at = p;
+        p += n;
+        return at;
+    }
+    uint8_t U8() {
+        const unsigned char* b = Take(1);
+        return b ? b[0] : 0;
+    }
+    uint16_t U16() {
+        const unsigned char* b = Take(2);
+        return b ? (uint16_t)(b[0] | (b[1] << 8)) : 0;
+    }
+    float F32() {
+        const unsigned char* b = Take(4);
+        uint32_t bits = 0;
+        if (b) {
+            for (int i = 0; i < 4; i++) bits |= (uint32_t)b[i] << (8 * i);
+        }
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+    Rgba Color() {
+        Rgba c;
+        c.r = U8();
+        c.g = U8();
+        c.b = U8();
+        c.a = U8();
+        return c;
+    }
+};
+
+static bool Positive(float v) {
+    return std::isfinite(v) && v > 0;
+}
+
+bool ParseEnemyTables(const unsigned char* data, size_t size, EnemyTables& out, const char** error) {
+    const char* why = nullptr;
+    int version = size >= TABLES_HEADER_SIZE ? data[4] | (data[5] << 8) : 0;
+    if (size < TABLES_HEADER_SIZE || std::memcmp(data, TABLES_MAGIC, 4) != 0) {
+        why = "not an enemy table file";
+    } else if (version < 1 || version > TABLES_VERSION) {
+        why = "unsupported enemy table version";
+    } else if ((data[6] | (data[7] << 8)) != TABLES_HEADER_SIZE) {
+        why = "bad enemy table header";
+    } else {
+        uint32_t checksum = 0;
+        for (int i = 0; i < 4; i++) checksum |= (uint32_t)data[12 + i] << (8 * i);
+        if (checksum != Fnv1a32(data + TABLES_HEADER_SIZE, size - TABLES_HEADER_SIZE)) why = "enemy table checksum mismatch";
+    }
+    int typeCount = size >= TABLES_HEADER_SIZE ? data[8] : 0;
+    int waveCount = size >= TABLES_HEADER_SIZE ? data[9] : 0;
+    if (!why && (typeCount < 1 || typeCount > MAX_ENEMY_TYPES || waveCount < 1 || waveCount > MAX_WAVES)) {
+        why = "bad enemy table counts";
+    }
+    if (why) {
+        if (error) *error = why;
+        return false;
+    }
+    
+    // Parsed into a copy so a bad file leaves `out` as it was
+    EnemyTables t{};
+    TableReader in{data + TABLES_HEADER_SIZE, data + size};
+    t.schedule.waveSeconds = in.F32();
+    t.schedule.firstInterval = in.F32();
+    t.schedule.intervalRampSeconds = in.F32();
+    t.schedule.minInterval = in.F32();
+    t.schedule.speedRampSeconds = in.F32();
+    const WaveSchedule& s = t.schedule;
+    if (!Positive(s.waveSeconds) || !Positive(s.firstInterval) || !Positive(s.intervalRampSeconds) ||
+        !Positive(s.minInterval) || !Positive(s.speedRampSeconds)) {
+        why = "bad wave schedule";
+    }
+    
+    t.typeCount = typeCount;
+    for (int i = 0; i < typeCount && !why; i++) {
+        EnemyType& type = t.types[i];
+        bool finite = true;
+        for (Vec2& corner : type.hull) {
+            corner.x = in.F32();
+            corner.y = in.F32();
+            finite = finite && std::isfinite(corner.x) && std::isfinite(corner.y);
+        }
+        type.color = in.Color();
+        type.health = in.U16();
+        type.speed = in.F32();
+        type.radius = in.F32();
+        type.spin = in.F32();
+        type.trailOneIn = in.U16();
+        type.trailColor = in.Color();
+        type.score = in.U16();
+        if (!finite || type.health < 1 || !std::isfinite(type.speed) || !Positive(type.radius) || !std::isfinite(type.spin)) {
+            why = "bad enemy type";
+        }
+        if (version < 2) continue;
+        EnemyWeapon& weapon = type.weapon;
+        weapon.pattern = in.U8();
+        weapon.shots = in.U8();
+        weapon.interval = in.F32();
+        weapon.speed = in.F32();
+        weapon.spread = in.F32();
+        weapon.turn = in.F32();
+        weapon.radius = in.F32();
+        weapon.color = in.Color();
+        bool armed = weapon.pattern != FIRE_NONE;
+        if (weapon.pattern >= FIRE_PATTERN_COUNT ||
+            (armed && (weapon.shots < 1 || !Positive(weapon.interval) || !Positive(weapon.speed) ||
+                       !Positive(weapon.radius) || !std::isfinite(weapon.spread) || !std::isfinite(weapon.turn)))) {
+            why = "bad enemy weapon";
+        }
+    }
+    
+    t.waveCount = waveCount;
+    for (int w = 0; w < waveCount && !why; w++) {
+        WaveSpec& spec = t.waves[w];
+        spec.baseType = in.U8();
+        spec.pickCount = in.U8();
+        if (spec.baseType >= typeCount || spec.pickCount > MAX_WAVE_PICKS) {
+            why = "bad wave";
+            break;
+        }
+        for (int p = 0; p < spec.pickCount; p++) {
+            spec.picks[p].type = in.U8();
+            spec.picks[p].percent = in.U8();
+            if (spec.picks[p].type >= typeCount) why = "bad wave";
+        }
+    }
+    
+    if (!why && in.overrun) why = "truncated enemy table";
+    if (!why && in.p != in.end) why = "trailing data in enemy table";
+    if (why) {
+        if (error) *error = why;
+        return false;
+    }
+    out = t;
+    return true;
+}
+
+bool WriteEnemyTablesFile(const std::string& path, const EnemyTables& tables) {
+    std::vector<unsigned char> bytes;
+    SerializeEnemyTables(tables, bytes);
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    ok = std::fclose(f) == 0 && ok;
+    return ok;
+}
+
+bool ReadEnemyTablesFile(const std::string& path, EnemyTables& out, const char** error) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        if (error) *error = "cannot open file";
+        return false;
+    }
+    std::vector<unsigned char> bytes;
+    unsigned char chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        bytes.insert(bytes.end(), chunk, chunk + n);
+    }
+    bool readOk = !std::ferror(f);
+    std::fclose(f);
+    if (!readOk) {
+        if (error) *error = "cannot read file";
+        return false;
+    }
+    return ParseEnemyTables(bytes.data(), bytes.size(), out, error);
+}
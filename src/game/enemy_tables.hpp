@@ -0,0 +1,147 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "types.hpp"
+
+// Enemy archetypes and the wave schedule as data. Enemies store their type
+// index in the COMP_KIND column, and the update, collision and mesh code
+// look their parameters up there instead of branching on health or colour.
+//
+// The built-in set is generated at compile time (see enemy_tables.cpp) and
+// keeps the original hard-coded rules, plus aimed fans from armoured ships.
+// Other sets are loaded from a compact binary file:
+//
+// Layout, all little-endian:
+//   header (16 bytes)
+//     char[4]  magic "SDET"
+//     u16      version, u16 header size
+//     u8       type count, u8 wave count, u16 reserved
+//     u32      FNV-1a of everything after the header
+//   schedule      f32 wave seconds, first spawn interval, interval ramp
+//                 seconds, min interval, speed ramp seconds
+//   per type      f32 hull x, y (x3), u8 r, g, b, a, u16 health, f32 speed,
+//                 f32 radius, f32 spin, u16 trail 1-in-n, u8 trail r, g, b, a,
+//                 u16 score, then the weapon (version 2 on): u8 pattern,
+//                 u8 shots, f32 interval, speed, spread, turn, radius,
+//                 u8 r, g, b, a
+//   per wave      u8 base type, u8 pick count, then (u8 type, u8 percent) per pick
+//
+// Version 1 files have no weapons and load with every type unarmed.
+//
+// A game, its snapshots and its input logs only reproduce under the same
+// tables; snapshots carry EnemyTablesHash and refuse to load under another set.
+
+const int MAX_ENEMY_TYPES = 16;
+const int MAX_WAVES = 64;
+const int MAX_WAVE_PICKS = 4;
+
+// Volley shapes; angles in degrees, 90 pointing down the screen
+enum FirePattern : uint8_t {
+    FIRE_NONE,
+    FIRE_RADIAL,      // `shots` evenly around the circle, the first straight down
+    FIRE_SPIRAL,      // the same, turned a further `turn` every volley
+    FIRE_AIMED_FAN,   // `shots` across `spread`, centred on the player
+    FIRE_PATTERN_COUNT
+};
+
+struct EnemyWeapon {
+    uint8_t pattern;     // FirePattern
+    uint8_t shots;       // projectiles per volley
+    float interval;      // seconds between volleys
+    float speed;         // px per 60 Hz tick at scale 1
+    float spread;        // FIRE_AIMED_FAN: degrees from first to last shot
+    float turn;          // FIRE_SPIRAL: degrees per volley
+    float radius;        // projectile collider at scale 1
+    Rgba color;
+};
+
+struct EnemyType {
+    Vec2 hull[3];        // ship corners around its centre at scale 1, before rotation
+    Rgba color;
+    int health;
+    float speed;         // times FrameContext::enemySpeed
+    float radius;        // collider at scale 1
+    float spin;          // degrees per 60 Hz tick
+    int trailOneIn;      // engine puff with probability 1/n per tick; 0 for none
+    Rgba trailColor;
+    int score;           // awarded for the kill
+    EnemyWeapon weapon;  // fires only while on screen
+};
+
+// Chance of one type for a spawn, out of a roll in [0, 100]
+struct WavePick {
+    uint8_t type;
+    uint8_t percent;
+};
+
+// Which types a wave spawns: picks are tried in order against one roll,
+// accumulating their percentages; the base type takes the rest
+struct WaveSpec {
+    uint8_t baseType;
+    uint8_t pickCount;
+    WavePick picks[MAX_WAVE_PICKS];
+};
+
+// Difficulty ramps over seconds of play, t:
+//   wave           1 + t / waveSeconds
+//   spawn interval max(minInterval, firstInterval - t / intervalRampSeconds)
+//   enemy speed    1 + t / speedRampSeconds, times the type's speed
+struct WaveSchedule {
+    float waveSeconds;
+    float firstInterval;
+    float intervalRampSeconds;
+    float minInterval;
+    float speedRampSeconds;
+};
+
+struct EnemyTables {
+    WaveSchedule schedule;
+    int typeCount;
+    EnemyType types[MAX_ENEMY_TYPES];
+    // Wave N uses waves[N - 1]; later waves repeat the last entry
+    int waveCount;
+    WaveSpec waves[MAX_WAVES];
+    
+    int WaveAt(float seconds) const {
+        return 1 + (int)(seconds / schedule.waveSeconds);
+    }
+    float SpawnIntervalAt(float seconds) const {
+        float interval = schedule.firstInterval - seconds / schedule.intervalRampSeconds;
+        return interval < schedule.minInterval ? schedule.minInterval : interval;
+    }
+    float SpeedMultiplierAt(float seconds) const {
+        return 1.0f + seconds / schedule.speedRampSeconds;
+    }
+    // `roll` is a draw from [0, 100]
+    int PickType(int wave, int roll) const {
+        const WaveSpec& spec = waves[wave < 1 ? 0 : (wave > waveCount ? waveCount - 1 : wave - 1)];
+        int cumulative = 0;
+        for (int i = 0; i < spec.pickCount; i++) {
+            cumulative += spec.picks[i].percent;
+            if (roll < cumulative) return spec.picks[i].type;
+        }
+        return spec.baseType;
+    }
+};
+
+// Types of the built-in set
+enum BuiltinEnemyType : uint8_t {
+    ENEMY_FIGHTER,   // red, one hit
+    ENEMY_ARMOURED,  // purple, two hits, fires aimed fans; more common every wave
+    BUILTIN_ENEMY_TYPE_COUNT
+};
+
+const EnemyTables& BuiltinEnemyTables();
+
+// FNV-1a of the serialized tables; equal sets hash equal
+uint64_t EnemyTablesHash(const EnemyTables& tables);
+
+void SerializeEnemyTables(const EnemyTables& tables, std::vector<unsigned char>& out);
+// Validates the header, checksum and every index, so a loaded set is safe
+// to index with. `out` is untouched on failure.
+bool ParseEnemyTables(const unsigned char* data, size_t size, EnemyTables& out, const char** error);
+
+bool WriteEnemyTablesFile(const std::string& path, const EnemyTables& tables);
+bool ReadEnemyTablesFile(const std::string& path, EnemyTables& out, const char** error);
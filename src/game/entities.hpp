@@ -0,0 +1,140 @@
+#pragma once
+#include <cmath>
+#include "types.hpp"
+#include "services.hpp"
+#include "ecs.hpp"
+#include "enemy_tables.hpp"
+#include "frame_context.hpp"
+
+// Game states
+enum GameState {
+    MENU,
+    PLAYING,
+    PAUSED,
+    GAME_OVER
+};
+
+// Entity kinds as archetype component sets (see ecs.hpp; particles are in
+// particles.hpp). Bullets and enemies carry PREV_POSITION so the renderer
+// can blend between ticks.
+const uint32_t BULLET_COMPONENTS =
+    COMP_POSITION | COMP_PREV_POSITION | COMP_VELOCITY | COMP_COLLIDER | COMP_SHAPE | COMP_HANDLE;
+const uint32_t ENEMY_COMPONENTS =
+    COMP_POSITION | COMP_PREV_POSITION | COMP_VELOCITY | COMP_COLLIDER | COMP_HEALTH | COMP_SHAPE |
+    COMP_SPIN | COMP_HANDLE | COMP_KIND | COMP_WEAPON;
+
+// Row initialisers; return the new row or -1 if the archetype is full
+inline int SpawnBulletRow(Archetype& bullets, Vec2 pos, Vec2 vel) {
+    int row = bullets.Spawn();
+    if (row < 0) return row;
+    bullets.Column(COL_X)[row] = bullets.Column(COL_PREV_X)[row] = pos.x;
+    bullets.Column(COL_Y)[row] = bullets.Column(COL_PREV_Y)[row] = pos.y;
+    bullets.Column(COL_VX)[row] = vel.x;
+    bullets.Column(COL_VY)[row] = vel.y;
+    bullets.Column(COL_RADIUS)[row] = BASE_BULLET_RADIUS;
+    bullets.Shapes()[row] = ShapeKind::Bullet;
+    bullets.Colors()[row] = Palette::Yellow;
+    return row;
+}
+
+// `kind` indexes tables.types; health <= 0 takes the type's
+inline int SpawnEnemyRow(Archetype& enemies, const EnemyTables& tables, int kind, Vec2 pos, Vec2 vel, int health = 0) {
+    int row = enemies.Spawn();
+    if (row < 0) return row;
+    const EnemyType& type = tables.types[kind];
+    enemies.Column(COL_X)[row] = enemies.Column(COL_PREV_X)[row] = pos.x;
+    enemies.Column(COL_Y)[row] = enemies.Column(COL_PREV_Y)[row] = pos.y;
+    enemies.Column(COL_VX)[row] = vel.x;
+    enemies.Column(COL_VY)[row] = vel.y;
+    enemies.Column(COL_RADIUS)[row] = type.radius;
+    enemies.Column(COL_SPIN)[row] = type.spin;
+    enemies.Health()[row] = health > 0 ? health : type.health;
+    enemies.Shapes()[row] = ShapeKind::Ship;
+    enemies.Colors()[row] = type.color;
+    enemies.Kinds()[row] = (uint8_t)kind;
+    // First volley one interval after spawning
+    enemies.Column(COL_FIRE_TIMER)[row] = type.weapon.interval;
+    return row;
+}
+
+// Player class
+struct Player {
+    Vec2 position;
+    Vec2 prevPosition;
+    int health;
+    int score;
+    float shootCooldown;
+    bool invincible;
+    float invincibleTimer;
+    
+    Player() {
+        Reset(FrameContext());
+    }
+    
+    void Reset(const FrameContext& frame) {
+        position = Vec2(frame.width / 2.0f, frame.height - 80.0f * frame.scale);
+        prevPosition = position;
+        health = 5;
+        score = 0;
+        shootCooldown = 0;
+        invincible = false;
+        invincibleTimer = 0;
+    }
+    
+    void Update(const InputState& input, const FrameContext& frame, float dt) {
+        float speed = frame.playerSpeed;
+        
+        // Movement
+        if (input.moveLeft) position.x -= speed;
+        if (input.moveRight) position.x += speed;
+        if (input.moveUp) position.y -= speed;
+        if (input.moveDown) position.y += speed;
+        
+        // Touch input for mobile
+        if (input.touchActive) {
+            Vec2 direction(input.touchPosition.x - position.x, input.touchPosition.y - position.y);
+            float length = sqrtf(direction.x * direction.x + direction.y * direction.y);
+            if (length > frame.touchDeadZone) {
+                direction.x = (direction.x / length) * speed;
+                direction.y = (direction.y / length) * speed;
+                position.x += direction.x;
+                position.y += direction.y;
+            }
+        }
+        
+        // Keep player on screen
+        float margin = frame.playerMargin;
+        if (position.x < margin) position.x = margin;
+        if (position.x > frame.width - margin) position.x = frame.width - margin;
+        if (position.y < margin) position.y = margin;
+        if (position.y > frame.height - margin) position.y = frame.height - margin;
+        
+        // Update cooldowns
+        if (shootCooldown > 0) shootCooldown -= dt;
+        if (invincibleTimer > 0) {
+            invincibleTimer -= dt;
+            if (invincibleTimer <= 0) invincible = false;
+        }
+    }
+    
+    bool CanShoot() const {
+        return shootCooldown <= 0;
+    }
+    
+    void Shoot() {
+        shootCooldown = 0.15f;
+    }
+    
+    void TakeDamage() {
+        if (!invincible) {
+            health--;
+            invincible = true;
+            invincibleTimer = 2.0f;
+        }
+    }
+    
+    bool CheckCollision(Vec2 otherPosition, float otherRadius, const FrameContext& frame) const {
+        if (invincible) return false;
+        return CirclesOverlap(position, frame.playerRadius, otherPosition, otherRadius);
+    }
+};
@@ -0,0 +1,38 @@
+#include "frame_arena.hpp"
+#include <cstdint>
+
+FrameArena::FrameArena(size_t initialBytes)
+    : block(new unsigned char[initialBytes]), blockSize(initialBytes) {}
+
+static size_t AlignUp(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+void* FrameArena::Allocate(size_t bytes, size_t align) {
+    if (bytes == 0) bytes = 1;
+    uintptr_t base = reinterpret_cast<uintptr_t>(block.get());
+    size_t start = AlignUp(base + offset, align) - base;
+    used += bytes + (start - offset);
+    if (start + bytes <= blockSize) {
+        offset = start + bytes;
+        return block.get() + start;
+    }
+    
+    // Out of room this tick: a one-off chunk, folded into the block on Reset
+    overflow.emplace_back(new unsigned char[bytes + align]);
+    uintptr_t chunk = reinterpret_cast<uintptr_t>(overflow.back().get());
+    return reinterpret_cast<void*>(AlignUp(chunk, align));
+}
+
+void FrameArena::Reset() {
+    if (used > highWater) highWater = used;
+    if (!overflow.empty()) {
+        size_t size = blockSize;
+        while (size < highWater) size *= 2;
+        block.reset(new unsigned char[size]);
+        blockSize = size;
+        overflow.clear();
+    }
+    offset = 0;
+    used = 0;
+}
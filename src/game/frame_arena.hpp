@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for data that lives for one tick: collision hit and contact
+// lists and the like. Reset() at the start of every tick makes all of it
+// reusable without touching the heap. If a tick needs more than the block
+// holds, the overflow comes from extra heap chunks and the next Reset()
+// replaces everything with one block large enough, so allocation stops
+// once the peak tick has been seen.
+class FrameArena {
+public:
+    explicit FrameArena(size_t initialBytes = 64 * 1024);
+    
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    
+    void* Allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+    
+    // Uninitialised storage for `count` objects; never destructed
+    template <typename T>
+    T* AllocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destructed");
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+    
+    // Invalidates everything allocated since the last Reset
+    void Reset();
+    
+    size_t Used() const { return used; }
+    size_t Capacity() const { return blockSize; }
+    // Most bytes any single tick has needed
+    size_t HighWater() const { return highWater; }
+    
+private:
+    std::unique_ptr<unsigned char[]> block;
+    size_t blockSize;
+    size_t offset = 0;
+    size_t used = 0;
+    size_t highWater = 0;
+    std::vector<std::unique_ptr<unsigned char[]>> overflow;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include "viewport.hpp"
+
+// Screen-derived values used by the update and draw paths. Built once when
+// the viewport or tick rate changes (startup, resize, rotation) and then
+// passed by reference, so hot loops read plain floats instead of
+// recomputing scale.
+//
+// Movement constants were tuned as "per frame at 60 FPS". tickScale converts
+// them to the current fixed tick (60 / tick rate), and every speed below is
+// already per tick, so a 30 Hz simulation moves twice as far per tick.
+struct FrameContext {
+    Viewport viewport;
+    float tickScale;
+    float width;
+    float height;
+    float scale;
+    bool portrait;
+    
+    // Margins and spawn lines
+    float playerMargin;     // player is kept this far inside the screen
+    float spawnMargin;      // enemies spawn this far from the side edges
+    float spawnY;           // enemies spawn above the top edge
+    float despawnY;         // enemies below this are removed
+    float touchDeadZone;    // touch closer than this does not move the player
+    float enemyTrailY;      // engine trail offset below an enemy
+    float engineOffsetX;    // player engine offsets from the ship center
+    float engineOffsetY;
+    
+    // Collision radii
+    float playerRadius;
+    float bulletRadius;
+    float enemyRadius;
+    
+    // Per-tick speeds
+    float playerSpeed;
+    float bulletSpeed;
+    float enemySpeed;
+    
+    FrameContext() : FrameContext(Viewport()) {}
+    
+    explicit FrameContext(const Viewport& vp, float tickScale = 1.0f)
+        : viewport(vp),
+          tickScale(tickScale),
+          width((float)vp.GetGameWidth()),
+          height((float)vp.GetGameHeight()),
+          scale(vp.GetScaleFactor()),
+          portrait(vp.IsPortrait()),
+          playerMargin(30 * scale),
+          spawnMargin(50 * scale),
+          spawnY(-30 * scale),
+          despawnY(height + 50 * scale),
+          touchDeadZone(50 * scale),
+          enemyTrailY(10 * scale),
+          engineOffsetX(10 * scale),
+          engineOffsetY(15 * scale),
+          playerRadius(BASE_PLAYER_RADIUS * scale),
+          bulletRadius(BASE_BULLET_RADIUS * scale),
+          enemyRadius(BASE_ENEMY_RADIUS * scale),
+          playerSpeed(BASE_PLAYER_SPEED * scale * tickScale),
+          bulletSpeed(BASE_BULLET_SPEED * scale * tickScale),
+          enemySpeed(BASE_ENEMY_SPEED * scale * tickScale) {}
+};
@@ -0,0 +1,69 @@
+#include "frame_pipeline.hpp"
+#include <chrono>
+
+FramePipeline::FramePipeline(bool threaded) {
+    if (threaded) worker = std::thread(&FramePipeline::WorkerLoop, this);
+}
+
+FramePipeline::~FramePipeline() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void FramePipeline::SetProducer(ProduceFn fn, void* userData) {
+    produce = fn;
+    user = userData;
+}
+
+void FramePipeline::Produce() {
+    auto start = std::chrono::steady_clock::now();
+    if (produce) produce(lists[writeIndex], user);
+    produceMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void FramePipeline::Start() {
+    if (pending) Finish();
+    pending = true;
+    if (!worker.joinable()) {
+        Produce();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        working = true;
+    }
+    wake.notify_one();
+}
+
+const RenderCommandList& FramePipeline::Finish() {
+    if (!pending) {
+        // Nothing in flight: hand out the other, idle list
+        return lists[writeIndex ^ 1];
+    }
+    if (worker.joinable()) {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return !working; });
+    }
+    pending = false;
+    int finished = writeIndex;
+    writeIndex ^= 1;
+    return lists[finished];
+}
+
+void FramePipeline::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return working || stopping; });
+        if (stopping) return;
+        lock.unlock();
+        Produce();
+        lock.lock();
+        working = false;
+        done.notify_one();
+    }
+}
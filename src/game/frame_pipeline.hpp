@@ -0,0 +1,62 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "render_commands.hpp"
+
+// Two render command lists and a producer that fills them. The producer
+// (simulation plus scene recording) writes one list while the caller
+// submits the other, so frame N+1 is simulated while frame N is drawn:
+//
+//     pipeline.Start();
+//     loop:
+//         const RenderCommandList& list = pipeline.Finish();
+//         // producer idle: exchange inputs and outputs with it here
+//         pipeline.Start();
+//         backend.Submit(list);
+//
+// A list returned by Finish stays valid until the next Finish. Anything
+// the producer shares with the caller must only be touched between Finish
+// and Start. A serial pipeline runs the producer inline in Start; calling
+// Start then Finish each frame draws every frame as soon as it is made,
+// without the frame of latency the overlap adds.
+class FramePipeline {
+public:
+    typedef void (*ProduceFn)(RenderCommandList& out, void* user);
+    
+    explicit FramePipeline(bool threaded);
+    ~FramePipeline();
+    
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+    
+    // Set before the first Start
+    void SetProducer(ProduceFn fn, void* user);
+    
+    // Produces the next frame into the list not being submitted
+    void Start();
+    // Waits for the frame started last; an empty list if none was started
+    const RenderCommandList& Finish();
+    
+    bool Threaded() const { return worker.joinable(); }
+    // Time the last finished frame spent in the producer
+    double LastProduceMs() const { return produceMs; }
+    
+private:
+    void Produce();
+    void WorkerLoop();
+    
+    RenderCommandList lists[2];
+    int writeIndex = 0;
+    ProduceFn produce = nullptr;
+    void* user = nullptr;
+    double produceMs = 0;
+    
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool pending = false;    // a frame was started and not yet finished
+    bool working = false;    // the worker has not finished it
+    bool stopping = false;
+};
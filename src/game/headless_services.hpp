@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include "services.hpp"
+
+// Deterministic stand-ins for the raylib-backed services, used by the
+// headless runner so a seed fully determines a run. The window build uses
+// SeededRandom too, so recorded sessions replay exactly.
+
+class FixedClock : public Clock {
+public:
+    explicit FixedClock(float dt = 1.0f / 60.0f) : dt(dt) {}
+    float GetFrameTime() override { return dt; }
+    
+private:
+    float dt;
+};
+
+// Fixed seed for the game's streams. GetRandomValue is an xorshift64* for
+// tools that place things outside the simulation (benchmarks, fixtures).
+class SeededRandom : public RandomSource {
+public:
+    explicit SeededRandom(uint64_t seed) : seed(seed), state(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+    
+    uint64_t Seed() override { return seed; }
+    
+    // Inclusive range, same contract as raylib's GetRandomValue
+    int GetRandomValue(int min, int max) {
+        if (min > max) { int t = min; min = max; max = t; }
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        uint64_t r = (state * 0x2545F4914F6CDD1Dull) >> 32;
+        return min + (int)(r % (uint64_t)((int64_t)max - min + 1));
+    }
+    
+private:
+    uint64_t seed;
+    uint64_t state;
+};
+
+class FixedViewport : public ViewportSource {
+public:
+    explicit FixedViewport(Viewport vp = Viewport()) : vp(vp) {}
+    Viewport GetViewport() override { return vp; }
+    
+private:
+    Viewport vp;
+};
+
+// Holds fire, sweeps left/right and confirms every menu so a run never stalls
+class AutopilotInput : public InputSource {
+public:
+    InputState Poll() override {
+        InputState in;
+        in.fire = true;
+        in.confirmPressed = true;
+        bool right = (tick / 90) % 2 == 0;
+        in.moveRight = right;
+        in.moveLeft = !right;
+        tick++;
+        return in;
+    }
+    
+    // Jumps to a later point of the sweep, e.g. the tick count of a loaded
+    // snapshot, so a resumed run moves in step with an uninterrupted one
+    void Seek(uint64_t polls) { tick = polls; }
+    
+private:
+    uint64_t tick = 0;
+};
@@ -0,0 +1,364 @@
+#include "input_log.hpp"
+#include <cstring>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+static const char INPUT_LOG_MAGIC[4] = {'S', 'D', 'I', 'L'};
+// Version 1 logs have no effect detail records and read back unchanged
+static const uint16_t INPUT_LOG_VERSION = 2;
+static const uint16_t INPUT_LOG_HEADER_SIZE = 32;
+
+enum InputLogFlags : uint8_t {
+    LOG_TOUCH = 1 << 0,
+    LOG_VIEWPORT = 1 << 1,
+    LOG_RUN = 1 << 2,
+    LOG_DETAIL = 1 << 3,
+};
+
+static void PutU16(unsigned char* p, uint16_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static void PutU32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static void PutU64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static uint16_t GetU16(const unsigned char* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t GetU32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t GetU64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static void PutF32(unsigned char* p, float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    PutU32(p, bits);
+}
+
+static float GetF32(const unsigned char* p) {
+    uint32_t bits = GetU32(p);
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static uint8_t PackButtons(const InputState& in) {
+    return (uint8_t)((in.moveLeft << 0) | (in.moveRight << 1) | (in.moveUp << 2) | (in.moveDown << 3) |
+                     (in.fire << 4) | (in.confirmPressed << 5) | (in.pausePressed << 6) | (in.backPressed << 7));
+}
+
+static void UnpackButtons(uint8_t bits, InputState& in) {
+    in.moveLeft = bits & (1 << 0);
+    in.moveRight = bits & (1 << 1);
+    in.moveUp = bits & (1 << 2);
+    in.moveDown = bits & (1 << 3);
+    in.fire = bits & (1 << 4);
+    in.confirmPressed = bits & (1 << 5);
+    in.pausePressed = bits & (1 << 6);
+    in.backPressed = bits & (1 << 7);
+}
+
+static bool SameInput(const InputState& a, const InputState& b) {
+    if (PackButtons(a) != PackButtons(b) || a.touchActive != b.touchActive) return false;
+    return !a.touchActive || (a.touchPosition.x == b.touchPosition.x && a.touchPosition.y == b.touchPosition.y);
+}
+
+// ---------------------------------------------------------------------------
+
+InputLogWriter::~InputLogWriter() {
+    Close();
+}
+
+bool InputLogWriter::Open(const std::string& path, const InputLogHeader& info) {
+    Close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    
+    unsigned char header[INPUT_LOG_HEADER_SIZE] = {};
+    std::memcpy(header, INPUT_LOG_MAGIC, 4);
+    PutU16(header + 4, INPUT_LOG_VERSION);
+    PutU16(header + 6, INPUT_LOG_HEADER_SIZE);
+    PutU64(header + 8, info.seed);
+    PutU16(header + 16, (uint16_t)info.tickRate);
+    PutU16(header + 18, (uint16_t)info.viewport.width);
+    PutU16(header + 20, (uint16_t)info.viewport.height);
+    PutU32(header + 28, info.particleBudget);
+    WriteBytes(header, sizeof(header));
+    
+    lastViewport = info.viewport;
+    lastDetail = EffectDetail();
+    hasPending = false;
+    pendingRun = 0;
+    tickCount = 0;
+    failed = false;
+    return true;
+}
+
+void InputLogWriter::Record(const InputState& input, const Viewport& viewport, const EffectDetail& detail) {
+    if (!file) return;
+    tickCount++;
+    
+    bool viewportChanged = viewport != lastViewport;
+    lastViewport = viewport;
+    bool detailChanged = detail != lastDetail;
+    lastDetail = detail;
+    
+    if (hasPending && !viewportChanged && !detailChanged && pendingRun < 0xFFFF && SameInput(pending.input, input)) {
+        pendingRun++;
+        return;
+    }
+    Flush();
+    pending.input = input;
+    pending.viewportChanged = viewportChanged;
+    pending.viewport = viewport;
+    pending.detailChanged = detailChanged;
+    pending.detail = detail;
+    hasPending = true;
+    pendingRun = 0;
+}
+
+void InputLogWriter::Flush() {
+    if (!hasPending) return;
+    unsigned char record[20];
+    size_t n = 0;
+    uint8_t flags = 0;
+    if (pending.input.touchActive) flags |= LOG_TOUCH;
+    if (pending.viewportChanged) flags |= LOG_VIEWPORT;
+    if (pendingRun > 0) flags |= LOG_RUN;
+    if (pending.detailChanged) flags |= LOG_DETAIL;
+    record[n++] = PackButtons(pending.input);
+    record[n++] = flags;
+    if (flags & LOG_TOUCH) {
+        PutF32(record + n, pending.input.touchPosition.x);
+        PutF32(record + n + 4, pending.input.touchPosition.y);
+        n += 8;
+    }
+    if (flags & LOG_VIEWPORT) {
+        PutU16(record + n, (uint16_t)pending.viewport.width);
+        PutU16(record + n + 2, (uint16_t)pending.viewport.height);
+        n += 4;
+    }
+    if (flags & LOG_DETAIL) {
+        record[n++] = (unsigned char)pending.detail.particlePercent;
+        record[n++] = (unsigned char)pending.detail.trailPercent;
+    }
+    if (flags & LOG_RUN) {
+        PutU16(record + n, (uint16_t)pendingRun);
+        n += 2;
+    }
+    WriteBytes(record, n);
+    hasPending = false;
+    pendingRun = 0;
+    
+    // Keep memory bounded on long sessions
+    if (buffer.size() >= 64 * 1024) {
+        if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) failed = true;
+        buffer.clear();
+    }
+}
+
+void InputLogWriter::WriteBytes(const void* bytes, size_t count) {
+    const unsigned char* p = static_cast<const unsigned char*>(bytes);
+    buffer.insert(buffer.end(), p, p + count);
+}
+
+bool InputLogWriter::Close() {
+    if (!file) return false;
+    Flush();
+    // A chunk lost mid-session (a full card, say) breaks every later tick
+    bool ok = !failed && (buffer.empty() || std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size());
+    buffer.clear();
+    
+    unsigned char count[4];
+    PutU32(count, tickCount);
+    ok = ok && std::fseek(file, 24, SEEK_SET) == 0 && std::fwrite(count, 1, 4, file) == 4;
+    ok = std::fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+
+InputLogReader::~InputLogReader() {
+    Close();
+}
+
+void InputLogReader::Close() {
+#if defined(_WIN32)
+    if (mapping) UnmapViewOfFile(mapping);
+    if (mappingHandle) CloseHandle((HANDLE)mappingHandle);
+#else
+    if (mapping) munmap(mapping, size);
+#endif
+    mapping = nullptr;
+    mappingHandle = nullptr;
+    streamed.clear();
+    data = nullptr;
+    size = 0;
+    cursor = 0;
+    repeatLeft = 0;
+}
+
+bool InputLogReader::Open(const std::string& path) {
+    Close();
+    error = nullptr;
+    
+#if defined(_WIN32)
+    HANDLE fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(fileHandle, &fileSize) && fileSize.QuadPart > 0) {
+            HANDLE map = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (map) {
+                mapping = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+                if (mapping) {
+                    mappingHandle = map;
+                    size = (size_t)fileSize.QuadPart;
+                } else {
+                    CloseHandle(map);
+                }
+            }
+        }
+        CloseHandle(fileHandle);
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                mapping = p;
+                size = (size_t)st.st_size;
+            }
+        }
+        close(fd);
+    }
+#endif
+    
+    if (mapping) {
+        data = static_cast<const unsigned char*>(mapping);
+    } else {
+        // Stream fallback (e.g. Android asset paths that cannot be mapped)
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) {
+            error = "cannot open file";
+            return false;
+        }
+        unsigned char chunk[16 * 1024];
+        size_t n;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) {
+            streamed.insert(streamed.end(), chunk, chunk + n);
+        }
+        std::fclose(f);
+        data = streamed.data();
+        size = streamed.size();
+    }
+    
+    if (!ParseHeader()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool InputLogReader::ParseHeader() {
+    if (size < INPUT_LOG_HEADER_SIZE || std::memcmp(data, INPUT_LOG_MAGIC, 4) != 0) {
+        error = "not an input log";
+        return false;
+    }
+    uint16_t version = GetU16(data + 4);
+    if (version < 1 || version > INPUT_LOG_VERSION) {
+        error = "unsupported input log version";
+        return false;
+    }
+    uint16_t headerSize = GetU16(data + 6);
+    if (headerSize < INPUT_LOG_HEADER_SIZE || headerSize > size) {
+        error = "bad header size";
+        return false;
+    }
+    header.seed = GetU64(data + 8);
+    header.tickRate = GetU16(data + 16);
+    header.viewport = Viewport(GetU16(data + 18), GetU16(data + 20));
+    header.tickCount = GetU32(data + 24);
+    header.particleBudget = GetU32(data + 28);
+    cursor = headerSize;
+    return true;
+}
+
+void InputLogReader::Rewind() {
+    if (data) ParseHeader();
+    repeatLeft = 0;
+}
+
+bool InputLogReader::Next(InputLogTick& tick) {
+    if (repeatLeft > 0) {
+        repeatLeft--;
+        tick = current;
+        tick.viewportChanged = false;
+        tick.detailChanged = false;
+        return true;
+    }
+    if (cursor + 2 > size) return false;
+    
+    const unsigned char* p = data + cursor;
+    uint8_t flags = p[1];
+    size_t need = 2 + ((flags & LOG_TOUCH) ? 8 : 0) + ((flags & LOG_VIEWPORT) ? 4 : 0) +
+                  ((flags & LOG_DETAIL) ? 2 : 0) + ((flags & LOG_RUN) ? 2 : 0);
+    if (cursor + need > size) {
+        error = "truncated record";
+        return false;
+    }
+    
+    current = InputLogTick();
+    UnpackButtons(p[0], current.input);
+    size_t n = 2;
+    if (flags & LOG_TOUCH) {
+        current.input.touchActive = true;
+        current.input.touchPosition = Vec2(GetF32(p + n), GetF32(p + n + 4));
+        n += 8;
+    }
+    if (flags & LOG_VIEWPORT) {
+        current.viewportChanged = true;
+        current.viewport = Viewport(GetU16(p + n), GetU16(p + n + 2));
+        n += 4;
+    }
+    if (flags & LOG_DETAIL) {
+        current.detailChanged = true;
+        current.detail.particlePercent = p[n];
+        current.detail.trailPercent = p[n + 1];
+        n += 2;
+    }
+    if (flags & LOG_RUN) {
+        repeatLeft = GetU16(p + n);
+        n += 2;
+    }
+    cursor += n;
+    tick = current;
+    return true;
+}
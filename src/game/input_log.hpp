@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "services.hpp"
+#include "types.hpp"
+#include "viewport.hpp"
+
+// Compact binary log of the input every simulation tick saw, plus what is
+// needed to reproduce the run (RNG seed, tick rate, viewport). Replaying a
+// log through SpaceShooter::Tick with a SeededRandom of the same seed
+// reproduces the session exactly. Effect detail changes (see QualityGovernor)
+// alter the particle stream, so they are logged like viewport changes.
+//
+// Recording has to start before the first tick of the session.
+//
+// Layout, all little-endian:
+//   header (32 bytes)
+//     char[4]  magic "SDIL"
+//     u16      version, u16 header size
+//     u64      RNG seed
+//     u16      tick rate, u16 viewport width, u16 viewport height, u16 reserved
+//     u32      tick count (patched on close), u32 particle budget
+//   records, one per run of identical ticks
+//     u8       buttons: left right up down fire confirm pause back (bit 0..7)
+//     u8       flags:   bit 0 touch, bit 1 viewport change, bit 2 run,
+//                       bit 3 effect detail change (version 2)
+//     [f32 x, f32 y]        if touch
+//     [u16 width, u16 height] if viewport change, applied before the tick
+//     [u8 particle %, u8 trail %] if effect detail change, applied before the tick
+//     [u16 extra ticks]     if run: the record repeats for this many more ticks
+//
+// Steady play compresses to a few bytes per second of input changes.
+
+struct InputLogHeader {
+    uint64_t seed = 0;
+    int tickRate = 60;
+    Viewport viewport;
+    uint32_t tickCount = 0;
+    uint32_t particleBudget = 0;
+};
+
+struct InputLogTick {
+    InputState input;
+    bool viewportChanged = false;
+    Viewport viewport;
+    bool detailChanged = false;
+    EffectDetail detail;
+};
+
+class InputLogWriter {
+public:
+    InputLogWriter() = default;
+    ~InputLogWriter();
+    
+    InputLogWriter(const InputLogWriter&) = delete;
+    InputLogWriter& operator=(const InputLogWriter&) = delete;
+    
+    // header.tickCount is ignored and filled in by Close
+    bool Open(const std::string& path, const InputLogHeader& header);
+    // Called once per tick with the input, viewport and effect detail that tick used
+    void Record(const InputState& input, const Viewport& viewport, const EffectDetail& detail);
+    // Flushes the pending record and patches the tick count; also run by the
+    // destructor. False if any write failed, so the log is incomplete.
+    bool Close();
+    
+    bool IsOpen() const { return file != nullptr; }
+    uint32_t TickCount() const { return tickCount; }
+    
+private:
+    void Flush();
+    void WriteBytes(const void* data, size_t size);
+    
+    std::FILE* file = nullptr;
+    std::vector<unsigned char> buffer;
+    InputLogTick pending;
+    bool hasPending = false;
+    uint32_t pendingRun = 0;   // ticks after the first that repeat `pending`
+    Viewport lastViewport;
+    EffectDetail lastDetail;
+    uint32_t tickCount = 0;
+    bool failed = false;   // a buffered chunk did not reach the file
+};
+
+// Reads a log through a read-only memory mapping, or by streaming the file
+// into memory where mapping is unavailable. Ticks are decoded sequentially.
+class InputLogReader {
+public:
+    InputLogReader() = default;
+    ~InputLogReader();
+    
+    InputLogReader(const InputLogReader&) = delete;
+    InputLogReader& operator=(const InputLogReader&) = delete;
+    
+    bool Open(const std::string& path);
+    void Close();
+    
+    const InputLogHeader& Header() const { return header; }
+    bool IsMapped() const { return mapping != nullptr; }
+    const char* Error() const { return error; }
+    
+    // Decodes the next tick; false at end of log or on a malformed record
+    bool Next(InputLogTick& tick);
+    void Rewind();
+    
+private:
+    bool ParseHeader();
+    
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    size_t cursor = 0;
+    void* mapping = nullptr;            // platform mapping, if mapped
+    void* mappingHandle = nullptr;      // Windows file mapping handle
+    std::vector<unsigned char> streamed;  // fallback storage
+    InputLogHeader header;
+    InputLogTick current;
+    uint32_t repeatLeft = 0;
+    const char* error = nullptr;
+};
@@ -0,0 +1,94 @@
+#include "job_system.hpp"
+
+static thread_local int threadQueueIndex = 0;
+
+bool JobSystem::Queue::Push(const Job& job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == CAPACITY) return false;
+    jobs[(head + count) % CAPACITY] = job;
+    count++;
+    return true;
+}
+
+bool JobSystem::Queue::PopBack(Job& job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == 0) return false;
+    count--;
+    job = jobs[(head + count) % CAPACITY];
+    return true;
+}
+
+bool JobSystem::Queue::StealFront(Job& job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == 0) return false;
+    job = jobs[head];
+    head = (head + 1) % CAPACITY;
+    count--;
+    return true;
+}
+
+JobSystem::JobSystem(int workerThreads)
+    : queues(workerThreads > 0 ? workerThreads + 1 : 1) {
+    for (int i = 0; i < workerThreads; i++) {
+        workers.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+void JobSystem::Dispatch(int count, int grain, RangeFn run, void* ctx) {
+    int self = threadQueueIndex;
+    int chunks = (count + grain - 1) / grain;
+    std::atomic<int> pending(chunks);
+    
+    // Deal chunks round-robin so every thread starts with local work
+    for (int c = 0; c < chunks; c++) {
+        Job job{run, ctx, c * grain, (c + 1) * grain < count ? (c + 1) * grain : count, &pending};
+        Queue& q = queues[(self + c) % queues.size()];
+        queued.fetch_add(1, std::memory_order_release);
+        if (!q.Push(job)) {
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            job.run(job.ctx, job.begin, job.end);
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_all();
+    
+    // Help until our own chunks are done (they may be on other queues)
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (!RunOne(self)) std::this_thread::yield();
+    }
+}
+
+bool JobSystem::RunOne(int self) {
+    Job job;
+    bool found = queues[self].PopBack(job);
+    for (size_t i = 1; !found && i < queues.size(); i++) {
+        found = queues[(self + i) % queues.size()].StealFront(job);
+    }
+    if (!found) return false;
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    job.run(job.ctx, job.begin, job.end);
+    job.pending->fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
+
+void JobSystem::WorkerLoop(int index) {
+    threadQueueIndex = index;
+    while (true) {
+        if (RunOne(index)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping) return;
+    }
+}
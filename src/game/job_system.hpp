@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Small work-stealing scheduler for data-parallel loops. Each thread owns a
+// fixed-size job ring; owners pop from the back, idle threads steal from
+// the front of other rings. ParallelFor returns only when every chunk has
+// run, which is the merge point callers rely on for deterministic results:
+// chunks may run in any order, so they must only write to their own range.
+//
+// A JobSystem with zero workers runs everything inline on the caller.
+class JobSystem {
+public:
+    explicit JobSystem(int workerThreads);
+    ~JobSystem();
+    
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    
+    // Worker threads plus the calling thread
+    int ThreadCount() const { return (int)workers.size() + 1; }
+    
+    // Calls fn(begin, end) over [0, count) in chunks of about `grain` items
+    template <typename Fn>
+    void ParallelFor(int count, int grain, Fn&& fn) {
+        if (count <= 0) return;
+        if (grain < 1) grain = 1;
+        if (workers.empty() || count <= grain) {
+            fn(0, count);
+            return;
+        }
+        Dispatch(count, grain, &Invoke<typename std::remove_reference<Fn>::type>, (void*)&fn);
+    }
+    
+private:
+    typedef void (*RangeFn)(void* ctx, int begin, int end);
+    
+    struct Job {
+        RangeFn run;
+        void* ctx;
+        int begin;
+        int end;
+        std::atomic<int>* pending;
+    };
+    
+    // Bounded deque; a full ring makes the submitter run the job itself
+    struct Queue {
+        static const int CAPACITY = 256;
+        std::mutex mutex;
+        Job jobs[CAPACITY];
+        int head = 0;   // steal end
+        int count = 0;
+        
+        bool Push(const Job& job);
+        bool PopBack(Job& job);
+        bool StealFront(Job& job);
+    };
+    
+    template <typename Fn>
+    static void Invoke(void* ctx, int begin, int end) {
+        (*static_cast<Fn*>(ctx))(begin, end);
+    }
+    
+    void Dispatch(int count, int grain, RangeFn run, void* ctx);
+    bool RunOne(int self);
+    void WorkerLoop(int index);
+    
+    std::vector<std::thread> workers;
+    std::vector<Queue> queues;  // [0] belongs to the submitting thread
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<int> queued{0};
+    std::atomic<bool> stopping{false};
+};
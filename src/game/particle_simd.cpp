@@ -0,0 +1,153 @@
+#include "particle_simd.hpp"
+#include "simd_support.hpp"
+
+static void IntegrateScalar(const ParticleArrays& p, int count, float dt, float gravity) {
+    for (int i = 0; i < count; i++) {
+        p.x[i] += p.vx[i];
+        p.y[i] += p.vy[i];
+        p.life[i] -= dt;
+        p.vy[i] += gravity;
+    }
+}
+
+// Lanes left over after the vector loop go through the scalar path
+static void IntegrateTail(const ParticleArrays& p, int start, int count, float dt, float gravity) {
+    ParticleArrays tail{p.x + start, p.y + start, p.vx + start, p.vy + start, p.life + start};
+    IntegrateScalar(tail, count - start, dt, gravity);
+}
+
+#ifdef SIMD_HAVE_SSE2
+static void IntegrateSSE2(const ParticleArrays& p, int count, float dt, float gravity) {
+    const __m128 vdt = _mm_set1_ps(dt);
+    const __m128 vg = _mm_set1_ps(gravity);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 vy = _mm_loadu_ps(p.vy + i);
+        _mm_storeu_ps(p.x + i, _mm_add_ps(_mm_loadu_ps(p.x + i), _mm_loadu_ps(p.vx + i)));
+        _mm_storeu_ps(p.y + i, _mm_add_ps(_mm_loadu_ps(p.y + i), vy));
+        _mm_storeu_ps(p.life + i, _mm_sub_ps(_mm_loadu_ps(p.life + i), vdt));
+        _mm_storeu_ps(p.vy + i, _mm_add_ps(vy, vg));
+    }
+    IntegrateTail(p, i, count, dt, gravity);
+}
+#endif
+
+#ifdef SIMD_HAVE_AVX2
+__attribute__((target("avx2")))
+static void IntegrateAVX2(const ParticleArrays& p, int count, float dt, float gravity) {
+    const __m256 vdt = _mm256_set1_ps(dt);
+    const __m256 vg = _mm256_set1_ps(gravity);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 vy = _mm256_loadu_ps(p.vy + i);
+        _mm256_storeu_ps(p.x + i, _mm256_add_ps(_mm256_loadu_ps(p.x + i), _mm256_loadu_ps(p.vx + i)));
+        _mm256_storeu_ps(p.y + i, _mm256_add_ps(_mm256_loadu_ps(p.y + i), vy));
+        _mm256_storeu_ps(p.life + i, _mm256_sub_ps(_mm256_loadu_ps(p.life + i), vdt));
+        _mm256_storeu_ps(p.vy + i, _mm256_add_ps(vy, vg));
+    }
+    IntegrateTail(p, i, count, dt, gravity);
+}
+#endif
+
+#ifdef SIMD_HAVE_NEON
+static void IntegrateNEON(const ParticleArrays& p, int count, float dt, float gravity) {
+    const float32x4_t vdt = vdupq_n_f32(dt);
+    const float32x4_t vg = vdupq_n_f32(gravity);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t vy = vld1q_f32(p.vy + i);
+        vst1q_f32(p.x + i, vaddq_f32(vld1q_f32(p.x + i), vld1q_f32(p.vx + i)));
+        vst1q_f32(p.y + i, vaddq_f32(vld1q_f32(p.y + i), vy));
+        vst1q_f32(p.life + i, vsubq_f32(vld1q_f32(p.life + i), vdt));
+        vst1q_f32(p.vy + i, vaddq_f32(vy, vg));
+    }
+    IntegrateTail(p, i, count, dt, gravity);
+}
+#endif
+
+bool IsParticleKernelAvailable(ParticleKernel kernel) {
+    switch (kernel) {
+        case ParticleKernel::Scalar:
+            return true;
+        case ParticleKernel::SSE2:
+#ifdef SIMD_HAVE_SSE2
+            return true;
+#else
+            return false;
+#endif
+        case ParticleKernel::AVX2:
+#ifdef SIMD_HAVE_AVX2
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+        case ParticleKernel::NEON:
+#ifdef SIMD_HAVE_NEON
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+ParticleKernel BestParticleKernel() {
+    if (IsParticleKernelAvailable(ParticleKernel::AVX2)) return ParticleKernel::AVX2;
+    if (IsParticleKernelAvailable(ParticleKernel::SSE2)) return ParticleKernel::SSE2;
+    if (IsParticleKernelAvailable(ParticleKernel::NEON)) return ParticleKernel::NEON;
+    return ParticleKernel::Scalar;
+}
+
+const char* ParticleKernelName(ParticleKernel kernel) {
+    switch (kernel) {
+        case ParticleKernel::Scalar: return "scalar";
+        case ParticleKernel::SSE2: return "sse2";
+        case ParticleKernel::AVX2: return "avx2";
+        case ParticleKernel::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+ParticleIntegrateFn GetParticleIntegrator(ParticleKernel kernel) {
+    if (!IsParticleKernelAvailable(kernel)) return nullptr;
+    switch (kernel) {
+        case ParticleKernel::Scalar: return IntegrateScalar;
+#ifdef SIMD_HAVE_SSE2
+        case ParticleKernel::SSE2: return IntegrateSSE2;
+#endif
+#ifdef SIMD_HAVE_AVX2
+        case ParticleKernel::AVX2: return IntegrateAVX2;
+#endif
+#ifdef SIMD_HAVE_NEON
+        case ParticleKernel::NEON: return IntegrateNEON;
+#endif
+        default: return nullptr;
+    }
+}
+
+struct ActiveKernel {
+    ParticleKernel kernel;
+    ParticleIntegrateFn fn;
+};
+
+// Function-local so it is initialized on first use, not in static-init order
+static ActiveKernel& Active() {
+    static ActiveKernel active{BestParticleKernel(), GetParticleIntegrator(BestParticleKernel())};
+    return active;
+}
+
+ParticleKernel GetActiveParticleKernel() {
+    return Active().kernel;
+}
+
+bool SetActiveParticleKernel(ParticleKernel kernel) {
+    ParticleIntegrateFn fn = GetParticleIntegrator(kernel);
+    if (!fn) return false;
+    Active() = ActiveKernel{kernel, fn};
+    return true;
+}
+
+void IntegrateParticles(const ParticleArrays& p, int count, float dt, float gravity) {
+    Active().fn(p, count, dt, gravity);
+}
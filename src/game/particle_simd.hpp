@@ -0,0 +1,37 @@
+#pragma once
+
+// Batch particle integration:
+//   x += vx; y += vy; life -= dt; vy += gravity
+// Every implementation performs exactly the same IEEE operations in the same
+// order (no FMA, no reassociation), so all kernels are bit-identical to the
+// scalar one and runs stay deterministic across x86 and arm64 devices.
+
+enum class ParticleKernel {
+    Scalar,
+    SSE2,   // 4 lanes, x86/x64
+    AVX2,   // 8 lanes, x86/x64 with runtime CPU check
+    NEON    // 4 lanes, arm64-v8a
+};
+
+struct ParticleArrays {
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    float* life;
+};
+
+typedef void (*ParticleIntegrateFn)(const ParticleArrays& p, int count, float dt, float gravity);
+
+bool IsParticleKernelAvailable(ParticleKernel kernel);
+// Widest kernel supported by this build and CPU
+ParticleKernel BestParticleKernel();
+const char* ParticleKernelName(ParticleKernel kernel);
+ParticleIntegrateFn GetParticleIntegrator(ParticleKernel kernel);
+
+// Kernel used by ParticleManager; defaults to BestParticleKernel()
+ParticleKernel GetActiveParticleKernel();
+// Returns false and keeps the current kernel if the requested one is unavailable
+bool SetActiveParticleKernel(ParticleKernel kernel);
+
+void IntegrateParticles(const ParticleArrays& p, int count, float dt, float gravity);
@@ -0,0 +1,98 @@
+#include "particles.hpp"
+#include <algorithm>
+#include <cmath>
+#include "job_system.hpp"
+#include "particle_simd.hpp"
+#include "snapshot.hpp"
+
+ParticleManager::ParticleManager(int capacity) : store("particles", PARTICLE_COMPONENTS, capacity) {
+    BindColumns();
+}
+
+void ParticleManager::SetCapacity(int newCapacity) {
+    store.SetCapacity(newCapacity);
+    BindColumns();
+}
+
+void ParticleManager::BindColumns() {
+    px = store.Column(COL_X);
+    py = store.Column(COL_Y);
+    vx = store.Column(COL_VX);
+    vy = store.Column(COL_VY);
+    life = store.Column(COL_LIFE);
+    maxLife = store.Column(COL_MAX_LIFE);
+    sizes = store.Column(COL_SIZE);
+    colors = store.Colors();
+}
+
+void ParticleManager::SetDetail(const EffectDetail& value) {
+    detail = value;
+    detail.particlePercent = std::min(std::max(detail.particlePercent, 0), 100);
+    detail.trailPercent = std::min(std::max(detail.trailPercent, 0), 100);
+    int count = (EXPLOSION_PARTICLES * detail.particlePercent + 50) / 100;
+    explosionParticles = count < 1 ? 1 : count;
+}
+
+void ParticleManager::AddExplosion(Vec2 position, Rgba color, Rng& rng) {
+    // Drawn in batches, one array per attribute
+    float angles[EXPLOSION_PARTICLES];
+    float speeds[EXPLOSION_PARTICLES];
+    float sizes[EXPLOSION_PARTICLES];
+    int count = explosionParticles;
+    rng.FillRange(angles, count, 0, 360, DEG_TO_RAD);
+    rng.FillRange(speeds, count, 2, 6, tickScale);
+    rng.FillRange(sizes, count, 2, 5, 1.0f);
+    for (int i = 0; i < count; i++) {
+        Emit(position, Vec2(cosf(angles[i]) * speeds[i], sinf(angles[i]) * speeds[i]), color, 1.0f, sizes[i]);
+    }
+}
+
+void ParticleManager::AddTrail(Vec2 position, Rgba color, Rng& rng) {
+    // Thinned by a running credit rather than the RNG, so full detail draws
+    // exactly the same random numbers as before
+    trailCredit += detail.trailPercent;
+    if (trailCredit < 100) return;
+    trailCredit -= 100;
+    float velocity[4];
+    rng.FillRange(velocity, 2, -10, 10, 0.1f * tickScale);
+    rng.FillRange(velocity + 2, 2, 10, 30, 0.1f * tickScale);
+    for (int i = 0; i < 2; i++) {
+        Emit(position, Vec2(velocity[i], velocity[2 + i]), color, 0.5f, 2.0f);
+    }
+}
+
+void ParticleManager::Save(SnapshotWriter& out) const {
+    out.PutI32(detail.particlePercent);
+    out.PutI32(detail.trailPercent);
+    out.PutI32(trailCredit);
+    store.Save(out);
+}
+
+bool ParticleManager::Load(SnapshotReader& in) {
+    EffectDetail saved;
+    saved.particlePercent = in.GetI32();
+    saved.trailPercent = in.GetI32();
+    int credit = in.GetI32();
+    bool ok = in.Ok() && store.Load(in);
+    BindColumns();
+    if (!ok) return false;
+    SetDetail(saved);
+    trailCredit = credit;
+    return true;
+}
+
+// Multiple of 8 so every chunk but the last runs full SIMD lanes
+static const int PARTICLE_GRAIN = 4096;
+
+void ParticleManager::Update(float dt, JobSystem* jobs) {
+    float gravity = TickGravity();
+    auto integrate = [&](int begin, int end) {
+        ParticleArrays chunk{px + begin, py + begin, vx + begin, vy + begin, life + begin};
+        IntegrateParticles(chunk, end - begin, dt, gravity);
+    };
+    if (jobs) jobs->ParallelFor(store.Size(), PARTICLE_GRAIN, integrate);
+    else integrate(0, store.Size());
+    
+    // Swap-removes everything with life <= 0
+    store.RemoveDead();
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "ecs.hpp"
+#include "types.hpp"
+#include "rng.hpp"
+
+class JobSystem;
+class SnapshotReader;
+class SnapshotWriter;
+
+// No PREV_POSITION: the renderer reconstructs it from velocity
+const uint32_t PARTICLE_COMPONENTS = COMP_POSITION | COMP_VELOCITY | COMP_LIFETIME | COMP_SHAPE;
+
+// Particle system over a fixed-size particle archetype (POSITION, VELOCITY,
+// LIFETIME, SHAPE). All storage is allocated up front, emission past the
+// budget is dropped, and dead particles are swap-removed so the live range
+// is always [0, Count()).
+class ParticleManager {
+public:
+    static const int DEFAULT_CAPACITY = 4096;
+    static constexpr float GRAVITY = 0.1f;
+    static const int EXPLOSION_PARTICLES = 20;   // at full detail
+    
+    explicit ParticleManager(int capacity = DEFAULT_CAPACITY);
+    
+    // Reallocates storage and drops all live particles; not for use mid-frame
+    void SetCapacity(int capacity);
+    // Velocities are stored per tick; see FrameContext::tickScale
+    void SetTickScale(float scale) { tickScale = scale; }
+    // Velocity added to vy each tick
+    float TickGravity() const { return GRAVITY * tickScale * tickScale; }
+    
+    // Scales explosion size and thins trails; 100/100 is the original look
+    void SetDetail(const EffectDetail& detail);
+    const EffectDetail& GetDetail() const { return detail; }
+    
+    void AddExplosion(Vec2 position, Rgba color, Rng& rng);
+    void AddTrail(Vec2 position, Rgba color, Rng& rng);
+    // Integration is split across `jobs` when given; removal stays serial
+    void Update(float dt, JobSystem* jobs = nullptr);
+    
+    bool Emit(Vec2 position, Vec2 velocity, Rgba color, float lifetime, float size) {
+        int i = store.Spawn();
+        if (i < 0) return false;
+        px[i] = position.x;
+        py[i] = position.y;
+        vx[i] = velocity.x;
+        vy[i] = velocity.y;
+        life[i] = lifetime;
+        maxLife[i] = lifetime;
+        sizes[i] = size;
+        colors[i] = color;
+        return true;
+    }
+    
+    void Clear() {
+        store.Clear();
+        trailCredit = 0;
+    }
+    
+    int Count() const { return store.Size(); }
+    int Capacity() const { return store.Capacity(); }
+    // Emissions rejected because the budget was full, since construction
+    long Dropped() const { return store.Dropped(); }
+    const Archetype& Store() const { return store; }
+    
+    // Live particles, detail and trail credit; Load may change the capacity
+    void Save(SnapshotWriter& out) const;
+    bool Load(SnapshotReader& in);
+    
+    // Read-only views of the live range, for rendering. The position at the
+    // start of the last tick is (x - vx, y - (vy - TickGravity())).
+    const float* PositionX() const { return px; }
+    const float* PositionY() const { return py; }
+    const float* VelocityX() const { return vx; }
+    const float* VelocityY() const { return vy; }
+    const float* Lifetime() const { return life; }
+    const float* MaxLifetime() const { return maxLife; }
+    const float* Size() const { return sizes; }
+    const Rgba* Colors() const { return colors; }
+    
+private:
+    void BindColumns();
+    
+    Archetype store;
+    float tickScale = 1.0f;
+    EffectDetail detail;
+    int explosionParticles = EXPLOSION_PARTICLES;
+    int trailCredit = 0;   // percent accumulated towards the next trail puff
+    // Cached column pointers; storage only moves in SetCapacity
+    float* px = nullptr;
+    float* py = nullptr;
+    float* vx = nullptr;
+    float* vy = nullptr;
+    float* life = nullptr;
+    float* maxLife = nullptr;
+    float* sizes = nullptr;
+    Rgba* colors = nullptr;
+};
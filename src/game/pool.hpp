@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+
+// Stable reference to an entity in an Archetype with COMP_HANDLE. The
+// generation changes every time a slot is reused, so a handle to a
+// despawned entity never resolves again.
+struct PoolHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+    
+    bool IsValid() const { return slot != UINT32_MAX; }
+};
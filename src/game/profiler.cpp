@@ -0,0 +1,139 @@
+#include "profiler.hpp"
+
+#ifdef ENABLE_PROFILER
+#include <chrono>
+#include <cstdio>
+
+static thread_local int scopeDepth = 0;
+static std::atomic<int> nextThreadId(0);
+static thread_local int threadId = -1;
+
+static int CurrentThreadId() {
+    if (threadId < 0) threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+    return threadId;
+}
+
+Profiler& Profiler::Get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : epochNs(0), events(), head(0), frameIndex(0), frameStartNs(0),
+      frameHistory(), frameHistoryStart(0), frameHistoryCount(0), totals(), totalCount(0) {
+    epochNs = NowNs();
+}
+
+uint64_t Profiler::NowNs() const {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() - epochNs;
+}
+
+void Profiler::Record(const char* name, uint64_t startNs, uint64_t endNs, int depth) {
+    // Claiming a slot is the only shared write; old events are overwritten
+    uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+    ProfileEvent& e = events[index & (EVENT_CAPACITY - 1)];
+    e.name = name;
+    e.startNs = startNs;
+    e.durationNs = (uint32_t)(endNs - startNs);
+    e.frame = frameIndex;
+    e.depth = (uint16_t)depth;
+    e.thread = (uint16_t)CurrentThreadId();
+}
+
+void Profiler::BeginFrame() {
+    frameStartNs = NowNs();
+}
+
+void Profiler::EndFrame() {
+    float ms = (NowNs() - frameStartNs) / 1e6f;
+    if (frameHistoryCount < FRAME_HISTORY) {
+        frameHistory[(frameHistoryStart + frameHistoryCount++) % FRAME_HISTORY] = ms;
+    } else {
+        frameHistory[frameHistoryStart] = ms;
+        frameHistoryStart = (frameHistoryStart + 1) % FRAME_HISTORY;
+    }
+    SumFrame(frameIndex);
+    frameIndex++;
+}
+
+float Profiler::FrameMs(int i) const {
+    return frameHistory[(frameHistoryStart + i) % FRAME_HISTORY];
+}
+
+void Profiler::SumFrame(uint32_t frame) {
+    totalCount = 0;
+    uint64_t end = head.load(std::memory_order_acquire);
+    uint64_t begin = end > (uint64_t)EVENT_CAPACITY ? end - EVENT_CAPACITY : 0;
+    // Newest first; events of one frame are contiguous apart from worker stragglers
+    for (uint64_t i = end; i > begin; i--) {
+        const ProfileEvent& e = events[(i - 1) & (EVENT_CAPACITY - 1)];
+        if (e.frame != frame) {
+            if (e.frame < frame) break;
+            continue;
+        }
+        int t = 0;
+        while (t < totalCount && totals[t].name != e.name) t++;
+        if (t == totalCount) {
+            if (totalCount == MAX_SCOPE_TOTALS) continue;
+            totals[totalCount++] = ScopeTotal{e.name, 0.0f, e.depth, 0};
+        }
+        totals[t].ms += e.durationNs / 1e6f;
+        totals[t].calls++;
+        if (e.depth < totals[t].depth) totals[t].depth = e.depth;
+    }
+    // Reverse so parents come before children, roughly in frame order
+    for (int a = 0, b = totalCount - 1; a < b; a++, b--) {
+        ScopeTotal tmp = totals[a];
+        totals[a] = totals[b];
+        totals[b] = tmp;
+    }
+}
+
+template <typename Fn>
+void Profiler::ForEachEvent(Fn&& fn) const {
+    uint64_t end = head.load(std::memory_order_acquire);
+    uint64_t begin = end > (uint64_t)EVENT_CAPACITY ? end - EVENT_CAPACITY : 0;
+    for (uint64_t i = begin; i < end; i++) {
+        fn(events[i & (EVENT_CAPACITY - 1)]);
+    }
+}
+
+bool Profiler::WriteChromeTrace(const char* path) const {
+    std::FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+    // Complete ("X") events; load in chrome://tracing or ui.perfetto.dev
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    ForEachEvent([&](const ProfileEvent& e) {
+        std::fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+                        "\"args\":{\"frame\":%u}}",
+                     first ? "" : ",\n", e.name, (unsigned)e.thread, e.startNs / 1e3, e.durationNs / 1e3,
+                     (unsigned)e.frame);
+        first = false;
+    });
+    std::fprintf(f, "\n]}\n");
+    return std::fclose(f) == 0;
+}
+
+bool Profiler::WriteCsv(const char* path) const {
+    std::FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+    std::fprintf(f, "frame,thread,depth,name,start_us,duration_us\n");
+    ForEachEvent([&](const ProfileEvent& e) {
+        std::fprintf(f, "%u,%u,%u,%s,%.3f,%.3f\n", (unsigned)e.frame, (unsigned)e.thread, (unsigned)e.depth,
+                     e.name, e.startNs / 1e3, e.durationNs / 1e3);
+    });
+    return std::fclose(f) == 0;
+}
+
+ProfileScope::ProfileScope(const char* name)
+    : name(name), startNs(Profiler::Get().NowNs()), depth(scopeDepth++) {}
+
+ProfileScope::~ProfileScope() {
+    scopeDepth--;
+    Profiler& profiler = Profiler::Get();
+    profiler.Record(name, startNs, profiler.NowNs(), depth);
+}
+
+#endif  // ENABLE_PROFILER
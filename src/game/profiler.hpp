@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Hierarchical frame profiler. PROFILE_SCOPE("name") times the enclosing
+// block; finished scopes go into a fixed ring buffer that any thread can
+// append to without locking. Names must be string literals (the pointer is
+// stored, not the text).
+//
+// Everything is compiled out unless ENABLE_PROFILER is defined (debug
+// builds, or `xmake f --profiler=y` for release/Android profiling).
+
+#ifdef ENABLE_PROFILER
+    #define PROFILE_CONCAT_(a, b) a##b
+    #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+    #define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+    #define PROFILE_BEGIN_FRAME() Profiler::Get().BeginFrame()
+    #define PROFILE_END_FRAME() Profiler::Get().EndFrame()
+#else
+    #define PROFILE_SCOPE(name) ((void)0)
+    #define PROFILE_BEGIN_FRAME() ((void)0)
+    #define PROFILE_END_FRAME() ((void)0)
+#endif
+
+#ifdef ENABLE_PROFILER
+
+struct ProfileEvent {
+    const char* name;
+    uint64_t startNs;     // since the profiler was created
+    uint32_t durationNs;
+    uint32_t frame;
+    uint16_t depth;       // nesting level on its thread, 0 = outermost
+    uint16_t thread;      // small per-thread index, 0 = first thread seen
+};
+
+// Total time per scope name in the last finished frame
+struct ScopeTotal {
+    const char* name;
+    float ms;
+    int depth;   // shallowest depth the name was seen at
+    int calls;
+};
+
+class Profiler {
+public:
+    static const int EVENT_CAPACITY = 1 << 16;   // power of two
+    static const int FRAME_HISTORY = 240;
+    static const int MAX_SCOPE_TOTALS = 32;
+    
+    static Profiler& Get();
+    
+    uint64_t NowNs() const;
+    void Record(const char* name, uint64_t startNs, uint64_t endNs, int depth);
+    
+    // Frame boundaries, called on the main thread outside any parallel work
+    void BeginFrame();
+    void EndFrame();
+    
+    // Frame times in ms, oldest first; Count() <= FRAME_HISTORY
+    int FrameCount() const { return frameHistoryCount; }
+    float FrameMs(int i) const;
+    const ScopeTotal* LastFrameTotals() const { return totals; }
+    int LastFrameTotalCount() const { return totalCount; }
+    
+    // Dumps every event still in the ring. Call between frames. Returns
+    // false if the file cannot be written.
+    bool WriteChromeTrace(const char* path) const;
+    bool WriteCsv(const char* path) const;
+    
+private:
+    Profiler();
+    
+    template <typename Fn>
+    void ForEachEvent(Fn&& fn) const;
+    void SumFrame(uint32_t frame);
+    
+    uint64_t epochNs;
+    ProfileEvent events[EVENT_CAPACITY];
+    std::atomic<uint64_t> head;   // total events ever recorded
+    
+    uint32_t frameIndex;
+    uint64_t frameStartNs;
+    float frameHistory[FRAME_HISTORY];
+    int frameHistoryStart;
+    int frameHistoryCount;
+    ScopeTotal totals[MAX_SCOPE_TOTALS];
+    int totalCount;
+    
+    friend class ProfileScope;
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name);
+    ~ProfileScope();
+    
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+    
+private:
+    const char* name;
+    uint64_t startNs;
+    int depth;
+};
+
+#endif  // ENABLE_PROFILER
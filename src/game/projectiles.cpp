@@ -0,0 +1,162 @@
+#include "projectiles.hpp"
+#include <algorithm>
+#include <cmath>
+#include "job_system.hpp"
+#include "snapshot.hpp"
+#include "swept_collision.hpp"
+#include "systems.hpp"
+
+// A move and a bounds test are a few ns a shot, so a chunk is enough work to
+// pay for handing it to a worker, and 20k shots still split five ways
+static const int PROJECTILE_GRAIN = 4096;
+
+ProjectileManager::ProjectileManager(int capacity) : store("projectiles", PROJECTILE_COMPONENTS, capacity) {
+    BindColumns();
+}
+
+void ProjectileManager::SetCapacity(int newCapacity) {
+    store.SetCapacity(newCapacity);
+    BindColumns();
+    RecomputeReach();
+}
+
+void ProjectileManager::BindColumns() {
+    px = store.Column(COL_X);
+    py = store.Column(COL_Y);
+    vx = store.Column(COL_VX);
+    vy = store.Column(COL_VY);
+    radius = store.Column(COL_RADIUS);
+    colors = store.Colors();
+}
+
+void ProjectileManager::RecomputeReach() {
+    maxRadius = 0;
+    maxStep = 0;
+    for (int i = 0; i < store.Size(); i++) {
+        maxRadius = std::max(maxRadius, radius[i]);
+        maxStep = std::max(maxStep, std::max(std::fabs(vx[i]), std::fabs(vy[i])));
+    }
+}
+
+int ProjectileManager::EmitArc(Vec2 origin, float angle, float step, int count, float speed, float shotRadius,
+                               Rgba color) {
+    ShapeKind* shapes = store.Shapes();
+    int emitted = 0;
+    for (int k = 0; k < count; k++) {
+        int i = store.Spawn();
+        if (i < 0) continue;   // counted as dropped
+        float a = (angle + step * k) * DEG_TO_RAD;
+        px[i] = origin.x;
+        py[i] = origin.y;
+        vx[i] = cosf(a) * speed;
+        vy[i] = sinf(a) * speed;
+        radius[i] = shotRadius;
+        colors[i] = color;
+        shapes[i] = ShapeKind::Shot;
+        emitted++;
+    }
+    if (emitted > 0) {
+        // |cos| and |sin| never exceed 1, so neither axis steps past `speed`
+        maxRadius = std::max(maxRadius, shotRadius);
+        maxStep = std::max(maxStep, std::fabs(speed));
+    }
+    return emitted;
+}
+
+int ProjectileManager::Fire(const EnemyWeapon& weapon, Vec2 origin, Vec2 target, float turn,
+                            const FrameContext& frame) {
+    float speed = weapon.speed * frame.scale * frame.tickScale;
+    int shots = weapon.shots;
+    switch (weapon.pattern) {
+        case FIRE_RADIAL:
+            return EmitArc(origin, 90.0f, 360.0f / shots, shots, speed, weapon.radius, weapon.color);
+        
+        case FIRE_SPIRAL:
+            return EmitArc(origin, 90.0f + turn, 360.0f / shots, shots, speed, weapon.radius, weapon.color);
+        
+        case FIRE_AIMED_FAN: {
+            float centre = atan2f(target.y - origin.y, target.x - origin.x) / DEG_TO_RAD;
+            if (shots == 1) return EmitArc(origin, centre, 0, 1, speed, weapon.radius, weapon.color);
+            return EmitArc(origin, centre - weapon.spread * 0.5f, weapon.spread / (shots - 1), shots, speed,
+                           weapon.radius, weapon.color);
+        }
+        
+        default:
+            return 0;
+    }
+}
+
+void ProjectileManager::Update(const FrameContext& frame, JobSystem* jobs) {
+    float margin = maxRadius * frame.scale;
+    DespawnBounds bounds{-margin, -margin, frame.width + margin, frame.height + margin};
+    auto step = [this, &bounds](int begin, int end) {
+        MoveSystem(store, begin, end);
+        DespawnSystem(store, bounds, begin, end);
+    };
+    if (jobs) jobs->ParallelFor(store.Size(), PROJECTILE_GRAIN, step);
+    else step(0, store.Size());
+}
+
+// Shots per cull block; the flags fit on the stack
+static const int CULL_BLOCK = 512;
+
+int ProjectileManager::FindHit(Vec2 from, Vec2 to, float targetRadius, float scale) const {
+    // Shots are culled at their end position, so the box covers the target's
+    // whole segment widened by the largest collider and step
+    float reach = targetRadius + maxRadius * scale + maxStep;
+    float minX = std::min(from.x, to.x) - reach, maxX = std::max(from.x, to.x) + reach;
+    float minY = std::min(from.y, to.y) - reach, maxY = std::max(from.y, to.y) + reach;
+    Vec2 motion(to.x - from.x, to.y - from.y);
+    const uint8_t* alive = store.Alive();
+    
+    SweptPairBatch batch;
+    int hit = -1;
+    float toi = SWEPT_MISS;
+    uint8_t inside[CULL_BLOCK];
+    for (int base = 0; base < store.Size(); base += CULL_BLOCK) {
+        int n = std::min(CULL_BLOCK, store.Size() - base);
+        const float* x = px + base;
+        const float* y = py + base;
+        // Branch-free so it vectorizes; almost every shot is outside, and
+        // a branch per comparison would mispredict on scattered positions
+        int any = 0;
+        for (int k = 0; k < n; k++) {
+            int in = (x[k] >= minX) & (x[k] <= maxX) & (y[k] >= minY) & (y[k] <= maxY);
+            inside[k] = (uint8_t)in;
+            any |= in;
+        }
+        if (!any) continue;
+        for (int k = 0; k < n; k++) {
+            int i = base + k;
+            if (!inside[k] || !alive[i]) continue;
+            if (batch.Full()) batch.Resolve(&hit, &toi);
+            batch.Add(0, i,
+                      Vec2((px[i] - vx[i]) - from.x, (py[i] - vy[i]) - from.y),
+                      Vec2(vx[i] - motion.x, vy[i] - motion.y),
+                      radius[i] * scale + targetRadius);
+        }
+    }
+    batch.Resolve(&hit, &toi);
+    return hit;
+}
+
+void ProjectileManager::RemoveDead() {
+    store.RemoveDead();
+    if (store.Empty()) RecomputeReach();
+}
+
+void ProjectileManager::Clear() {
+    store.Clear();
+    RecomputeReach();
+}
+
+void ProjectileManager::Save(SnapshotWriter& out) const {
+    store.Save(out);
+}
+
+bool ProjectileManager::Load(SnapshotReader& in) {
+    bool ok = store.Load(in);
+    BindColumns();
+    if (ok) RecomputeReach();
+    return ok;
+}
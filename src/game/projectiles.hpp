@@ -0,0 +1,87 @@
+#pragma once
+#include "ecs.hpp"
+#include "enemy_tables.hpp"
+#include "frame_context.hpp"
+#include "types.hpp"
+
+class JobSystem;
+class SnapshotReader;
+class SnapshotWriter;
+
+// No PREV_POSITION: shots fly straight, so the position at the start of the
+// tick is (x - vx, y - vy). The radius is at scale 1, like bullets.
+const uint32_t PROJECTILE_COMPONENTS = COMP_POSITION | COMP_VELOCITY | COMP_COLLIDER | COMP_SHAPE;
+
+// Enemy projectiles in their own fixed-size archetype, sized for bullet-hell
+// volleys with tens of thousands of shots alive. All storage is allocated up
+// front and emission past the budget is dropped. A tick is one pass of adds
+// and bounds tests over dense columns, split across a JobSystem.
+//
+// The player is the only target, so there is no grid: FindHit culls every
+// shot against the box the player's swept circle can reach in one pass,
+// and runs the swept test (swept_collision.hpp) on the few that remain. A
+// fast shot cannot step over the player between ticks.
+class ProjectileManager {
+public:
+    static const int DEFAULT_CAPACITY = 32768;
+    
+    explicit ProjectileManager(int capacity = DEFAULT_CAPACITY);
+    
+    // Reallocates storage and drops all live shots; not for use mid-frame
+    void SetCapacity(int capacity);
+    
+    // `count` shots from `origin`, the first heading `angle` degrees and each
+    // next one `step` degrees further round. `speed` is per tick. Returns how
+    // many fitted in the budget.
+    int EmitArc(Vec2 origin, float angle, float step, int count, float speed, float radius, Rgba color);
+    // One volley of `weapon`; aimed patterns aim at `target`, and `turn` is
+    // the spiral's angle so far
+    int Fire(const EnemyWeapon& weapon, Vec2 origin, Vec2 target, float turn, const FrameContext& frame);
+    
+    // Moves every shot one tick and kills those wholly off screen. Dead rows
+    // stay until RemoveDead, so kills can be applied in any order first.
+    void Update(const FrameContext& frame, JobSystem* jobs = nullptr);
+    // The live shot that first touches a circle of `radius` px moving from
+    // `from` to `to` during the last tick, lowest row on ties; -1 if none
+    int FindHit(Vec2 from, Vec2 to, float radius, float scale) const;
+    void Kill(int row) { store.Kill(row); }
+    void RemoveDead();
+    void Clear();
+    
+    int Count() const { return store.Size(); }
+    int Capacity() const { return store.Capacity(); }
+    // Shots rejected because the budget was full, since construction
+    long Dropped() const { return store.Dropped(); }
+    const Archetype& Store() const { return store; }
+    
+    // Live shots; Load may change the capacity
+    void Save(SnapshotWriter& out) const;
+    bool Load(SnapshotReader& in);
+    
+    // Read-only views of [0, Count()), for rendering and hashing. Between
+    // ticks every row is live.
+    const float* PositionX() const { return px; }
+    const float* PositionY() const { return py; }
+    const float* VelocityX() const { return vx; }
+    const float* VelocityY() const { return vy; }
+    const float* Radius() const { return radius; }
+    const Rgba* Colors() const { return colors; }
+    
+private:
+    void BindColumns();
+    void RecomputeReach();
+    
+    Archetype store;
+    // Bounds on any live shot's radius at scale 1 and per-axis step, for the
+    // despawn margin and the FindHit cull. Raised on emission, recomputed
+    // when the store empties or loads.
+    float maxRadius = 0;
+    float maxStep = 0;
+    // Cached column pointers; storage only moves in SetCapacity and Load
+    float* px = nullptr;
+    float* py = nullptr;
+    float* vx = nullptr;
+    float* vy = nullptr;
+    float* radius = nullptr;
+    Rgba* colors = nullptr;
+};
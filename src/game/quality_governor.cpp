@@ -0,0 +1,115 @@
+#include "quality_governor.hpp"
+#include <cstdio>
+
+// Effects go first since they cost both update and draw time; dropping to
+// 30 FPS is the last resort because it is the most visible.
+static const QualityLevel LEVELS[] = {
+    {"high",    {100, 100}, 1.0f, 60},
+    {"medium",  {60, 75},   0.75f, 60},
+    {"low",     {35, 50},   0.5f, 60},
+    {"minimal", {20, 25},   0.3f, 60},
+    {"30fps",   {20, 25},   0.3f, 30},
+};
+static const int LEVEL_COUNT = (int)(sizeof(LEVELS) / sizeof(LEVELS[0]));
+static const int MAX_UPSHIFT_BACKOFF = 8;
+
+int QualityGovernor::LevelCount() {
+    return LEVEL_COUNT;
+}
+
+const QualityLevel& QualityGovernor::Level(int level) {
+    if (level < 0) level = 0;
+    if (level >= LEVEL_COUNT) level = LEVEL_COUNT - 1;
+    return LEVELS[level];
+}
+
+QualityGovernor::QualityGovernor(const QualityGovernorConfig& cfg)
+    : config(cfg), level(0), frames(0), decisions(0), logger(nullptr), loggerUser(nullptr) {
+    if (config.windowFrames < 1) config.windowFrames = 1;
+    if (config.windowFrames > MAX_WINDOW) config.windowFrames = MAX_WINDOW;
+    windowSize = config.windowFrames;
+    upshiftFrames = config.upshiftFrames;
+    lastWasUpshift = false;
+    SetLevel(0);
+}
+
+void QualityGovernor::SetLevel(int value) {
+    level = value < 0 ? 0 : (value >= LEVEL_COUNT ? LEVEL_COUNT - 1 : value);
+    windowNext = 0;
+    windowCount = 0;
+    windowSum = 0;
+    sinceChange = 0;
+    headroomFrames = 0;
+}
+
+float QualityGovernor::BudgetMs(int at) const {
+    return config.frameBudgetMs * (float)LEVELS[0].targetFps / (float)Level(at).targetFps;
+}
+
+float QualityGovernor::AverageMs() const {
+    return windowCount < windowSize ? 0.0f : windowSum / (float)windowCount;
+}
+
+bool QualityGovernor::Sample(float updateMs, float drawMs) {
+    frames++;
+    sinceChange++;
+    
+    float ms = updateMs + drawMs;
+    if (config.pipelined) ms = updateMs > drawMs ? updateMs : drawMs;
+    if (windowCount == windowSize) windowSum -= window[windowNext];
+    else windowCount++;
+    window[windowNext] = ms;
+    windowSum += ms;
+    windowNext = (windowNext + 1) % windowSize;
+    
+    // A change invalidates the window, so wait for it to refill too
+    if (windowCount < windowSize || sinceChange < config.cooldownFrames) return false;
+    float average = windowSum / (float)windowCount;
+    
+    if (average > BudgetMs(level) * config.downshiftLoad) {
+        if (level + 1 >= LEVEL_COUNT) return false;
+        // Stepping straight back down after an upshift: that level did not fit
+        if (lastWasUpshift && sinceChange < config.probationFrames) {
+            int limit = config.upshiftFrames * MAX_UPSHIFT_BACKOFF;
+            upshiftFrames = upshiftFrames * 2 > limit ? limit : upshiftFrames * 2;
+        }
+        lastWasUpshift = false;
+        ChangeLevel(level + 1, updateMs, drawMs);
+        return true;
+    }
+    
+    if (level > 0 && average < BudgetMs(level - 1) * config.upshiftLoad) {
+        if (++headroomFrames >= upshiftFrames) {
+            lastWasUpshift = true;
+            ChangeLevel(level - 1, updateMs, drawMs);
+            return true;
+        }
+    } else {
+        headroomFrames = 0;
+    }
+    // A level that has held through probation earns the base delay back
+    if (lastWasUpshift && sinceChange >= config.probationFrames) {
+        upshiftFrames = config.upshiftFrames;
+    }
+    return false;
+}
+
+void QualityGovernor::ChangeLevel(int to, float updateMs, float drawMs) {
+    QualityDecision decision;
+    decision.frame = frames;
+    decision.fromLevel = level;
+    decision.toLevel = to;
+    decision.averageMs = windowSum / (float)windowCount;
+    decision.updateMs = updateMs;
+    decision.drawMs = drawMs;
+    decision.budgetMs = BudgetMs(level);
+    decisions++;
+    SetLevel(to);
+    if (logger) logger(decision, loggerUser);
+}
+
+int QualityGovernor::FormatDecision(const QualityDecision& d, char* buffer, int size) {
+    return std::snprintf(buffer, (size_t)size, "frame %llu: %s -> %s (avg %.2f ms, last update %.2f + draw %.2f, budget %.2f ms)",
+                         (unsigned long long)d.frame, Level(d.fromLevel).name, Level(d.toLevel).name,
+                         d.averageMs, d.updateMs, d.drawMs, d.budgetMs);
+}
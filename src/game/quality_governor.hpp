@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include "types.hpp"
+
+// One rung of the quality ladder, from full detail (level 0) down
+struct QualityLevel {
+    const char* name;
+    EffectDetail effects;   // applied to the simulation
+    float starDensity;      // Starfield::SetDensity
+    int targetFps;          // SetTargetFPS
+};
+
+struct QualityGovernorConfig {
+    // CPU time per frame (update + draw) allowed at the top level's target
+    // FPS; levels with a lower target FPS get proportionally more
+    float frameBudgetMs = 1000.0f / 60.0f;
+    // Step down when the window average exceeds this fraction of the budget
+    float downshiftLoad = 0.9f;
+    // Step up when the average would fit under this fraction of the next
+    // level's budget, sustained for `upshiftFrames`
+    float upshiftLoad = 0.6f;
+    int windowFrames = 30;      // averaging window, at most MAX_WINDOW
+    int cooldownFrames = 60;    // no decisions right after a change
+    int upshiftFrames = 180;
+    // An upshift undone within this many frames doubles `upshiftFrames`
+    // (up to 8x), so a level that does not fit is not retried every few seconds
+    int probationFrames = 300;
+    // Update and draw overlap on two threads (FramePipeline): a frame then
+    // costs the longer of the two rather than their sum
+    bool pipelined = false;
+};
+
+// One logged change of level and why it was made
+struct QualityDecision {
+    uint64_t frame;
+    int fromLevel;
+    int toLevel;
+    float averageMs;   // update + draw over the window
+    float updateMs;
+    float drawMs;
+    float budgetMs;    // of the level being left
+};
+
+typedef void (*QualityLogFn)(const QualityDecision& decision, void* user);
+
+// Picks a quality level from measured frame times. Feed it the CPU time of
+// every frame's update and draw; when the windowed average runs over budget
+// it steps down a level, and when there has been clear headroom for a while
+// it steps back up. Cooldown, hysteresis between the two thresholds and a
+// growing probation after failed upshifts keep it from oscillating.
+//
+// Pure arithmetic on the numbers it is given, so it runs the same on
+// synthetic timings (`headless check-governor`) as on a real device.
+class QualityGovernor {
+public:
+    static const int MAX_WINDOW = 240;
+    
+    explicit QualityGovernor(const QualityGovernorConfig& config = QualityGovernorConfig());
+    
+    // Adds one frame's timings; returns true if the level changed, in which
+    // case the caller applies Current()
+    bool Sample(float updateMs, float drawMs);
+    
+    // Forces a level (clamped) and restarts measurement; not logged
+    void SetLevel(int level);
+    int GetLevel() const { return level; }
+    const QualityLevel& Current() const { return Level(level); }
+    float BudgetMs(int level) const;
+    // Windowed average of update + draw, 0 until the window has filled
+    float AverageMs() const;
+    uint64_t FrameCount() const { return frames; }
+    int DecisionCount() const { return decisions; }
+    const QualityGovernorConfig& Config() const { return config; }
+    
+    // Called with every decision, e.g. to print it
+    void SetLogger(QualityLogFn fn, void* user = nullptr) { logger = fn; loggerUser = user; }
+    
+    static int LevelCount();
+    static const QualityLevel& Level(int level);
+    // "frame 1234: medium -> low (avg 15.20 ms, last update 9.10 + draw 8.10, budget 16.67 ms)"
+    static int FormatDecision(const QualityDecision& decision, char* buffer, int size);
+    
+private:
+    void ChangeLevel(int to, float updateMs, float drawMs);
+    
+    QualityGovernorConfig config;
+    float window[MAX_WINDOW];
+    int windowSize;
+    int windowNext;
+    int windowCount;
+    float windowSum;
+    int level;
+    uint64_t frames;
+    int sinceChange;        // frames since the last change
+    int headroomFrames;     // consecutive frames with room to step up
+    int upshiftFrames;      // current requirement, grows on failed upshifts
+    bool lastWasUpshift;
+    int decisions;
+    QualityLogFn logger;
+    void* loggerUser;
+};
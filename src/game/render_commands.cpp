@@ -0,0 +1,205 @@
+#include "render_commands.hpp"
+#include <cstring>
+
+static_assert(sizeof(RenderCommand) == 32, "render commands should stay compact");
+
+void RenderCommandList::Begin() {
+    commands.clear();
+    circles.clear();
+    vertices.clear();
+    text.clear();
+}
+
+void RenderCommandList::Reserve(int commandCount, int circleCount, int vertexCount, int textBytes) {
+    commands.reserve((size_t)commandCount);
+    circles.reserve((size_t)circleCount);
+    vertices.reserve((size_t)vertexCount);
+    text.reserve((size_t)textBytes);
+}
+
+RenderCommand& RenderCommandList::Add(RenderOp op, Rgba color) {
+    commands.push_back(RenderCommand{op, 0, 0, color, {0, 0, 0, 0}, 0, 0});
+    return commands.back();
+}
+
+void RenderCommandList::Clear(Rgba color) {
+    Add(RenderOp::Clear, color);
+}
+
+void RenderCommandList::Circle(Vec2 center, float radius, Rgba color) {
+    RenderCommand& cmd = Add(RenderOp::Circle, color);
+    cmd.v[0] = center.x;
+    cmd.v[1] = center.y;
+    cmd.v[2] = radius;
+}
+
+void RenderCommandList::Rect(float x, float y, float width, float height, Rgba color) {
+    RenderCommand& cmd = Add(RenderOp::Rect, color);
+    cmd.v[0] = x;
+    cmd.v[1] = y;
+    cmd.v[2] = width;
+    cmd.v[3] = height;
+}
+
+void RenderCommandList::Line(Vec2 from, Vec2 to, Rgba color) {
+    RenderCommand& cmd = Add(RenderOp::Line, color);
+    cmd.v[0] = from.x;
+    cmd.v[1] = from.y;
+    cmd.v[2] = to.x;
+    cmd.v[3] = to.y;
+}
+
+void RenderCommandList::Triangle(Vec2 a, Vec2 b, Vec2 c, Rgba color) {
+    MeshVertex* v = AddVertices(PrimitiveMode::Triangles, 3);
+    v[0] = MeshVertex{a.x, a.y, color};
+    v[1] = MeshVertex{b.x, b.y, color};
+    v[2] = MeshVertex{c.x, c.y, color};
+}
+
+void RenderCommandList::Text(const char* value, int x, int y, int fontSize, Rgba color) {
+    size_t length = std::strlen(value);
+    RenderCommand& cmd = Add(RenderOp::Text, color);
+    cmd.v[0] = (float)x;
+    cmd.v[1] = (float)y;
+    cmd.size = (uint16_t)fontSize;
+    cmd.first = (uint32_t)text.size();
+    cmd.count = (uint32_t)length;
+    text.insert(text.end(), value, value + length + 1);
+}
+
+CircleInstance* RenderCommandList::AddCircles(int count) {
+    if (count <= 0) return nullptr;
+    uint32_t first = (uint32_t)circles.size();
+    circles.resize(circles.size() + (size_t)count);
+    if (!commands.empty() && commands.back().op == RenderOp::Circles) {
+        commands.back().count += (uint32_t)count;
+    } else {
+        RenderCommand& cmd = Add(RenderOp::Circles, Rgba{0, 0, 0, 0});
+        cmd.first = first;
+        cmd.count = (uint32_t)count;
+    }
+    return circles.data() + first;
+}
+
+MeshVertex* RenderCommandList::AddVertices(PrimitiveMode mode, int count) {
+    if (count <= 0) return nullptr;
+    uint32_t first = (uint32_t)vertices.size();
+    vertices.resize(vertices.size() + (size_t)count);
+    if (!commands.empty() && commands.back().op == RenderOp::Vertices && commands.back().mode == (uint8_t)mode) {
+        commands.back().count += (uint32_t)count;
+    } else {
+        RenderCommand& cmd = Add(RenderOp::Vertices, Rgba{0, 0, 0, 0});
+        cmd.mode = (uint8_t)mode;
+        cmd.first = first;
+        cmd.count = (uint32_t)count;
+    }
+    return vertices.data() + first;
+}
+
+void RenderCommandList::AddVertices(PrimitiveMode mode, const std::vector<MeshVertex>& source) {
+    MeshVertex* out = AddVertices(mode, (int)source.size());
+    if (out) std::memcpy(out, source.data(), source.size() * sizeof(MeshVertex));
+}
+
+void RenderCommandList::SetTransform(Vec2 translation, float scale) {
+    RenderCommand& cmd = Add(RenderOp::SetTransform, Rgba{0, 0, 0, 0});
+    cmd.v[0] = translation.x;
+    cmd.v[1] = translation.y;
+    cmd.v[2] = scale;
+}
+
+void RenderCommandList::ResetTransform() {
+    Add(RenderOp::ResetTransform, Rgba{0, 0, 0, 0});
+}
+
+void RenderCommandList::BakeStarLayer(int layer, int width, int height, float starSize, const MeshVertex* stars,
+                                      int count) {
+    uint32_t first = (uint32_t)vertices.size();
+    vertices.insert(vertices.end(), stars, stars + count);
+    RenderCommand& cmd = Add(RenderOp::BakeStarLayer, Rgba{0, 0, 0, 0});
+    cmd.size = (uint16_t)layer;
+    cmd.v[0] = (float)width;
+    cmd.v[1] = (float)height;
+    cmd.v[2] = starSize;
+    cmd.first = first;
+    cmd.count = (uint32_t)count;
+}
+
+void RenderCommandList::DrawStars(const float* offsets, int layerCount) {
+    RenderCommand& cmd = Add(RenderOp::DrawStars, Rgba{255, 255, 255, 255});
+    cmd.size = (uint16_t)layerCount;
+    for (int l = 0; l < layerCount && l < 4; l++) cmd.v[l] = offsets[l];
+}
+
+size_t RenderCommandList::Bytes() const {
+    return commands.size() * sizeof(RenderCommand) + circles.size() * sizeof(CircleInstance) +
+           vertices.size() * sizeof(MeshVertex) + text.size();
+}
+
+// ---------------------------------------------------------------------------
+
+// FNV-1a over 32-bit words; every payload here is a whole number of words
+static void Mix(uint64_t& h, const void* data, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i + 4 <= size; i += 4) {
+        uint32_t word;
+        std::memcpy(&word, p + i, 4);
+        h = (h ^ word) * 1099511628211ull;
+    }
+}
+
+// Reads the first word of every circle or vertex, as a backend would.
+// Integer sums, so the loop vectorises like a real copy would.
+template <typename T>
+static uint32_t Touch(const T* items, uint32_t count) {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t bits;
+        std::memcpy(&bits, &items[i].x, 4);
+        sum += bits;
+    }
+    return sum;
+}
+
+void NullRenderBackend::Submit(const RenderCommandList& list) {
+    uint64_t h = checksum;
+    uint32_t touched = 0;
+    for (const RenderCommand& cmd : list.Commands()) {
+        if (checksumming) Mix(h, &cmd, sizeof(cmd));
+        switch (cmd.op) {
+            case RenderOp::Circles:
+                if (checksumming) Mix(h, list.Circles() + cmd.first, cmd.count * sizeof(CircleInstance));
+                touched += Touch(list.Circles() + cmd.first, cmd.count);
+                primitiveCount += cmd.count;
+                break;
+            case RenderOp::Vertices:
+                if (checksumming) Mix(h, list.Vertices() + cmd.first, cmd.count * sizeof(MeshVertex));
+                touched += Touch(list.Vertices() + cmd.first, cmd.count);
+                primitiveCount += cmd.count / (cmd.mode == (uint8_t)PrimitiveMode::Lines ? 2 : 3);
+                break;
+            case RenderOp::BakeStarLayer:
+                if (checksumming) Mix(h, list.Vertices() + cmd.first, cmd.count * sizeof(MeshVertex));
+                touched += Touch(list.Vertices() + cmd.first, cmd.count);
+                primitiveCount += cmd.count;
+                break;
+            case RenderOp::Text:
+                // Strings are not a whole number of words: hash bytewise
+                if (checksumming) {
+                    const char* str = list.TextPool() + cmd.first;
+                    for (uint32_t i = 0; i < cmd.count; i++) h = (h ^ (unsigned char)str[i]) * 1099511628211ull;
+                }
+                primitiveCount++;
+                break;
+            case RenderOp::Clear:
+            case RenderOp::SetTransform:
+            case RenderOp::ResetTransform:
+                break;
+            default:
+                primitiveCount++;
+                break;
+        }
+    }
+    checksum = h;
+    sink += touched;
+    commandCount += (long)list.Commands().size();
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "types.hpp"
+
+// One frame of drawing as data: a flat list of 32-byte commands plus pools
+// for the bulk payloads (circle instances, vertices, text). The scene is
+// recorded into a list on the simulation side (SceneRecorder) and replayed
+// by a RenderBackend, so recording can run on another thread than the GPU
+// submission and both can be timed without a window.
+//
+// Recording never shrinks storage: after warm-up a list is reused every
+// frame without allocating.
+
+enum class RenderOp : uint8_t {
+    Clear,            // color
+    Circle,           // v: x, y, radius
+    Rect,             // v: x, y, width, height
+    Line,             // v: x0, y0, x1, y1
+    Text,             // v: x, y; size: font size; first/count: text pool
+    Circles,          // first/count: circle pool
+    Vertices,         // first/count: vertex pool; mode: PrimitiveMode
+    SetTransform,     // v: translation x, y, scale; applies to later shapes
+    ResetTransform,
+    BakeStarLayer,    // v: width, height, star size; size: layer; first/count:
+                      // vertex pool (one per star). Only when stars change.
+    DrawStars,        // v: scroll offset per layer; size: layer count
+};
+
+enum class PrimitiveMode : uint8_t {
+    Triangles,   // three vertices each, counter-clockwise on screen
+    Lines,       // two vertices each
+};
+
+struct RenderCommand {
+    RenderOp op;
+    uint8_t mode;
+    uint16_t size;
+    Rgba color;
+    float v[4];
+    uint32_t first;
+    uint32_t count;
+};
+
+struct CircleInstance {
+    float x;
+    float y;
+    float radius;
+    Rgba color;
+};
+
+class RenderCommandList {
+public:
+    // Drops the previous frame, keeping all storage
+    void Begin();
+    // Grows storage to at least these sizes; cheap once it has
+    void Reserve(int commandCount, int circleCount, int vertexCount, int textBytes);
+    
+    void Clear(Rgba color);
+    void Circle(Vec2 center, float radius, Rgba color);
+    void Rect(float x, float y, float width, float height, Rgba color);
+    void Line(Vec2 from, Vec2 to, Rgba color);
+    void Triangle(Vec2 a, Vec2 b, Vec2 c, Rgba color);
+    // Copies the text, so it may change after the call
+    void Text(const char* text, int x, int y, int fontSize, Rgba color);
+    
+    // Space for `count` circles or vertices to be filled in by the caller.
+    // Consecutive batches of the same kind merge into one command.
+    CircleInstance* AddCircles(int count);
+    MeshVertex* AddVertices(PrimitiveMode mode, int count);
+    void AddVertices(PrimitiveMode mode, const std::vector<MeshVertex>& vertices);
+    
+    // Shapes recorded until ResetTransform are drawn scaled by `scale` about
+    // the origin, then moved to `translation`
+    void SetTransform(Vec2 translation, float scale);
+    void ResetTransform();
+    
+    // Starfield layers: baked from star points when they change, then drawn
+    // as scrolled tiles every frame
+    void BakeStarLayer(int layer, int width, int height, float starSize, const MeshVertex* stars, int count);
+    void DrawStars(const float* offsets, int layerCount);
+    
+    const std::vector<RenderCommand>& Commands() const { return commands; }
+    const CircleInstance* Circles() const { return circles.data(); }
+    const MeshVertex* Vertices() const { return vertices.data(); }
+    const char* TextPool() const { return text.data(); }
+    
+    int CircleCount() const { return (int)circles.size(); }
+    int VertexCount() const { return (int)vertices.size(); }
+    // Bytes recorded this frame, commands and pools together
+    size_t Bytes() const;
+    
+private:
+    RenderCommand& Add(RenderOp op, Rgba color);
+    
+    std::vector<RenderCommand> commands;
+    std::vector<CircleInstance> circles;
+    std::vector<MeshVertex> vertices;
+    std::vector<char> text;   // NUL-terminated strings
+};
+
+class RenderBackend {
+public:
+    virtual ~RenderBackend() = default;
+    virtual void Submit(const RenderCommandList& list) = 0;
+};
+
+// Walks every command and payload without drawing: the replay cost of a
+// list minus the GPU, for benchmarks and headless runs. With checksums on,
+// it also hashes everything that would change the picture.
+class NullRenderBackend : public RenderBackend {
+public:
+    void Submit(const RenderCommandList& list) override;
+    
+    void SetChecksum(bool enabled) { checksumming = enabled; }
+    uint64_t Checksum() const { return checksum; }
+    long Commands() const { return commandCount; }
+    long Primitives() const { return primitiveCount; }
+    
+private:
+    bool checksumming = false;
+    uint64_t checksum = 1469598103934665603ull;
+    long commandCount = 0;
+    long primitiveCount = 0;
+    uint32_t sink = 0;   // keeps the payload reads from being optimised away
+};
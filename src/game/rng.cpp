@@ -0,0 +1,53 @@
+#include "rng.hpp"
+#include "snapshot.hpp"
+
+static int ScaleToRange(uint32_t r, int min, uint64_t span) {
+    return (int)((int64_t)min + (int64_t)(((uint64_t)r * span) >> 32));
+}
+
+void Rng::FillRange(float* out, int count, int min, int max, float scale) {
+    if (min > max) { int t = min; min = max; max = t; }
+    uint64_t span = (uint64_t)((int64_t)max - min + 1);
+    int i = 0;
+    if (count >= 8) {
+        // s[k] holds the state k steps ahead; x -> a^4 x + c (a^3 + a^2 + a + 1)
+        // advances each lane by four
+        const uint64_t a = MULTIPLIER, c = increment;
+        const uint64_t a4 = a * a * a * a;
+        const uint64_t c4 = c * (a * a * a + a * a + a + 1);
+        uint64_t s0 = state;
+        uint64_t s1 = s0 * a + c;
+        uint64_t s2 = s1 * a + c;
+        uint64_t s3 = s2 * a + c;
+        for (; i + 4 <= count; i += 4) {
+            out[i] = (float)ScaleToRange(Output(s0), min, span) * scale;
+            out[i + 1] = (float)ScaleToRange(Output(s1), min, span) * scale;
+            out[i + 2] = (float)ScaleToRange(Output(s2), min, span) * scale;
+            out[i + 3] = (float)ScaleToRange(Output(s3), min, span) * scale;
+            s0 = s0 * a4 + c4;
+            s1 = s1 * a4 + c4;
+            s2 = s2 * a4 + c4;
+            s3 = s3 * a4 + c4;
+        }
+        state = s0;
+    }
+    for (; i < count; i++) out[i] = (float)ScaleToRange(Next(), min, span) * scale;
+}
+
+void Rng::Save(SnapshotWriter& out) const {
+    out.PutU64(state);
+    out.PutU64(increment);
+}
+
+bool Rng::Load(SnapshotReader& in) {
+    uint64_t savedState = in.GetU64();
+    uint64_t savedIncrement = in.GetU64();
+    if (!in.Ok()) return false;
+    if ((savedIncrement & 1) == 0) {
+        in.Fail("bad RNG state");
+        return false;
+    }
+    state = savedState;
+    increment = savedIncrement;
+    return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+
+class SnapshotReader;
+class SnapshotWriter;
+
+// PCG32 (XSH RR): 64-bit LCG state with a permuted 32-bit output. Small,
+// fast, identical on every platform, and every odd increment selects an
+// independent sequence, so each subsystem gets its own stream from one
+// seed. A stream's draws then depend only on that subsystem: more or fewer
+// explosion particles never shift where the next enemy spawns.
+//
+// An Rng is plain state, not shared: a parallel job that needs randomness
+// gets its own, seeded by (seed, stream id + chunk index) rather than by
+// thread, so results do not depend on scheduling.
+
+// Stream ids used by SpaceShooter
+enum RngStream : uint64_t {
+    RNG_SPAWN = 1,        // enemy placement and health
+    RNG_EXPLOSIONS = 2,   // explosion particles
+    RNG_TRAILS = 3,       // engine trail emission and particles
+};
+
+class Rng {
+public:
+    Rng() { Seed(0, 0); }
+    Rng(uint64_t seed, uint64_t stream) { Seed(seed, stream); }
+    
+    void Seed(uint64_t seed, uint64_t stream) {
+        state = 0;
+        increment = (stream << 1) | 1;
+        Next();
+        state += seed;
+        Next();
+    }
+    
+    uint32_t Next() {
+        uint64_t old = state;
+        state = old * MULTIPLIER + increment;
+        return Output(old);
+    }
+    
+    // Inclusive range, the contract GetRandomValue had. Multiply-shift
+    // instead of a modulo: no division, bias below 2^-32 * range.
+    int Range(int min, int max) {
+        if (min > max) { int t = min; min = max; max = t; }
+        uint64_t span = (uint64_t)((int64_t)max - min + 1);
+        return (int)((int64_t)min + (int64_t)(((uint64_t)Next() * span) >> 32));
+    }
+    
+    // True with probability 1/n
+    bool OneIn(uint32_t n) { return (((uint64_t)Next() * n) >> 32) == 0; }
+    
+    // `count` values of Range(min, max) * scale, the same values as that
+    // many Range calls. Integer draws scaled by one multiply, so results are
+    // bit-identical across compilers and FMA use. Four interleaved LCG lanes
+    // (each jumping four steps) break the multiply chain of one-at-a-time
+    // draws.
+    void FillRange(float* out, int count, int min, int max, float scale);
+    
+    void Save(SnapshotWriter& out) const;
+    // Fails on an even increment, which no Seed() produces
+    bool Load(SnapshotReader& in);
+    
+    bool operator==(const Rng& o) const { return state == o.state && increment == o.increment; }
+    bool operator!=(const Rng& o) const { return !(*this == o); }
+    
+private:
+    static const uint64_t MULTIPLIER = 6364136223846793005ull;
+    
+    static uint32_t Output(uint64_t old) {
+        uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rot = (uint32_t)(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+    
+    uint64_t state;
+    uint64_t increment;   // always odd
+};
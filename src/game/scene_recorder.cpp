@@ -0,0 +1,320 @@
+#include "scene_recorder.hpp"
+#include <cmath>
+#include "alloc_counter.hpp"
+#include "profiler.hpp"
+
+void SceneRecorder::Record(const SpaceShooter& game, const SceneFrameInfo& info, RenderCommandList& out) {
+    PROFILE_SCOPE("Record");
+    ALLOC_FREE_SCOPE("Record");
+    const FrameContext& frame = game.GetFrameContext();
+    out.Begin();
+    out.Clear(Palette::Black);
+    
+    // Starfield background
+    RecordStarfield(frame, info.frameTime, out);
+    
+    // Sized from the pools' capacities like EnemyMesh, so the list stops
+    // growing once the simulation's storage has
+    const int ENEMY_VERTICES = 3 + 6 + EnemyMesh::INDICATOR_SEGMENTS * 3;
+    const int OTHER_VERTICES = 64;   // ship, menu ship
+    int circleCount = game.GetParticles().Capacity() + 2 * game.GetBullets().Capacity() + game.GetProjectiles().Capacity();
+    out.Reserve(256, circleCount,
+                out.VertexCount() + game.GetEnemies().Capacity() * ENEMY_VERTICES + OTHER_VERTICES, 4096);
+    
+    switch (game.GetState()) {
+        case MENU:
+            RecordMenu(frame, info.time, out);
+            break;
+        
+        case PLAYING:
+            RecordGame(game, info.fps, out);
+            break;
+        
+        case PAUSED:
+            RecordGame(game, info.fps, out);
+            RecordPaused(frame, out);
+            break;
+        
+        case GAME_OVER:
+            RecordGame(game, info.fps, out);
+            RecordGameOver(game, out);
+            break;
+    }
+}
+
+void SceneRecorder::RecordParticles(const ParticleManager& particles, float alpha, RenderCommandList& out) {
+    const float* x = particles.PositionX();
+    const float* y = particles.PositionY();
+    const float* vx = particles.VelocityX();
+    const float* vy = particles.VelocityY();
+    // Step back from the current position by the part of the last tick not yet shown
+    float back = 1.0f - alpha;
+    float gravity = particles.TickGravity();
+    const float* life = particles.Lifetime();
+    const float* maxLife = particles.MaxLifetime();
+    const float* size = particles.Size();
+    const Rgba* colors = particles.Colors();
+    int count = particles.Count();
+    CircleInstance* circles = out.AddCircles(count);
+    for (int i = 0; i < count; i++) {
+        float fade = life[i] / maxLife[i];
+        Rgba color = colors[i];
+        color.a = static_cast<unsigned char>(255 * fade);
+        circles[i] = CircleInstance{x[i] - vx[i] * back, y[i] - (vy[i] - gravity) * back, size[i], color};
+    }
+}
+
+void SceneRecorder::RecordBullets(const Archetype& bullets, const FrameContext& frame, float alpha,
+                                  RenderCommandList& out) {
+    const float* radius = bullets.Column(COL_RADIUS);
+    const Rgba* colors = bullets.Colors();
+    int live = 0;
+    for (int i = 0; i < bullets.Size(); i++) live += bullets.IsAlive(i) ? 1 : 0;
+    // Coloured body, then a bright core half the size
+    CircleInstance* circles = out.AddCircles(2 * live);
+    for (int i = 0; i < bullets.Size(); i++) {
+        if (!bullets.IsAlive(i)) continue;
+        Vec2 position = Interpolate(bullets.PrevPosition(i), bullets.Position(i), alpha);
+        float r = radius[i] * frame.scale;
+        *circles++ = CircleInstance{position.x, position.y, r, colors[i]};
+        *circles++ = CircleInstance{position.x, position.y, r * 0.5f, Palette::White};
+    }
+}
+
+// One circle per shot, stepped back along its velocity like particles
+void SceneRecorder::RecordProjectiles(const ProjectileManager& projectiles, const FrameContext& frame, float alpha,
+                                      RenderCommandList& out) {
+    const float* x = projectiles.PositionX();
+    const float* y = projectiles.PositionY();
+    const float* vx = projectiles.VelocityX();
+    const float* vy = projectiles.VelocityY();
+    const float* radius = projectiles.Radius();
+    const Rgba* colors = projectiles.Colors();
+    float back = 1.0f - alpha;
+    int count = projectiles.Count();
+    CircleInstance* circles = out.AddCircles(count);
+    for (int i = 0; i < count; i++) {
+        circles[i] = CircleInstance{x[i] - vx[i] * back, y[i] - vy[i] * back, radius[i] * frame.scale, colors[i]};
+    }
+}
+
+// The ship in its own coordinates at scale 1, placed by a transform
+void SceneRecorder::RecordPlayer(const Player& player, const FrameContext& frame, float alpha,
+                                 RenderCommandList& out) {
+    Vec2 position = Interpolate(player.prevPosition, player.position, alpha);
+    
+    Rgba shipColor = player.invincible ? Palette::Blue : Palette::SkyBlue;
+    if (player.invincible && (int)(player.invincibleTimer * 10) % 2 == 0) {
+        shipColor.a = 128;
+    }
+    
+    out.SetTransform(position, frame.scale);
+    // Main body
+    out.Triangle(Vec2(0, -20), Vec2(-15, 15), Vec2(15, 15), shipColor);
+    // Cockpit
+    out.Circle(Vec2(0, 0), 6, Palette::DarkBlue);
+    // Wings
+    out.Rect(-20, 5, 8, 12, shipColor);
+    out.Rect(12, 5, 8, 12, shipColor);
+    // Engine glow
+    out.Circle(Vec2(-10, 15), 3, Palette::Orange);
+    out.Circle(Vec2(10, 15), 3, Palette::Orange);
+    out.ResetTransform();
+}
+
+// Star points go into the list only when the starfield regenerates; every
+// other frame carries just the scroll offsets
+void SceneRecorder::RecordStarfield(const FrameContext& frame, float frameTime, RenderCommandList& out) {
+    PROFILE_SCOPE("RecordStarfield");
+    starfield.Resize(frame.viewport);
+    starfield.Advance(frameTime);
+    if (starfield.Width() <= 0 || starfield.Height() <= 0) return;
+    
+    if (!starsRecorded || recordedStarGeneration != starfield.Generation()) {
+        for (int l = 0; l < starfield.LayerCount(); l++) {
+            starPoints.clear();
+            for (const auto& star : starfield.Stars(l)) {
+                unsigned char b = star.brightness;
+                starPoints.push_back(MeshVertex{star.x, star.y, Rgba{b, b, b, 255}});
+            }
+            out.BakeStarLayer(l, starfield.Width(), starfield.Height(), starfield.StarSize(l), starPoints.data(),
+                              (int)starPoints.size());
+        }
+        starsRecorded = true;
+        recordedStarGeneration = starfield.Generation();
+    }
+    
+    float offsets[Starfield::LAYER_COUNT];
+    for (int l = 0; l < starfield.LayerCount(); l++) offsets[l] = starfield.Offset(l);
+    out.DrawStars(offsets, starfield.LayerCount());
+}
+
+void SceneRecorder::RecordTextList(const TextDrawList& list, RenderCommandList& out) {
+    for (const TextCommand& cmd : list.Commands()) {
+        out.Text(cmd.text->Text(), cmd.x, cmd.y, cmd.text->FontSize(), cmd.color);
+    }
+}
+
+void SceneRecorder::RecordMenu(const FrameContext& frame, double time, RenderCommandList& out) {
+    PROFILE_SCOPE("RecordMenu");
+    int centerX = frame.viewport.width / 2;
+    float scale = frame.scale;
+    int titleSize = (int)(60 * scale);
+    int instructionSize = (int)(30 * scale);
+    int controlsTitleSize = (int)(20 * scale);
+    int textSize = (int)(16 * scale);
+    
+    MenuText& t = menuText;
+    const char* instruction = touchControls ? "TAP TO START" : "PRESS SPACE TO START";
+    const char* keyboardControls[3] = {"WASD or Arrow Keys - Move", "SPACE - Shoot", "P - Pause"};
+    const char* touchControlText[3] = {"Touch to move", "Auto shoot", nullptr};
+    const char* const* controls = touchControls ? touchControlText : keyboardControls;
+    
+    // Constant strings: measured once per font size
+    bool changed = t.title.Set("SPACE DEFENDER", titleSize, measure);
+    changed |= t.instruction.Set(instruction, instructionSize, measure);
+    changed |= t.controlsTitle.Set("CONTROLS:", controlsTitleSize, measure);
+    for (int i = 0; i < 3 && controls[i]; i++) {
+        changed |= t.controls[i].Set(controls[i], textSize, measure);
+    }
+    
+    if (changed || t.list.NeedsRebuild(frame.viewport)) {
+        t.list.Begin(frame.viewport);
+        // Title
+        t.list.AddCentered(t.title, centerX, (int)(150 * scale), Palette::SkyBlue);
+        t.list.AddCentered(t.title, centerX - 2, (int)(148 * scale), Palette::Blue);
+        // Instructions
+        t.list.AddCentered(t.instruction, centerX, (int)(300 * scale), Palette::White);
+        // Controls
+        t.list.AddCentered(t.controlsTitle, centerX, (int)(380 * scale), Palette::Yellow);
+        int y = (int)(410 * scale);
+        for (int i = 0; i < 3 && controls[i]; i++) {
+            t.list.AddCentered(t.controls[i], centerX, y + i * (int)(25 * scale), Palette::White);
+        }
+    }
+    RecordTextList(t.list, out);
+    
+    // Animated ship
+    float shipY = 240 * scale + sinf((float)time * 2) * 10 * scale;
+    out.Triangle(Vec2((float)centerX, shipY), Vec2(centerX - 15 * scale, shipY + 35 * scale),
+                 Vec2(centerX + 15 * scale, shipY + 35 * scale), Palette::SkyBlue);
+}
+
+void SceneRecorder::RecordGame(const SpaceShooter& game, int fps, RenderCommandList& out) {
+    PROFILE_SCOPE("RecordGame");
+    const FrameContext& frame = game.GetFrameContext();
+    // Paused or over: nothing advances, draw the settled state
+    float alpha = game.GetState() == PLAYING ? game.GetInterpolation() : 1.0f;
+    
+    // Game objects
+    {
+        PROFILE_SCOPE("RecordParticles");
+        RecordParticles(game.GetParticles(), alpha, out);
+    }
+    {
+        PROFILE_SCOPE("RecordBullets");
+        RecordBullets(game.GetBullets(), frame, alpha, out);
+    }
+    {
+        // All enemies in three batches: hulls, outlines, health indicators
+        PROFILE_SCOPE("RecordEnemies");
+        enemyMesh.Build(game.GetEnemies(), game.GetEnemyTables(), frame, alpha);
+        out.AddVertices(PrimitiveMode::Triangles, enemyMesh.Hulls());
+        out.AddVertices(PrimitiveMode::Lines, enemyMesh.Outlines());
+        out.AddVertices(PrimitiveMode::Triangles, enemyMesh.Indicators());
+    }
+    {
+        PROFILE_SCOPE("RecordPlayer");
+        RecordPlayer(game.GetPlayer(), frame, alpha, out);
+    }
+    {
+        // Over the ships, so shots stay readable in a crowd
+        PROFILE_SCOPE("RecordProjectiles");
+        RecordProjectiles(game.GetProjectiles(), frame, alpha, out);
+    }
+    
+    RecordUI(game, fps, out);
+}
+
+void SceneRecorder::RecordUI(const SpaceShooter& game, int fps, RenderCommandList& out) {
+    PROFILE_SCOPE("RecordUI");
+    const FrameContext& frame = game.GetFrameContext();
+    const Player& player = game.GetPlayer();
+    float scale = frame.scale;
+    int scoreSize = (int)(20 * scale);
+    int waveSize = (int)(16 * scale);
+    int margin = (int)(10 * scale);
+    int healthX = frame.viewport.width - (int)(180 * scale);
+    
+    // Only re-formatted when the score, wave or scale actually changes
+    HudText& t = hudText;
+    bool changed = t.score.SetInt("SCORE: %d", player.score, scoreSize, measure);
+    changed |= t.wave.SetInt("WAVE: %d", game.GetWave(), waveSize, measure);
+    changed |= t.health.Set("HEALTH:", scoreSize, measure);
+    
+    // FPS (landscape only on touch screens), cached like the rest
+    bool showFps = !touchControls || !frame.portrait;
+    changed |= t.fps.SetInt("%2i FPS", fps, 20, measure);
+    Rgba fpsColor = fps < 15 ? Palette::Red : (fps < 30 ? Palette::Orange : Palette::Lime);
+    
+    if (changed || t.list.NeedsRebuild(frame.viewport)) {
+        t.list.Begin(frame.viewport);
+        t.list.Add(t.score, margin, margin, Palette::Yellow);
+        t.list.Add(t.wave, margin, margin + scoreSize + 5, Palette::SkyBlue);
+        t.list.Add(t.health, healthX, margin, Palette::Red);
+        if (showFps) {
+            t.list.Add(t.fps, frame.viewport.width - (int)(80 * scale),
+                       frame.viewport.height - (int)(25 * scale), fpsColor);
+        }
+    }
+    RecordTextList(t.list, out);
+    
+    // Health
+    for (int i = 0; i < player.health; i++) {
+        out.Rect((float)(healthX + (int)(90 * scale) + i * (int)(18 * scale)), (float)(margin + (int)(3 * scale)),
+                 (float)(int)(15 * scale), (float)(int)(15 * scale), Palette::Red);
+    }
+}
+
+void SceneRecorder::RecordPaused(const FrameContext& frame, RenderCommandList& out) {
+    PROFILE_SCOPE("RecordPaused");
+    out.Rect(0, 0, (float)frame.viewport.width, (float)frame.viewport.height, Rgba{0, 0, 0, 180});
+    int centerX = frame.viewport.width / 2;
+    int centerY = frame.viewport.height / 2;
+    float scale = frame.scale;
+    
+    PausedText& t = pausedText;
+    bool changed = t.paused.Set("PAUSED", (int)(60 * scale), measure);
+    changed |= t.resume.Set("Press P to continue", (int)(20 * scale), measure);
+    if (changed || t.list.NeedsRebuild(frame.viewport)) {
+        t.list.Begin(frame.viewport);
+        t.list.AddCentered(t.paused, centerX, centerY - (int)(40 * scale), Palette::White);
+        t.list.AddCentered(t.resume, centerX, centerY + (int)(40 * scale), Palette::LightGray);
+    }
+    RecordTextList(t.list, out);
+}
+
+void SceneRecorder::RecordGameOver(const SpaceShooter& game, RenderCommandList& out) {
+    PROFILE_SCOPE("RecordGameOver");
+    const FrameContext& frame = game.GetFrameContext();
+    out.Rect(0, 0, (float)frame.viewport.width, (float)frame.viewport.height, Rgba{0, 0, 0, 180});
+    int centerX = frame.viewport.width / 2;
+    int centerY = frame.viewport.height / 2;
+    float scale = frame.scale;
+    
+    const char* restart = touchControls ? "Tap to return to menu" : "Press SPACE to return to menu";
+    
+    GameOverText& t = gameOverText;
+    bool changed = t.title.Set("GAME OVER", (int)(60 * scale), measure);
+    changed |= t.finalScore.SetInt("Final Score: %d", game.GetPlayer().score, (int)(30 * scale), measure);
+    changed |= t.waveReached.SetInt("Wave Reached: %d", game.GetWave(), (int)(25 * scale), measure);
+    changed |= t.restart.Set(restart, (int)(20 * scale), measure);
+    if (changed || t.list.NeedsRebuild(frame.viewport)) {
+        t.list.Begin(frame.viewport);
+        t.list.AddCentered(t.title, centerX, centerY - (int)(80 * scale), Palette::Red);
+        t.list.AddCentered(t.finalScore, centerX, centerY + (int)(20 * scale), Palette::Yellow);
+        t.list.AddCentered(t.waveReached, centerX, centerY + (int)(60 * scale), Palette::SkyBlue);
+        t.list.AddCentered(t.restart, centerX, centerY + (int)(120 * scale), Palette::White);
+    }
+    RecordTextList(t.list, out);
+}
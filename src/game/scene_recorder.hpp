@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include "enemy_mesh.hpp"
+#include "render_commands.hpp"
+#include "space_shooter.hpp"
+#include "starfield.hpp"
+#include "text_layout.hpp"
+
+// What the scene needs from the window each frame
+struct SceneFrameInfo {
+    double time = 0;       // seconds since start, for idle animation
+    float frameTime = 0;   // seconds since the last frame, scrolls the stars
+    int fps = 0;
+};
+
+// Records a SpaceShooter frame into a RenderCommandList. Moving objects are
+// placed between their previous and current tick positions using the
+// simulation's interpolation factor. Text measuring is injected (raylib's
+// MeasureText in the game), so this runs headless too.
+class SceneRecorder {
+public:
+    explicit SceneRecorder(MeasureTextFn measure) : measure(measure) {}
+    
+    // Replaces `out` with this frame
+    void Record(const SpaceShooter& game, const SceneFrameInfo& info, RenderCommandList& out);
+    // Multiplier on the background star count; rebakes on the next Record
+    void SetStarDensity(float density) { starfield.SetDensity(density); }
+    // Touch prompts instead of keyboard help, FPS counter in landscape only
+    void SetTouchControls(bool enabled) { touchControls = enabled; }
+    
+private:
+    void RecordStarfield(const FrameContext& frame, float frameTime, RenderCommandList& out);
+    void RecordMenu(const FrameContext& frame, double time, RenderCommandList& out);
+    void RecordGame(const SpaceShooter& game, int fps, RenderCommandList& out);
+    void RecordUI(const SpaceShooter& game, int fps, RenderCommandList& out);
+    void RecordPaused(const FrameContext& frame, RenderCommandList& out);
+    void RecordGameOver(const SpaceShooter& game, RenderCommandList& out);
+    
+    static void RecordTextList(const TextDrawList& list, RenderCommandList& out);
+    static void RecordParticles(const ParticleManager& particles, float alpha, RenderCommandList& out);
+    static void RecordBullets(const Archetype& bullets, const FrameContext& frame, float alpha,
+                              RenderCommandList& out);
+    static void RecordProjectiles(const ProjectileManager& projectiles, const FrameContext& frame, float alpha,
+                                  RenderCommandList& out);
+    static void RecordPlayer(const Player& player, const FrameContext& frame, float alpha, RenderCommandList& out);
+    
+    MeasureTextFn measure;
+    bool touchControls = false;
+    Starfield starfield;
+    uint32_t recordedStarGeneration = 0;
+    bool starsRecorded = false;
+    std::vector<MeshVertex> starPoints;   // bake scratch
+    EnemyMesh enemyMesh;
+    
+    // Retained UI text, one draw list per screen
+    struct MenuText {
+        CachedText title, instruction, controlsTitle, controls[3];
+        TextDrawList list;
+    } menuText;
+    struct HudText {
+        CachedText score, wave, health, fps;
+        TextDrawList list;
+    } hudText;
+    struct PausedText {
+        CachedText paused, resume;
+        TextDrawList list;
+    } pausedText;
+    struct GameOverText {
+        CachedText title, finalScore, waveReached, restart;
+        TextDrawList list;
+    } gameOverText;
+};
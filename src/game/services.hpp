@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include "types.hpp"
+#include "viewport.hpp"
+
+// Input sampled once per tick, already mapped from keys/touch to game actions
+struct InputState {
+    bool moveLeft = false;
+    bool moveRight = false;
+    bool moveUp = false;
+    bool moveDown = false;
+    bool fire = false;            // held
+    bool confirmPressed = false;  // start / return to menu
+    bool pausePressed = false;    // P
+    bool backPressed = false;     // ESC, also resumes from pause
+    bool touchActive = false;     // move towards touchPosition
+    Vec2 touchPosition;
+};
+
+// Everything the simulation needs from the outside world. The window build
+// backs these with raylib, the headless build with deterministic stand-ins.
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual float GetFrameTime() = 0;
+};
+
+// Where a run's randomness comes from. The simulation draws from its own
+// Rng streams (rng.hpp), all seeded from Seed() at construction.
+class RandomSource {
+public:
+    virtual ~RandomSource() = default;
+    virtual uint64_t Seed() = 0;
+};
+
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+    virtual InputState Poll() = 0;
+};
+
+class ViewportSource {
+public:
+    virtual ~ViewportSource() = default;
+    virtual Viewport GetViewport() = 0;
+};
+
+struct Services {
+    Clock& clock;
+    RandomSource& random;
+    InputSource& input;
+    ViewportSource& viewport;
+};
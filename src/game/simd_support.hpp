@@ -0,0 +1,23 @@
+#pragma once
+
+// Instruction sets the vector kernels (particle_simd.cpp, swept_collision.cpp)
+// can be built with. SSE2 and NEON are part of the baseline wherever they
+// are defined. AVX2 code is compiled per function with a target attribute
+// (GCC/Clang) and only dispatched to once IsParticleKernelAvailable has
+// checked the CPU.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define SIMD_HAVE_SSE2 1
+        #include <emmintrin.h>
+    #endif
+    #if defined(__GNUC__) && !defined(__INTEL_COMPILER)
+        #define SIMD_HAVE_AVX2 1
+        #include <immintrin.h>
+    #endif
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    #define SIMD_HAVE_NEON 1
+    #include <arm_neon.h>
+#endif
@@ -0,0 +1,223 @@
+#include "snapshot.hpp"
+#include <cstdio>
+#include <cstring>
+
+static const char SNAPSHOT_MAGIC[4] = {'S', 'D', 'S', 'S'};
+static const uint16_t SNAPSHOT_HEADER_SIZE = 24;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+static const bool HOST_LITTLE_ENDIAN = false;
+#else
+static const bool HOST_LITTLE_ENDIAN = true;
+#endif
+
+static void StoreLE(unsigned char* p, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static uint64_t LoadLE(const unsigned char* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t LoadWord(const unsigned char* p) {
+    if (!HOST_LITTLE_ENDIAN) return LoadLE(p, 8);
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// FNV-1a over 64-bit words in four interleaved lanes: byte-wise FNV, or a
+// single chain of dependent multiplies, would dominate the save time
+static uint64_t Checksum(const unsigned char* p, size_t size) {
+    const uint64_t prime = 1099511628211ull;
+    uint64_t h[4] = {1469598103934665603ull, 1469598103934665603ull ^ 1, 1469598103934665603ull ^ 2,
+                     1469598103934665603ull ^ 3};
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int k = 0; k < 4; k++) h[k] = (h[k] ^ LoadWord(p + i + 8 * k)) * prime;
+    }
+    for (; i + 8 <= size; i += 8) h[0] = (h[0] ^ LoadWord(p + i)) * prime;
+    if (i < size) h[1] = (h[1] ^ LoadLE(p + i, (int)(size - i))) * prime;
+    uint64_t result = (uint64_t)size;
+    for (int k = 0; k < 4; k++) result = (result ^ h[k]) * prime;
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned char* SnapshotWriter::Grow(size_t bytes) {
+    if (used + bytes > buffer.size()) {
+        size_t next = buffer.size() * 2;
+        buffer.resize(next > used + bytes ? next : used + bytes + 4096);
+    }
+    unsigned char* p = buffer.data() + used;
+    used += bytes;
+    return p;
+}
+
+void SnapshotWriter::Begin() {
+    used = 0;
+    Grow(SNAPSHOT_HEADER_SIZE);
+}
+
+void SnapshotWriter::Finish() {
+    unsigned char* header = buffer.data();
+    size_t payload = used - SNAPSHOT_HEADER_SIZE;
+    std::memcpy(header, SNAPSHOT_MAGIC, 4);
+    StoreLE(header + 4, SNAPSHOT_VERSION, 2);
+    StoreLE(header + 6, SNAPSHOT_HEADER_SIZE, 2);
+    StoreLE(header + 8, payload, 8);
+    StoreLE(header + 16, Checksum(header + SNAPSHOT_HEADER_SIZE, payload), 8);
+}
+
+void SnapshotWriter::PutU16(uint16_t v) {
+    StoreLE(Grow(2), v, 2);
+}
+
+void SnapshotWriter::PutU32(uint32_t v) {
+    StoreLE(Grow(4), v, 4);
+}
+
+void SnapshotWriter::PutU64(uint64_t v) {
+    StoreLE(Grow(8), v, 8);
+}
+
+void SnapshotWriter::PutF32(float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    PutU32(bits);
+}
+
+void SnapshotWriter::PutBytes(const void* bytes, size_t size) {
+    if (size == 0) return;
+    std::memcpy(Grow(size), bytes, size);
+}
+
+void SnapshotWriter::PutArray32(const void* values, int count) {
+    if (count <= 0) return;
+    if (HOST_LITTLE_ENDIAN) {
+        PutBytes(values, (size_t)count * 4);
+        return;
+    }
+    const uint32_t* words = static_cast<const uint32_t*>(values);
+    unsigned char* p = Grow((size_t)count * 4);
+    for (int i = 0; i < count; i++) StoreLE(p + 4 * i, words[i], 4);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SnapshotReader::Open(const unsigned char* bytes, size_t length) {
+    data = bytes;
+    size = length;
+    cursor = 0;
+    error = nullptr;
+    if (size < SNAPSHOT_HEADER_SIZE || std::memcmp(data, SNAPSHOT_MAGIC, 4) != 0) {
+        error = "not a snapshot";
+        return false;
+    }
+    if (LoadLE(data + 4, 2) != SNAPSHOT_VERSION) {
+        error = "unsupported snapshot version";
+        return false;
+    }
+    uint64_t headerSize = LoadLE(data + 6, 2);
+    uint64_t payload = LoadLE(data + 8, 8);
+    if (headerSize < SNAPSHOT_HEADER_SIZE || headerSize > size || payload != size - headerSize) {
+        error = "truncated snapshot";
+        return false;
+    }
+    if (Checksum(data + headerSize, (size_t)payload) != LoadLE(data + 16, 8)) {
+        error = "snapshot checksum mismatch";
+        return false;
+    }
+    cursor = (size_t)headerSize;
+    return true;
+}
+
+const unsigned char* SnapshotReader::Take(size_t bytes) {
+    if (error) return nullptr;
+    if (bytes > size - cursor) {
+        error = "snapshot ends early";
+        return nullptr;
+    }
+    const unsigned char* p = data + cursor;
+    cursor += bytes;
+    return p;
+}
+
+uint8_t SnapshotReader::GetU8() {
+    const unsigned char* p = Take(1);
+    return p ? p[0] : 0;
+}
+
+uint16_t SnapshotReader::GetU16() {
+    const unsigned char* p = Take(2);
+    return p ? (uint16_t)LoadLE(p, 2) : 0;
+}
+
+uint32_t SnapshotReader::GetU32() {
+    const unsigned char* p = Take(4);
+    return p ? (uint32_t)LoadLE(p, 4) : 0;
+}
+
+uint64_t SnapshotReader::GetU64() {
+    const unsigned char* p = Take(8);
+    return p ? LoadLE(p, 8) : 0;
+}
+
+float SnapshotReader::GetF32() {
+    uint32_t bits = GetU32();
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+bool SnapshotReader::GetBytes(void* out, size_t bytes) {
+    if (bytes == 0) return Ok();
+    const unsigned char* p = Take(bytes);
+    if (!p) return false;
+    std::memcpy(out, p, bytes);
+    return true;
+}
+
+bool SnapshotReader::GetArray32(void* out, int count) {
+    if (count <= 0) return Ok();
+    if (HOST_LITTLE_ENDIAN) return GetBytes(out, (size_t)count * 4);
+    const unsigned char* p = Take((size_t)count * 4);
+    if (!p) return false;
+    uint32_t* words = static_cast<uint32_t*>(out);
+    for (int i = 0; i < count; i++) words[i] = (uint32_t)LoadLE(p + 4 * i, 4);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+
+bool WriteSnapshotFile(const std::string& path, const SnapshotWriter& snapshot) {
+    std::string temp = path + ".tmp";
+    std::FILE* f = std::fopen(temp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(snapshot.Data(), 1, snapshot.Size(), f) == snapshot.Size();
+    ok = std::fclose(f) == 0 && ok;
+#if defined(_WIN32)
+    // rename does not replace an existing file on Windows
+    if (ok) std::remove(path.c_str());
+#endif
+    ok = ok && std::rename(temp.c_str(), path.c_str()) == 0;
+    if (!ok) std::remove(temp.c_str());
+    return ok;
+}
+
+bool ReadSnapshotFile(const std::string& path, std::vector<unsigned char>& out) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    out.clear();
+    unsigned char chunk[16 * 1024];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        out.insert(out.end(), chunk, chunk + n);
+    }
+    bool ok = !std::ferror(f);
+    std::fclose(f);
+    return ok;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Versioned binary snapshot of the whole simulation (SpaceShooter::
+// SaveSnapshot / LoadSnapshot): used to resume after Android kills the
+// activity, and to load fixtures into headless runs.
+//
+// Layout, all little-endian:
+//   header (24 bytes)
+//     char[4]  magic "SDSS"
+//     u16      version, u16 header size
+//     u64      payload size
+//     u64      payload checksum (four-lane FNV-1a over 64-bit words)
+//   payload, in the order SpaceShooter writes it; entity columns are stored
+//   as raw arrays of their live rows, so a save is mostly memcpy
+//
+// Snapshots from another version are rejected, not migrated: bump
+// SNAPSHOT_VERSION whenever the payload changes.
+
+const uint16_t SNAPSHOT_VERSION = 4;
+
+class SnapshotWriter {
+public:
+    // Starts a new snapshot; the buffer is kept, so steady-state saves do
+    // not allocate
+    void Begin();
+    // Fills in the header; Data()/Size() are then the complete snapshot
+    void Finish();
+    
+    void PutU8(uint8_t v) { *Grow(1) = v; }
+    void PutU16(uint16_t v);
+    void PutU32(uint32_t v);
+    void PutU64(uint64_t v);
+    void PutI32(int32_t v) { PutU32((uint32_t)v); }
+    void PutF32(float v);
+    void PutBytes(const void* data, size_t size);
+    // Arrays of 4-byte values (float, int32, uint32)
+    void PutArray32(const void* data, int count);
+    
+    const unsigned char* Data() const { return buffer.data(); }
+    size_t Size() const { return used; }
+    
+private:
+    unsigned char* Grow(size_t bytes);
+    
+    std::vector<unsigned char> buffer;
+    size_t used = 0;
+};
+
+// Bounds-checked reads over a snapshot in memory. A read past the end
+// returns zeros and latches an error, so loaders can check once at the end.
+class SnapshotReader {
+public:
+    // Validates magic, version, size and checksum
+    bool Open(const unsigned char* data, size_t size);
+    
+    uint8_t GetU8();
+    uint16_t GetU16();
+    uint32_t GetU32();
+    uint64_t GetU64();
+    int32_t GetI32() { return (int32_t)GetU32(); }
+    float GetF32();
+    bool GetBytes(void* out, size_t size);
+    bool GetArray32(void* out, int count);
+    
+    // For loaders that find the data inconsistent
+    void Fail(const char* why) { if (!error) error = why; }
+    bool Ok() const { return error == nullptr; }
+    const char* Error() const { return error; }
+    bool AtEnd() const { return cursor == size; }
+    
+private:
+    const unsigned char* Take(size_t bytes);
+    
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    size_t cursor = 0;
+    const char* error = nullptr;
+};
+
+// Writes to `path` via a temporary file and rename, so a kill mid-write
+// leaves the previous snapshot intact
+bool WriteSnapshotFile(const std::string& path, const SnapshotWriter& snapshot);
+bool ReadSnapshotFile(const std::string& path, std::vector<unsigned char>& out);
@@ -0,0 +1,571 @@
+#include "software_raster.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "job_system.hpp"
+#include "profiler.hpp"
+
+// Classic 5x7 font from ' ' to 'Z', one byte per column, bit 0 at the top.
+// Lower case is drawn as upper case; anything else as a space.
+static const uint8_t FONT_FIRST = 0x20;
+static const uint8_t FONT_LAST = 0x5A;
+static const uint8_t FONT[FONT_LAST - FONT_FIRST + 1][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},   //  !"
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},   // #$%
+    {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},   // &'(
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x14, 0x08, 0x3E, 0x08, 0x14}, {0x08, 0x08, 0x3E, 0x08, 0x08},   // )*+
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00},   // ,-.
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},   // /01
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10},   // 234
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},   // 567
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00},   // 89:
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14},   // ;<=
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E},   // >?@
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},   // ABC
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},   // DEF
+    {0x3E, 0x41, 0x49, 0x49, 0x7A}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},   // GHI
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},   // JKL
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},   // MNO
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},   // PQR
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},   // STU
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},   // VWX
+    {0x07, 0x08, 0x70, 0x08, 0x07}, {0x61, 0x51, 0x49, 0x45, 0x43},                                   // YZ
+};
+
+// Glyph cell in font units: 5 columns plus one of spacing, 10 rows like
+// raylib's default font (one above the glyph, two below)
+static const int GLYPH_ADVANCE = 6;
+static const int GLYPH_TOP = 1;
+static const int FONT_HEIGHT = 10;
+
+static const uint8_t* Glyph(char ch) {
+    unsigned char c = (unsigned char)ch;
+    if (c >= 'a' && c <= 'z') c = (unsigned char)(c - 'a' + 'A');
+    if (c < FONT_FIRST || c > FONT_LAST) c = ' ';
+    return FONT[c - FONT_FIRST];
+}
+
+// x / 255 rounded, exact for every product of two bytes
+static inline uint32_t Div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+// Source-over: rgb = src * a + dst * (1 - a), alpha = a + dst.a * (1 - a)
+static inline uint32_t Blend(uint32_t dst, Rgba c) {
+    uint32_t a = c.a, ia = 255 - a;
+    uint32_t r = Div255(c.r * a + (dst & 0xFF) * ia);
+    uint32_t g = Div255(c.g * a + ((dst >> 8) & 0xFF) * ia);
+    uint32_t b = Div255(c.b * a + ((dst >> 16) & 0xFF) * ia);
+    uint32_t outA = a + Div255((dst >> 24) * ia);
+    return r | g << 8 | b << 16 | outA << 24;
+}
+
+// Rounds a coordinate to the first pixel whose centre is at or after it,
+// clamped so huge or non-finite values cannot overflow the conversion
+static int FirstPixel(float v, int lo, int hi) {
+    float p = std::ceil(v - 0.5f);
+    if (!(p >= (float)lo)) return lo;
+    if (p > (float)hi) return hi;
+    return (int)p;
+}
+
+static int FloorClamped(float v, int lo, int hi) {
+    float p = std::floor(v);
+    if (!(p >= (float)lo)) return lo;
+    if (p > (float)hi) return hi;
+    return (int)p;
+}
+
+// One tile's slice of the image while it is being rasterized
+struct TileTarget {
+    uint32_t* pixels;
+    uint16_t* overdraw;   // null unless tracking
+    int stride;
+    int x0, y0, x1, y1;   // this primitive's bounds clipped to the tile
+    uint64_t fragments;
+    
+    void Fill(int y, int from, int to, Rgba color) {
+        if (from < x0) from = x0;
+        if (to > x1) to = x1;
+        if (from >= to || y < y0 || y >= y1) return;
+        fragments += (uint64_t)(to - from);
+        uint32_t* row = pixels + (size_t)y * stride;
+        if (overdraw) {
+            uint16_t* counts = overdraw + (size_t)y * stride;
+            for (int x = from; x < to; x++) {
+                if (counts[x] < 0xFFFF) counts[x]++;
+            }
+        }
+        if (color.a == 255) {
+            uint32_t packed = PackRgba(color);
+            for (int x = from; x < to; x++) row[x] = packed;
+        } else if (color.a > 0) {
+            for (int x = from; x < to; x++) row[x] = Blend(row[x], color);
+        }
+    }
+    
+    // Axis-aligned box covering the pixel centres in [x, x + w) x [y, y + h)
+    void FillRect(float x, float y, float w, float h, Rgba color) {
+        int top = FirstPixel(y, y0, y1), bottom = FirstPixel(y + h, y0, y1);
+        int left = FirstPixel(x, x0, x1), right = FirstPixel(x + w, x0, x1);
+        for (int row = top; row < bottom; row++) Fill(row, left, right, color);
+    }
+};
+
+SoftwareRenderBackend::SoftwareRenderBackend(int width, int height) : width(0), height(0) {
+    Resize(width, height);
+}
+
+void SoftwareRenderBackend::Resize(int newWidth, int newHeight) {
+    width = newWidth > 0 ? newWidth : 0;
+    height = newHeight > 0 ? newHeight : 0;
+    tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    pixels.assign((size_t)width * height, PackRgba(Rgba{0, 0, 0, 255}));
+    if (trackOverdraw) overdraw.assign(pixels.size(), 0);
+    bins.resize((size_t)tilesX * tilesY);
+    tileFragments.assign(bins.size(), 0);
+}
+
+void SoftwareRenderBackend::SetOverdrawTracking(bool enabled) {
+    trackOverdraw = enabled;
+    if (enabled) overdraw.assign(pixels.size(), 0);
+    else overdraw.clear();
+}
+
+int SoftwareRenderBackend::OverdrawAt(int x, int y) const {
+    if (!trackOverdraw || x < 0 || y < 0 || x >= width || y >= height) return 0;
+    return overdraw[(size_t)y * width + x];
+}
+
+int SoftwareRenderBackend::MeasureText(const char* text, int fontSize) {
+    int length = (int)std::strlen(text);
+    if (length == 0) return 0;
+    // No spacing after the last glyph
+    return (int)((length * GLYPH_ADVANCE - 1) * (fontSize / (float)FONT_HEIGHT));
+}
+
+void SoftwareRenderBackend::AddPrim(Prim& prim) {
+    if (prim.x0 >= prim.x1 || prim.y0 >= prim.y1) return;
+    uint32_t index = (uint32_t)prims.size();
+    prims.push_back(prim);
+    if (prim.type != PRIM_CLEAR) stats.primitives++;
+    int tx0 = prim.x0 / TILE_SIZE, tx1 = (prim.x1 - 1) / TILE_SIZE;
+    int ty0 = prim.y0 / TILE_SIZE, ty1 = (prim.y1 - 1) / TILE_SIZE;
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            bins[(size_t)ty * tilesX + tx].push_back(index);
+        }
+    }
+    stats.binEntries += (long)(tx1 - tx0 + 1) * (ty1 - ty0 + 1);
+}
+
+void SoftwareRenderBackend::AddRect(float x, float y, float w, float h, Rgba color) {
+    Prim p;
+    p.type = PRIM_RECT;
+    p.color = color;
+    p.x0 = FirstPixel(x, 0, width);
+    p.x1 = FirstPixel(x + w, 0, width);
+    p.y0 = FirstPixel(y, 0, height);
+    p.y1 = FirstPixel(y + h, 0, height);
+    p.v[0] = x;
+    p.v[1] = y;
+    p.v[2] = w;
+    p.v[3] = h;
+    AddPrim(p);
+}
+
+void SoftwareRenderBackend::AddCircle(float x, float y, float radius, Rgba color) {
+    if (!(radius > 0)) return;
+    Prim p;
+    p.type = PRIM_CIRCLE;
+    p.color = color;
+    p.x0 = FirstPixel(x - radius, 0, width);
+    p.x1 = FirstPixel(x + radius, 0, width) + 1;
+    p.y0 = FirstPixel(y - radius, 0, height);
+    p.y1 = FirstPixel(y + radius, 0, height) + 1;
+    if (p.x1 > width) p.x1 = width;
+    if (p.y1 > height) p.y1 = height;
+    p.v[0] = x;
+    p.v[1] = y;
+    p.v[2] = radius;
+    AddPrim(p);
+}
+
+// Flat-shaded with the first vertex's colour: the scene only records
+// single-colour triangles
+void SoftwareRenderBackend::AddTriangle(const MeshVertex& a, const MeshVertex& b, const MeshVertex& c) {
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (!(area != 0)) return;
+    Prim p;
+    p.type = PRIM_TRIANGLE;
+    p.color = a.color;
+    // Stored with a positive area so every edge function is positive inside
+    const MeshVertex& second = area > 0 ? b : c;
+    const MeshVertex& third = area > 0 ? c : b;
+    p.v[0] = a.x;
+    p.v[1] = a.y;
+    p.v[2] = second.x;
+    p.v[3] = second.y;
+    p.v[4] = third.x;
+    p.v[5] = third.y;
+    float minX = std::fmin(a.x, std::fmin(b.x, c.x)), maxX = std::fmax(a.x, std::fmax(b.x, c.x));
+    float minY = std::fmin(a.y, std::fmin(b.y, c.y)), maxY = std::fmax(a.y, std::fmax(b.y, c.y));
+    p.x0 = FirstPixel(minX, 0, width);
+    p.x1 = FirstPixel(maxX, 0, width) + 1;
+    p.y0 = FirstPixel(minY, 0, height);
+    p.y1 = FirstPixel(maxY, 0, height) + 1;
+    if (p.x1 > width) p.x1 = width;
+    if (p.y1 > height) p.y1 = height;
+    AddPrim(p);
+}
+
+void SoftwareRenderBackend::AddLine(float x0, float y0, float x1, float y1, Rgba color) {
+    Prim p;
+    p.type = PRIM_LINE;
+    p.color = color;
+    p.x0 = FloorClamped(std::fmin(x0, x1), 0, width);
+    p.x1 = FloorClamped(std::fmax(x0, x1), -1, width - 1) + 1;
+    p.y0 = FloorClamped(std::fmin(y0, y1), 0, height);
+    p.y1 = FloorClamped(std::fmax(y0, y1), -1, height - 1) + 1;
+    p.v[0] = x0;
+    p.v[1] = y0;
+    p.v[2] = x1;
+    p.v[3] = y1;
+    AddPrim(p);
+}
+
+void SoftwareRenderBackend::AddText(const char* text, float x, float y, float pixelScale, Rgba color) {
+    Prim p;
+    p.type = PRIM_TEXT;
+    p.color = color;
+    p.text = text;
+    float w = (float)std::strlen(text) * GLYPH_ADVANCE * pixelScale;
+    p.x0 = FloorClamped(x, 0, width);
+    p.x1 = FloorClamped(x + w, -1, width - 1) + 1;
+    p.y0 = FloorClamped(y, 0, height);
+    p.y1 = FloorClamped(y + FONT_HEIGHT * pixelScale, -1, height - 1) + 1;
+    p.v[0] = x;
+    p.v[1] = y;
+    p.v[2] = pixelScale;
+    AddPrim(p);
+}
+
+// Every star of every layer, twice: the layer tile and its wrapped copy
+// above, as the window draws the baked textures
+void SoftwareRenderBackend::AddStars(const float* offsets, int layerCount) {
+    for (int l = 0; l < layerCount && l < Starfield::LAYER_COUNT; l++) {
+        const StarLayer& layer = starLayers[l];
+        if (layer.width <= 0 || layer.height <= 0) continue;
+        for (int copy = 0; copy < 2; copy++) {
+            float offset = offsets[l] - copy * (float)layer.height;
+            for (const MeshVertex& star : layer.stars) {
+                if (layer.size <= 1.0f) {
+                    // DrawPixel truncates to whole texels
+                    AddRect((float)(int)star.x, (float)(int)star.y + offset, 1, 1, star.color);
+                } else {
+                    AddRect(star.x, star.y + offset, layer.size, layer.size, star.color);
+                }
+            }
+        }
+    }
+}
+
+void SoftwareRenderBackend::Submit(const RenderCommandList& list) {
+    PROFILE_SCOPE("RasterSubmit");
+    stats = RasterStats();
+    auto binStart = std::chrono::steady_clock::now();
+    prims.clear();
+    for (auto& bin : bins) bin.clear();
+    
+    const CircleInstance* circles = list.Circles();
+    const MeshVertex* vertices = list.Vertices();
+    Transform xf;
+    for (const RenderCommand& cmd : list.Commands()) {
+        switch (cmd.op) {
+            case RenderOp::Clear: {
+                Prim p;
+                p.type = PRIM_CLEAR;
+                p.color = cmd.color;
+                p.x0 = 0;
+                p.y0 = 0;
+                p.x1 = width;
+                p.y1 = height;
+                AddPrim(p);
+                break;
+            }
+            case RenderOp::Circle:
+                AddCircle(xf.X(cmd.v[0]), xf.Y(cmd.v[1]), xf.S(cmd.v[2]), cmd.color);
+                break;
+            
+            case RenderOp::Rect:
+                AddRect(xf.X(cmd.v[0]), xf.Y(cmd.v[1]), xf.S(cmd.v[2]), xf.S(cmd.v[3]), cmd.color);
+                break;
+            
+            case RenderOp::Line:
+                AddLine(xf.X(cmd.v[0]), xf.Y(cmd.v[1]), xf.X(cmd.v[2]), xf.Y(cmd.v[3]), cmd.color);
+                break;
+            
+            case RenderOp::Text:
+                AddText(list.TextPool() + cmd.first, xf.X(cmd.v[0]), xf.Y(cmd.v[1]),
+                        xf.S(cmd.size / (float)FONT_HEIGHT), cmd.color);
+                break;
+            
+            case RenderOp::Circles:
+                for (uint32_t i = cmd.first; i < cmd.first + cmd.count; i++) {
+                    const CircleInstance& c = circles[i];
+                    AddCircle(xf.X(c.x), xf.Y(c.y), xf.S(c.radius), c.color);
+                }
+                break;
+            
+            case RenderOp::Vertices: {
+                const MeshVertex* v = vertices + cmd.first;
+                if (cmd.mode == (uint8_t)PrimitiveMode::Lines) {
+                    for (uint32_t i = 0; i + 2 <= cmd.count; i += 2) {
+                        AddLine(xf.X(v[i].x), xf.Y(v[i].y), xf.X(v[i + 1].x), xf.Y(v[i + 1].y), v[i].color);
+                    }
+                } else {
+                    for (uint32_t i = 0; i + 3 <= cmd.count; i += 3) {
+                        MeshVertex a{xf.X(v[i].x), xf.Y(v[i].y), v[i].color};
+                        MeshVertex b{xf.X(v[i + 1].x), xf.Y(v[i + 1].y), v[i + 1].color};
+                        MeshVertex c{xf.X(v[i + 2].x), xf.Y(v[i + 2].y), v[i + 2].color};
+                        AddTriangle(a, b, c);
+                    }
+                }
+                break;
+            }
+            case RenderOp::SetTransform:
+                xf.active = true;
+                xf.x = cmd.v[0];
+                xf.y = cmd.v[1];
+                xf.scale = cmd.v[2];
+                break;
+            
+            case RenderOp::ResetTransform:
+                xf.active = false;
+                break;
+            
+            case RenderOp::BakeStarLayer:
+                if (cmd.size < Starfield::LAYER_COUNT) {
+                    StarLayer& layer = starLayers[cmd.size];
+                    layer.width = (int)cmd.v[0];
+                    layer.height = (int)cmd.v[1];
+                    layer.size = cmd.v[2];
+                    layer.stars.assign(vertices + cmd.first, vertices + cmd.first + cmd.count);
+                }
+                break;
+            
+            case RenderOp::DrawStars:
+                AddStars(cmd.v, cmd.size);
+                break;
+        }
+    }
+    auto rasterStart = std::chrono::steady_clock::now();
+    
+    if (trackOverdraw) std::fill(overdraw.begin(), overdraw.end(), (uint16_t)0);
+    int tileCount = tilesX * tilesY;
+    auto rasterTiles = [this](int begin, int end) {
+        for (int t = begin; t < end; t++) tileFragments[t] = RasterTile(t);
+    };
+    if (jobs) jobs->ParallelFor(tileCount, 1, rasterTiles);
+    else rasterTiles(0, tileCount);
+    for (int t = 0; t < tileCount; t++) stats.fragments += tileFragments[t];
+    
+    if (trackOverdraw) {
+        for (uint16_t count : overdraw) {
+            if (count > 0) stats.coveredPixels++;
+            if (count > stats.maxOverdraw) stats.maxOverdraw = count;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    stats.binMs = std::chrono::duration<double, std::milli>(rasterStart - binStart).count();
+    stats.rasterMs = std::chrono::duration<double, std::milli>(end - rasterStart).count();
+}
+
+uint64_t SoftwareRenderBackend::RasterTile(int tile) {
+    int tx = tile % tilesX, ty = tile / tilesX;
+    int left = tx * TILE_SIZE, top = ty * TILE_SIZE;
+    int right = left + TILE_SIZE < width ? left + TILE_SIZE : width;
+    int bottom = top + TILE_SIZE < height ? top + TILE_SIZE : height;
+    
+    TileTarget target;
+    target.pixels = pixels.data();
+    target.overdraw = trackOverdraw ? overdraw.data() : nullptr;
+    target.stride = width;
+    target.fragments = 0;
+    
+    for (uint32_t index : bins[tile]) {
+        const Prim& p = prims[index];
+        target.x0 = p.x0 > left ? p.x0 : left;
+        target.y0 = p.y0 > top ? p.y0 : top;
+        target.x1 = p.x1 < right ? p.x1 : right;
+        target.y1 = p.y1 < bottom ? p.y1 : bottom;
+        const float* v = p.v;
+        switch (p.type) {
+            case PRIM_CLEAR: {
+                // Not shading: a clear is a fill the GPU does for free
+                uint32_t packed = PackRgba(p.color);
+                for (int y = target.y0; y < target.y1; y++) {
+                    uint32_t* row = pixels.data() + (size_t)y * width;
+                    for (int x = target.x0; x < target.x1; x++) row[x] = packed;
+                }
+                break;
+            }
+            case PRIM_RECT:
+                target.FillRect(v[0], v[1], v[2], v[3], p.color);
+                break;
+            
+            case PRIM_CIRCLE: {
+                float r2 = v[2] * v[2];
+                for (int y = target.y0; y < target.y1; y++) {
+                    float dy = y + 0.5f - v[1];
+                    float h2 = r2 - dy * dy;
+                    if (h2 < 0) continue;
+                    float half = std::sqrt(h2);
+                    // Centres within `half` of the middle: [c - half, c + half]
+                    int from = FirstPixel(v[0] - half, target.x0, target.x1);
+                    int to = (int)std::floor(v[0] + half - 0.5f) + 1;
+                    target.Fill(y, from, to, p.color);
+                }
+                break;
+            }
+            case PRIM_TRIANGLE: {
+                // Edge functions, positive inside; pixels exactly on an edge
+                // belong to top and left edges only, so shared edges of
+                // adjacent triangles are drawn once
+                float ex[3], ey[3], ox[3], oy[3];
+                bool topLeft[3];
+                for (int e = 0; e < 3; e++) {
+                    int n = (e + 1) % 3;
+                    ox[e] = v[e * 2];
+                    oy[e] = v[e * 2 + 1];
+                    ex[e] = v[n * 2] - ox[e];
+                    ey[e] = v[n * 2 + 1] - oy[e];
+                    topLeft[e] = ey[e] < 0 || (ey[e] == 0 && ex[e] > 0);
+                }
+                for (int y = target.y0; y < target.y1; y++) {
+                    float py = y + 0.5f;
+                    int spanStart = -1;
+                    for (int x = target.x0; x <= target.x1; x++) {
+                        bool inside = x < target.x1;
+                        float px = x + 0.5f;
+                        for (int e = 0; e < 3 && inside; e++) {
+                            float f = ex[e] * (py - oy[e]) - ey[e] * (px - ox[e]);
+                            inside = f > 0 || (f == 0 && topLeft[e]);
+                        }
+                        if (inside && spanStart < 0) spanStart = x;
+                        if (!inside && spanStart >= 0) {
+                            // Convex: one span per row
+                            target.Fill(y, spanStart, x, p.color);
+                            break;
+                        }
+                    }
+                }
+                break;
+            }
+            case PRIM_LINE: {
+                // One pixel wide: a DDA along the major axis, as GL lines
+                float dx = v[2] - v[0], dy = v[3] - v[1];
+                if (std::fabs(dx) >= std::fabs(dy)) {
+                    if (dx == 0) break;
+                    float lo = std::fmin(v[0], v[2]), hi = std::fmax(v[0], v[2]);
+                    for (int x = target.x0; x < target.x1; x++) {
+                        float px = x + 0.5f;
+                        if (px < lo || px >= hi) continue;
+                        int y = (int)std::floor(v[1] + (px - v[0]) / dx * dy);
+                        target.Fill(y, x, x + 1, p.color);
+                    }
+                } else {
+                    float lo = std::fmin(v[1], v[3]), hi = std::fmax(v[1], v[3]);
+                    for (int y = target.y0; y < target.y1; y++) {
+                        float py = y + 0.5f;
+                        if (py < lo || py >= hi) continue;
+                        int x = (int)std::floor(v[0] + (py - v[1]) / dy * dx);
+                        target.Fill(y, x, x + 1, p.color);
+                    }
+                }
+                break;
+            }
+            case PRIM_TEXT: {
+                float s = v[2];
+                float cell = GLYPH_ADVANCE * s;
+                int first = (int)std::floor((target.x0 - v[0]) / cell);
+                if (first < 0) first = 0;
+                for (int i = first; p.text[i]; i++) {
+                    float gx = v[0] + i * cell;
+                    if (gx >= (float)target.x1) break;
+                    const uint8_t* glyph = Glyph(p.text[i]);
+                    for (int col = 0; col < 5; col++) {
+                        for (int row = 0; row < 7; row++) {
+                            if (glyph[col] & (1 << row)) {
+                                target.FillRect(gx + col * s, v[1] + (GLYPH_TOP + row) * s, s, s, p.color);
+                            }
+                        }
+                    }
+                }
+                break;
+            }
+        }
+    }
+    return target.fragments;
+}
+
+// ---------------------------------------------------------------------------
+
+bool WritePpm(const std::string& path, const std::vector<uint32_t>& pixels, int width, int height) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    std::fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<unsigned char> row((size_t)width * 3);
+    bool ok = true;
+    for (int y = 0; y < height && ok; y++) {
+        for (int x = 0; x < width; x++) {
+            uint32_t p = pixels[(size_t)y * width + x];
+            row[x * 3] = (unsigned char)(p & 0xFF);
+            row[x * 3 + 1] = (unsigned char)((p >> 8) & 0xFF);
+            row[x * 3 + 2] = (unsigned char)((p >> 16) & 0xFF);
+        }
+        ok = std::fwrite(row.data(), 1, row.size(), file) == row.size();
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+bool ReadPpm(const std::string& path, std::vector<uint32_t>& pixels, int& width, int& height) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    int maxValue = 0;
+    // Only what WritePpm produces: no comments in the header
+    bool ok = std::fscanf(file, "P6 %d %d %d", &width, &height, &maxValue) == 3 && maxValue == 255 &&
+              width > 0 && height > 0 && std::fgetc(file) != EOF;
+    if (ok) {
+        std::vector<unsigned char> rgb((size_t)width * height * 3);
+        ok = std::fread(rgb.data(), 1, rgb.size(), file) == rgb.size();
+        pixels.resize((size_t)width * height);
+        for (size_t i = 0; ok && i < pixels.size(); i++) {
+            pixels[i] = PackRgba(Rgba{rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2], 255});
+        }
+    }
+    std::fclose(file);
+    return ok;
+}
+
+ImageDiff CompareImages(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, int tolerance) {
+    ImageDiff diff;
+    size_t count = a.size() < b.size() ? a.size() : b.size();
+    for (size_t i = 0; i < count; i++) {
+        int worst = 0;
+        for (int shift = 0; shift < 24; shift += 8) {
+            int d = (int)((a[i] >> shift) & 0xFF) - (int)((b[i] >> shift) & 0xFF);
+            if (d < 0) d = -d;
+            if (d > worst) worst = d;
+        }
+        if (worst > tolerance) diff.differing++;
+        if (worst > diff.maxDelta) diff.maxDelta = worst;
+    }
+    // Pixels only one image has count as different
+    diff.differing += (int)((a.size() > b.size() ? a.size() : b.size()) - count);
+    return diff;
+}
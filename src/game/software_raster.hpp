@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "render_commands.hpp"
+#include "starfield.hpp"
+
+class JobSystem;
+
+// Fill cost of the last Submit
+struct RasterStats {
+    int primitives = 0;        // drawn shapes after culling, clears excluded
+    long binEntries = 0;       // primitive-tile pairs
+    uint64_t fragments = 0;    // pixels shaded, every layer counted
+    int coveredPixels = 0;     // shaded at least once (overdraw tracking only)
+    int maxOverdraw = 0;       // deepest pixel (overdraw tracking only)
+    double binMs = 0;
+    double rasterMs = 0;
+};
+
+// CPU rasterizer for the command list's primitive set (circles, triangles,
+// rectangles, lines, star points and text) into an in-memory RGBA8 image,
+// for golden-frame diffs and fill-cost statistics without a GPU.
+//
+// Submit transforms every primitive to screen space and bins it into
+// 64x64 tiles, then the tiles are rasterized in parallel on a JobSystem.
+// Each tile draws its primitives in list order and tiles never share a
+// pixel, so the image is identical for any thread count.
+//
+// Coverage is sampled at pixel centres without antialiasing, and blending
+// is source-over like raylib's default. Circles are exact rather than
+// raylib's 36-segment fans, and text uses a built-in 5x7 font: compare
+// software frames with software frames, not with screenshots. Record with
+// MeasureText below so the layout matches that font.
+class SoftwareRenderBackend : public RenderBackend {
+public:
+    static const int TILE_SIZE = 64;
+    
+    SoftwareRenderBackend(int width, int height);
+    
+    // Clears the image; stars baked earlier are kept
+    void Resize(int width, int height);
+    // Tiles go through `jobs` when set, otherwise run on the caller
+    void SetJobSystem(JobSystem* jobs) { this->jobs = jobs; }
+    // Counts shading per pixel for coveredPixels/maxOverdraw and OverdrawAt
+    void SetOverdrawTracking(bool enabled);
+    
+    void Submit(const RenderCommandList& list) override;
+    
+    int Width() const { return width; }
+    int Height() const { return height; }
+    // Row-major, one PackRgba value per pixel
+    const std::vector<uint32_t>& Pixels() const { return pixels; }
+    int OverdrawAt(int x, int y) const;
+    const RasterStats& Stats() const { return stats; }
+    
+    // Width of `text` in the built-in font, as raylib's MeasureText
+    static int MeasureText(const char* text, int fontSize);
+    
+private:
+    enum PrimType : uint8_t { PRIM_CLEAR, PRIM_RECT, PRIM_CIRCLE, PRIM_TRIANGLE, PRIM_LINE, PRIM_TEXT };
+    
+    struct Prim {
+        PrimType type;
+        Rgba color;
+        int x0, y0, x1, y1;    // pixel bounds, clipped to the image
+        float v[6];
+        const char* text;      // PRIM_TEXT; lives in the submitted list
+    };
+    
+    struct StarLayer {
+        std::vector<MeshVertex> stars;
+        int width = 0;
+        int height = 0;
+        float size = 1;
+    };
+    
+    struct Transform {
+        bool active = false;
+        float x = 0, y = 0, scale = 1;
+        
+        float X(float px) const { return active ? x + px * scale : px; }
+        float Y(float py) const { return active ? y + py * scale : py; }
+        float S(float length) const { return active ? length * scale : length; }
+    };
+    
+    void AddPrim(Prim& prim);
+    void AddRect(float x, float y, float w, float h, Rgba color);
+    void AddCircle(float x, float y, float radius, Rgba color);
+    void AddTriangle(const MeshVertex& a, const MeshVertex& b, const MeshVertex& c);
+    void AddLine(float x0, float y0, float x1, float y1, Rgba color);
+    void AddText(const char* text, float x, float y, float pixelScale, Rgba color);
+    void AddStars(const float* offsets, int layerCount);
+    uint64_t RasterTile(int tile);
+    
+    int width;
+    int height;
+    int tilesX = 0;
+    int tilesY = 0;
+    std::vector<uint32_t> pixels;
+    std::vector<uint16_t> overdraw;   // empty unless tracking
+    bool trackOverdraw = false;
+    JobSystem* jobs = nullptr;
+    
+    std::vector<Prim> prims;
+    std::vector<std::vector<uint32_t>> bins;   // prim indices per tile, in order
+    std::vector<uint64_t> tileFragments;
+    StarLayer starLayers[Starfield::LAYER_COUNT];
+    RasterStats stats;
+};
+
+// Pixels are r | g << 8 | b << 16 | a << 24
+inline uint32_t PackRgba(Rgba c) {
+    return (uint32_t)c.r | (uint32_t)c.g << 8 | (uint32_t)c.b << 16 | (uint32_t)c.a << 24;
+}
+
+// Binary PPM (RGB, alpha dropped), readable by most image viewers
+bool WritePpm(const std::string& path, const std::vector<uint32_t>& pixels, int width, int height);
+bool ReadPpm(const std::string& path, std::vector<uint32_t>& pixels, int& width, int& height);
+
+struct ImageDiff {
+    int differing = 0;   // pixels with any channel off by more than the tolerance
+    int maxDelta = 0;    // largest channel difference anywhere
+};
+
+// Alpha is ignored, as PPM does not carry it
+ImageDiff CompareImages(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, int tolerance);
@@ -0,0 +1,582 @@
+#include "space_shooter.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "alloc_counter.hpp"
+#include "profiler.hpp"
+#include "state_stream.hpp"
+#include "swept_collision.hpp"
+#include "systems.hpp"
+
+// Items per parallel chunk; smaller counts run inline on the calling thread
+static const int BULLET_GRAIN = 2048;
+static const int ENEMY_GRAIN = 1024;
+
+SpaceShooter::SpaceShooter(const Services& services)
+    : services(services), tickRate(DEFAULT_TICK_RATE), tickTime(1.0f / DEFAULT_TICK_RATE),
+      accumulator(0), interpolation(0), tickCount(0), jobs(nullptr), recorder(nullptr), stateStream(nullptr), invulnerable(false),
+      bullets("bullets", BULLET_COMPONENTS, MAX_BULLETS, BULLET_POOL_LIMIT),
+      enemies("enemies", ENEMY_COMPONENTS, MAX_ENEMIES, ENEMY_POOL_LIMIT), tables(BuiltinEnemyTables()),
+      tablesHash(EnemyTablesHash(tables)), maxEnemyRadius(0), maxEnemyStep(0) {
+    RebuildFrameContext(this->services.viewport.GetViewport());
+    uint64_t seed = this->services.random.Seed();
+    spawnRng.Seed(seed, RNG_SPAWN);
+    explosionRng.Seed(seed, RNG_EXPLOSIONS);
+    trailRng.Seed(seed, RNG_TRAILS);
+    state = MENU;
+    player.Reset(frame);
+    enemySpawnTimer = 0;
+    difficultyTimer = 0;
+    wave = 1;
+}
+
+void SpaceShooter::Reset() {
+    player.Reset(frame);
+    bullets.Clear();
+    enemies.Clear();
+    particles.Clear();
+    projectiles.Clear();
+    enemySpawnTimer = 0;
+    difficultyTimer = 0;
+    wave = 1;
+    state = PLAYING;
+}
+
+void SpaceShooter::SetEnemyTables(const EnemyTables& enemyTables) {
+    tables = enemyTables;
+    tablesHash = EnemyTablesHash(tables);
+    enemies.Clear();
+    projectiles.Clear();
+}
+
+void SpaceShooter::SetTickRate(int hz) {
+    tickRate = hz > 0 ? hz : DEFAULT_TICK_RATE;
+    tickTime = 1.0f / tickRate;
+    accumulator = 0;
+    RebuildFrameContext(frame.viewport);
+}
+
+void SpaceShooter::RebuildFrameContext(const Viewport& viewport) {
+    // 60 / rate rather than tickTime * 60 so 60 Hz gives exactly 1.0
+    float tickScale = (float)DEFAULT_TICK_RATE / tickRate;
+    frame = FrameContext(viewport, tickScale);
+    particles.SetTickScale(tickScale);
+}
+
+void SpaceShooter::Update() {
+    PROFILE_SCOPE("Update");
+    float frameTime = services.clock.GetFrameTime();
+    if (frameTime > MAX_FRAME_TIME) frameTime = MAX_FRAME_TIME;
+    if (frameTime < 0) frameTime = 0;
+    
+    Viewport viewport = services.viewport.GetViewport();
+    if (viewport != frame.viewport) {
+        RebuildFrameContext(viewport);
+    }
+    
+    // Held keys take the latest sample; presses stick until a tick runs
+    InputState polled = services.input.Poll();
+    bool confirm = pendingInput.confirmPressed || polled.confirmPressed;
+    bool pause = pendingInput.pausePressed || polled.pausePressed;
+    bool back = pendingInput.backPressed || polled.backPressed;
+    pendingInput = polled;
+    pendingInput.confirmPressed = confirm;
+    pendingInput.pausePressed = pause;
+    pendingInput.backPressed = back;
+    
+    accumulator += frameTime;
+    while (accumulator >= tickTime) {
+        input = pendingInput;
+        pendingInput.confirmPressed = false;
+        pendingInput.pausePressed = false;
+        pendingInput.backPressed = false;
+        Tick();
+        accumulator -= tickTime;
+    }
+    interpolation = accumulator / tickTime;
+}
+
+void SpaceShooter::SavePreviousState() {
+    player.prevPosition = player.position;
+    SavePreviousSystem(bullets);
+    SavePreviousSystem(enemies);
+}
+
+void SpaceShooter::ReplayTick(const InputLogTick& tick) {
+    if (tick.viewportChanged && tick.viewport != frame.viewport) {
+        RebuildFrameContext(tick.viewport);
+    }
+    if (tick.detailChanged) particles.SetDetail(tick.detail);
+    input = tick.input;
+    Tick();
+}
+
+void SpaceShooter::Tick() {
+    PROFILE_SCOPE("Tick");
+    arena.Reset();
+    tickCount++;
+    if (recorder) recorder->Record(input, frame.viewport, particles.GetDetail());
+    SavePreviousState();
+    
+    switch (state) {
+        case MENU:
+            if (input.confirmPressed) {
+                Reset();
+            }
+            break;
+        
+        case PLAYING:
+            UpdateGame();
+            break;
+        
+        case PAUSED:
+            if (input.pausePressed || input.backPressed) {
+                state = PLAYING;
+            }
+            break;
+        
+        case GAME_OVER:
+            if (input.confirmPressed) {
+                state = MENU;
+            }
+            break;
+    }
+    
+    if (stateStream) stateStream->Record(*this);
+}
+
+void SpaceShooter::UpdateGame() {
+    ALLOC_FREE_SCOPE("UpdateGame");
+    
+    // Check pause
+    if (input.pausePressed) {
+        state = PAUSED;
+        return;
+    }
+    
+    // Update player
+    {
+        PROFILE_SCOPE("Player");
+        player.Update(input, frame, tickTime);
+        
+        // Player shooting
+        if (input.fire && player.CanShoot()) {
+            SpawnBullet(player.position, Vec2(0, -frame.bulletSpeed));
+            player.Shoot();
+        }
+    }
+    
+    // Update bullets
+    {
+        PROFILE_SCOPE("Bullets");
+        DespawnBounds bounds{-10, -10, frame.width + 10, frame.height + 10};
+        ParallelFor(bullets.Size(), BULLET_GRAIN, [this, &bounds](int begin, int end) {
+            MoveSystem(bullets, begin, end);
+            DespawnSystem(bullets, bounds, begin, end);
+        });
+    }
+    
+    // Spawn enemies
+    {
+        PROFILE_SCOPE("EnemySpawn");
+        enemySpawnTimer += tickTime;
+        if (enemySpawnTimer >= tables.SpawnIntervalAt(difficultyTimer)) {
+            enemySpawnTimer = 0;
+            SpawnEnemy();
+        }
+    }
+    
+    // Update difficulty
+    difficultyTimer += tickTime;
+    wave = tables.WaveAt(difficultyTimer);
+    
+    // Update enemies, then emit trails serially so RNG order is fixed
+    {
+        PROFILE_SCOPE("Enemies");
+        DespawnBounds bounds{-FLT_MAX, -FLT_MAX, FLT_MAX, frame.despawnY};
+        ParallelFor(enemies.Size(), ENEMY_GRAIN, [this, &bounds](int begin, int end) {
+            MoveSystem(enemies, begin, end);
+            SpinSystem(enemies, frame.tickScale, begin, end);
+            DespawnSystem(enemies, bounds, begin, end);
+        });
+    }
+    {
+        PROFILE_SCOPE("Trails");
+        const float* ex = enemies.Column(COL_X);
+        const float* ey = enemies.Column(COL_Y);
+        const uint8_t* kinds = enemies.Kinds();
+        for (int i = 0; i < enemies.Size(); i++) {
+            if (!enemies.IsAlive(i)) continue;
+            // Add engine trail
+            const EnemyType& type = tables.types[kinds[i]];
+            if (type.trailOneIn > 0 && trailRng.OneIn(type.trailOneIn)) {
+                particles.AddTrail(Vec2(ex[i], ey[i] + frame.enemyTrailY), type.trailColor, trailRng);
+            }
+        }
+        
+        // Add player engine trail
+        if (trailRng.OneIn(3)) {
+            float engineY = player.position.y + frame.engineOffsetY;
+            particles.AddTrail(Vec2(player.position.x - frame.engineOffsetX, engineY), Palette::Orange, trailRng);
+            particles.AddTrail(Vec2(player.position.x + frame.engineOffsetX, engineY), Palette::Orange, trailRng);
+        }
+    }
+    
+    // Enemy fire: volleys leave serially in row order, then every shot
+    // moves, the new ones included
+    {
+        PROFILE_SCOPE("EnemyFire");
+        FireEnemyWeapons();
+    }
+    {
+        PROFILE_SCOPE("Projectiles");
+        projectiles.Update(frame, jobs);
+    }
+    
+    // Collision detection
+    CheckCollisions();
+    CheckProjectileHits();
+    
+    // Update particles
+    {
+        PROFILE_SCOPE("Particles");
+        particles.Update(tickTime, jobs);
+    }
+    
+    // Drop everything killed this tick from the pools
+    RemoveInactive();
+    
+    // Check game over
+    if (player.health <= 0) {
+        state = GAME_OVER;
+    }
+}
+
+PoolHandle SpaceShooter::SpawnBullet(Vec2 pos, Vec2 vel) {
+    int row = SpawnBulletRow(bullets, pos, vel);
+    return row < 0 ? PoolHandle() : bullets.HandleAt(row);
+}
+
+PoolHandle SpaceShooter::SpawnEnemy(int kind, Vec2 pos, Vec2 vel, int health) {
+    if (kind < 0 || kind >= tables.typeCount) return PoolHandle();
+    int row = SpawnEnemyRow(enemies, tables, kind, pos, vel, health);
+    return row < 0 ? PoolHandle() : enemies.HandleAt(row);
+}
+
+void SpaceShooter::RemoveInactive() {
+    PROFILE_SCOPE("RemoveInactive");
+    bullets.RemoveDead();
+    enemies.RemoveDead();
+    projectiles.RemoveDead();
+}
+
+void SpaceShooter::SpawnEnemy() {
+    float margin = frame.spawnMargin;
+    float x = (float)spawnRng.Range((int)margin, (int)(frame.width - margin));
+    int kind = tables.PickType(wave, spawnRng.Range(0, 100));
+    float speedMultiplier = tables.SpeedMultiplierAt(difficultyTimer);
+    
+    SpawnEnemy(
+        kind,
+        Vec2(x, frame.spawnY),
+        Vec2(0, frame.enemySpeed * speedMultiplier * tables.types[kind].speed)
+    );
+}
+
+void SpaceShooter::FireEnemyWeapons() {
+    const float* ex = enemies.Column(COL_X);
+    const float* ey = enemies.Column(COL_Y);
+    float* timer = enemies.Column(COL_FIRE_TIMER);
+    float* turn = enemies.Column(COL_FIRE_ANGLE);
+    const uint8_t* kinds = enemies.Kinds();
+    for (int i = 0; i < enemies.Size(); i++) {
+        const EnemyWeapon& weapon = tables.types[kinds[i]].weapon;
+        if (weapon.pattern == FIRE_NONE || !enemies.IsAlive(i)) continue;
+        if (timer[i] > 0) timer[i] -= tickTime;
+        // Held until the ship is on screen. The overshoot carries into the
+        // next interval, so volleys average one per interval at any tick rate.
+        if (timer[i] > 0 || ey[i] < 0 || ey[i] > frame.height) continue;
+        projectiles.Fire(weapon, Vec2(ex[i], ey[i]), player.position, turn[i], frame);
+        timer[i] += weapon.interval;
+        turn[i] = std::fmod(turn[i] + weapon.turn, 360.0f);
+    }
+}
+
+// Queues every live enemy the bullet could touch this tick. Both moved
+// before collisions run, so the test sweeps the bullet from its previous to
+// its current position against each enemy doing the same; a fast bullet
+// cannot step over an enemy between ticks. Enemies are bucketed at their
+// current position, so the query box covers the bullet's whole segment
+// widened by the colliders and by how far any enemy moved.
+void SpaceShooter::GatherBulletPairs(int bullet, int slot, SweptPairBatch& batch, int* hits, float* toi) const {
+    const float scale = frame.scale;
+    const float* ex = enemies.Column(COL_X);
+    const float* ey = enemies.Column(COL_Y);
+    const float* epx = enemies.Column(COL_PREV_X);
+    const float* epy = enemies.Column(COL_PREV_Y);
+    const float* er = enemies.Column(COL_RADIUS);
+    Vec2 start = bullets.PrevPosition(bullet);
+    Vec2 end = bullets.Position(bullet);
+    Vec2 motion(end.x - start.x, end.y - start.y);
+    float bulletRadius = bullets.Column(COL_RADIUS)[bullet] * scale;
+    float reach = maxEnemyRadius + bulletRadius + maxEnemyStep;
+    Vec2 min(std::min(start.x, end.x) - reach, std::min(start.y, end.y) - reach);
+    Vec2 max(std::max(start.x, end.x) + reach, std::max(start.y, end.y) + reach);
+    enemyGrid.QueryBox(min, max, [&](int i) {
+        if (!enemies.IsAlive(i)) return;
+        if (batch.Full()) batch.Resolve(hits, toi);
+        batch.Add(slot, i,
+                  Vec2(epx[i] - start.x, epy[i] - start.y),
+                  Vec2((ex[i] - epx[i]) - motion.x, (ey[i] - epy[i]) - motion.y),
+                  er[i] * scale + bulletRadius);
+    });
+}
+
+// hits[b] is the enemy bullet b touches first this tick or -1, toi[b] when
+void SpaceShooter::FindBulletHits(int begin, int end, int* hits, float* toi) const {
+    SweptPairBatch batch;
+    for (int b = begin; b < end; b++) {
+        hits[b] = -1;
+        toi[b] = SWEPT_MISS;
+        if (bullets.IsAlive(b)) GatherBulletPairs(b, b, batch, hits, toi);
+    }
+    batch.Resolve(hits, toi);
+}
+
+int SpaceShooter::FindBulletHit(int bullet) const {
+    SweptPairBatch batch;
+    int hit = -1;
+    float toi = SWEPT_MISS;
+    GatherBulletPairs(bullet, 0, batch, &hit, &toi);
+    batch.Resolve(&hit, &toi);
+    return hit;
+}
+
+void SpaceShooter::CheckCollisions() {
+    PROFILE_SCOPE("CheckCollisions");
+    const float scale = frame.scale;
+    const float playerRadius = frame.playerRadius;
+    const float* ex = enemies.Column(COL_X);
+    const float* ey = enemies.Column(COL_Y);
+    const float* er = enemies.Column(COL_RADIUS);
+    int* health = enemies.Health();
+    const Rgba* colors = enemies.Colors();
+    
+    const float* epx = enemies.Column(COL_PREV_X);
+    const float* epy = enemies.Column(COL_PREV_Y);
+    
+    // Broadphase: bucket live enemies by position once per tick, with cells
+    // sized for the largest collider
+    maxEnemyRadius = 0;
+    maxEnemyStep = 0;
+    for (int i = 0; i < enemies.Size(); i++) {
+        if (!enemies.IsAlive(i)) continue;
+        maxEnemyRadius = std::max(maxEnemyRadius, er[i] * scale);
+        maxEnemyStep = std::max(maxEnemyStep, std::max(std::fabs(ex[i] - epx[i]), std::fabs(ey[i] - epy[i])));
+    }
+    enemyGrid.Begin(frame.width, frame.height, 2 * std::max(maxEnemyRadius, frame.enemyRadius), enemies.Capacity());
+    for (int i = 0; i < enemies.Size(); i++) {
+        if (enemies.IsAlive(i)) enemyGrid.Insert(i, Vec2(ex[i], ey[i]));
+    }
+    enemyGrid.Finish();
+    
+    // Bullet-Enemy collisions. Candidate hits are found in parallel against
+    // the enemies alive at the start of the pass, then applied serially in
+    // bullet order. Enemies only die during the apply step, so a candidate
+    // that is still alive is still the right answer; a dead one means an
+    // earlier bullet got there first and this bullet searches again.
+    int* bulletHits = arena.AllocateArray<int>(bullets.Size());
+    float* bulletToi = arena.AllocateArray<float>(bullets.Size());
+    ParallelFor(bullets.Size(), BULLET_GRAIN, [this, bulletHits, bulletToi](int begin, int end) {
+        FindBulletHits(begin, end, bulletHits, bulletToi);
+    });
+    for (int b = 0; b < bullets.Size(); b++) {
+        int hit = bulletHits[b];
+        if (hit < 0) continue;
+        if (!enemies.IsAlive(hit)) hit = FindBulletHit(b);
+        if (hit < 0) continue;
+        
+        bullets.Kill(b);
+        health[hit]--;
+        
+        if (health[hit] <= 0) {
+            particles.AddExplosion(Vec2(ex[hit], ey[hit]), colors[hit], explosionRng);
+            player.score += tables.types[enemies.Kinds()[hit]].score;
+            enemies.Kill(hit);
+        }
+    }
+    
+    // Player-Enemy collisions, resolved in index order to keep RNG use stable
+    if (player.invincible || invulnerable) return;
+    // At most every enemy touches the player
+    int* contacts = arena.AllocateArray<int>(enemies.Size());
+    int contactCount = 0;
+    enemyGrid.Query(player.position, playerRadius + maxEnemyRadius, [&](int i) {
+        if (enemies.IsAlive(i) &&
+            CirclesOverlap(player.position, playerRadius, Vec2(ex[i], ey[i]), er[i] * scale)) {
+            contacts[contactCount++] = i;
+        }
+    });
+    std::sort(contacts, contacts + contactCount);
+    for (int c = 0; c < contactCount; c++) {
+        int i = contacts[c];
+        Vec2 position(ex[i], ey[i]);
+        // TakeDamage makes the player invincible after the first contact
+        if (!enemies.IsAlive(i) || !player.CheckCollision(position, er[i] * scale, frame)) continue;
+        particles.AddExplosion(position, Palette::Red, explosionRng);
+        particles.AddExplosion(player.position, Palette::Blue, explosionRng);
+        player.TakeDamage();
+        enemies.Kill(i);
+    }
+}
+
+// Searched every tick, even while the player cannot be hurt, so the cost
+// stays level when invincibility ends. One hit per tick is enough:
+// TakeDamage makes the player invincible.
+void SpaceShooter::CheckProjectileHits() {
+    PROFILE_SCOPE("ProjectileHits");
+    int hit = projectiles.FindHit(player.prevPosition, player.position, frame.playerRadius, frame.scale);
+    if (hit < 0 || player.invincible || invulnerable) return;
+    projectiles.Kill(hit);
+    particles.AddExplosion(player.position, Palette::Blue, explosionRng);
+    player.TakeDamage();
+}
+
+void SpaceShooter::SaveSnapshot(SnapshotWriter& out) const {
+    out.Begin();
+    out.PutU16((uint16_t)tickRate);
+    out.PutU16((uint16_t)frame.viewport.width);
+    out.PutU16((uint16_t)frame.viewport.height);
+    out.PutF32(accumulator);
+    out.PutF32(interpolation);
+    out.PutU64(tickCount);
+    out.PutU8((uint8_t)state);
+    
+    out.PutF32(player.position.x);
+    out.PutF32(player.position.y);
+    out.PutF32(player.prevPosition.x);
+    out.PutF32(player.prevPosition.y);
+    out.PutI32(player.health);
+    out.PutI32(player.score);
+    out.PutF32(player.shootCooldown);
+    out.PutU8(player.invincible);
+    out.PutF32(player.invincibleTimer);
+    
+    out.PutF32(enemySpawnTimer);
+    out.PutF32(difficultyTimer);
+    out.PutI32(wave);
+    out.PutU64(tablesHash);
+    
+    spawnRng.Save(out);
+    explosionRng.Save(out);
+    trailRng.Save(out);
+    
+    bullets.Save(out);
+    enemies.Save(out);
+    particles.Save(out);
+    projectiles.Save(out);
+    out.Finish();
+}
+
+bool SpaceShooter::LoadSnapshot(const unsigned char* data, size_t size, const char** error) {
+    SnapshotReader in;
+    if (!in.Open(data, size)) {
+        if (error) *error = in.Error();
+        return false;
+    }
+    
+    int savedRate = in.GetU16();
+    int width = in.GetU16();
+    int height = in.GetU16();
+    float savedAccumulator = in.GetF32();
+    float savedInterpolation = in.GetF32();
+    uint64_t savedTicks = in.GetU64();
+    uint8_t savedState = in.GetU8();
+    if (in.Ok() && (savedRate == 0 || savedState > GAME_OVER)) in.Fail("bad game state");
+    
+    Player saved;
+    saved.position.x = in.GetF32();
+    saved.position.y = in.GetF32();
+    saved.prevPosition.x = in.GetF32();
+    saved.prevPosition.y = in.GetF32();
+    saved.health = in.GetI32();
+    saved.score = in.GetI32();
+    saved.shootCooldown = in.GetF32();
+    saved.invincible = in.GetU8() != 0;
+    saved.invincibleTimer = in.GetF32();
+    float savedSpawnTimer = in.GetF32();
+    float savedDifficulty = in.GetF32();
+    int savedWave = in.GetI32();
+    if (in.GetU64() != tablesHash) in.Fail("enemy tables differ");
+    
+    Rng savedSpawnRng, savedExplosionRng, savedTrailRng;
+    savedSpawnRng.Load(in);
+    savedExplosionRng.Load(in);
+    savedTrailRng.Load(in);
+    
+    // Entities load in place, so from here on a failure resets the game
+    bool ok = in.Ok() && bullets.Load(in) && enemies.Load(in) && particles.Load(in) && projectiles.Load(in);
+    const uint8_t* kinds = enemies.Kinds();
+    for (int i = 0; ok && in.Ok() && i < enemies.Size(); i++) {
+        if (kinds[i] >= tables.typeCount) in.Fail("bad enemy type");
+    }
+    if (ok && !in.AtEnd()) in.Fail("trailing data in snapshot");
+    if (!in.Ok()) {
+        if (error) *error = in.Error();
+        Reset();
+        state = MENU;
+        return false;
+    }
+    
+    SetTickRate(savedRate);
+    RebuildFrameContext(Viewport(width, height));
+    accumulator = savedAccumulator;
+    interpolation = savedInterpolation;
+    tickCount = savedTicks;
+    state = (GameState)savedState;
+    player = saved;
+    enemySpawnTimer = savedSpawnTimer;
+    difficultyTimer = savedDifficulty;
+    wave = savedWave;
+    spawnRng = savedSpawnRng;
+    explosionRng = savedExplosionRng;
+    trailRng = savedTrailRng;
+    input = InputState();
+    pendingInput = InputState();
+    return true;
+}
+
+uint64_t SpaceShooter::StateHash() const {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](const void* data, size_t size) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+    };
+    mix(&player.position, sizeof(player.position));
+    mix(&player.health, sizeof(player.health));
+    mix(&player.score, sizeof(player.score));
+    for (int i = 0; i < enemies.Size(); i++) {
+        if (!enemies.IsAlive(i)) continue;
+        Vec2 position = enemies.Position(i);
+        mix(&position, sizeof(position));
+        mix(&enemies.Health()[i], sizeof(int));
+    }
+    for (int i = 0; i < bullets.Size(); i++) {
+        if (!bullets.IsAlive(i)) continue;
+        Vec2 position = bullets.Position(i);
+        mix(&position, sizeof(position));
+    }
+    int projectileCount = projectiles.Count();
+    mix(&projectileCount, sizeof(projectileCount));
+    mix(projectiles.PositionX(), sizeof(float) * projectileCount);
+    mix(projectiles.PositionY(), sizeof(float) * projectileCount);
+    int particleCount = particles.Count();
+    mix(&particleCount, sizeof(particleCount));
+    mix(particles.PositionX(), sizeof(float) * particleCount);
+    mix(particles.PositionY(), sizeof(float) * particleCount);
+    mix(particles.Lifetime(), sizeof(float) * particleCount);
+    return h;
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "entities.hpp"
+#include "frame_arena.hpp"
+#include "input_log.hpp"
+#include "job_system.hpp"
+#include "particles.hpp"
+#include "pool.hpp"
+#include "projectiles.hpp"
+#include "rng.hpp"
+#include "snapshot.hpp"
+#include "services.hpp"
+#include "spatial_grid.hpp"
+
+class StateStreamWriter;
+struct SweptPairBatch;
+
+const int DEFAULT_TICK_RATE = 60;
+// Longest frame the accumulator accepts, so a stall does not trigger a
+// burst of catch-up ticks
+const float MAX_FRAME_TIME = 0.25f;
+
+// Main game class: pure simulation, recorded by SceneRecorder for drawing
+class SpaceShooter {
+private:
+    Services services;
+    FrameContext frame;
+    InputState input;         // what the current tick sees
+    InputState pendingInput;  // presses latched until a tick consumes them
+    int tickRate;
+    float tickTime;
+    float accumulator;
+    float interpolation;
+    uint64_t tickCount;
+    JobSystem* jobs;
+    InputLogWriter* recorder;
+    StateStreamWriter* stateStream;
+    bool invulnerable;
+    
+    GameState state;
+    Player player;
+    Archetype bullets;
+    Archetype enemies;
+    ParticleManager particles;
+    ProjectileManager projectiles;   // enemy fire
+    SpatialGrid enemyGrid;
+    EnemyTables tables;
+    uint64_t tablesHash;    // EnemyTablesHash(tables), checked by snapshots
+    FrameArena arena;   // per-tick scratch, reset at the start of Tick()
+    // Independent streams, so cosmetic detail never changes gameplay draws
+    Rng spawnRng;
+    Rng explosionRng;
+    Rng trailRng;
+    float maxEnemyRadius;   // largest live enemy collider this tick, scaled
+    float maxEnemyStep;     // farthest any live enemy moved this tick, per axis
+    float enemySpawnTimer;
+    float difficultyTimer;
+    int wave;
+    
+public:
+    explicit SpaceShooter(const Services& services);
+    
+    void Reset();
+    // Pauses a game in progress, e.g. after resuming from a snapshot
+    void Pause() { if (state == PLAYING) state = PAUSED; }
+    // Called once per rendered frame: samples clock, input and viewport, then
+    // runs as many fixed ticks as the elapsed time covers (possibly none).
+    // The FrameContext is only rebuilt when the viewport size changes.
+    void Update();
+    // Advances exactly one fixed tick with the last polled input
+    void Tick();
+    // Advances one tick with recorded input, applying a logged viewport or
+    // effect detail change first. Bypasses the clock and input services entirely.
+    void ReplayTick(const InputLogTick& tick);
+    
+    // Simulation rate in Hz, independent of the render rate
+    void SetTickRate(int hz);
+    int GetTickRate() const { return tickRate; }
+    float GetTickTime() const { return tickTime; }
+    uint64_t GetTickCount() const { return tickCount; }
+    // How far the render frame is between the previous and current tick, [0, 1)
+    float GetInterpolation() const { return interpolation; }
+    // Optional; when set, particle integration, entity movement and the
+    // collision queries run in parallel chunks. Results are identical to a
+    // run without one.
+    void SetJobSystem(JobSystem* jobSystem) { jobs = jobSystem; }
+    // Optional; when set, every tick's input and viewport are appended to it
+    void SetInputRecorder(InputLogWriter* writer) { recorder = writer; }
+    // Optional; when set, the state after every tick is appended to it
+    void SetStateStream(StateStreamWriter* writer) { stateStream = writer; }
+    // Enemy archetypes and wave schedule, BuiltinEnemyTables() by default.
+    // Removes live enemies, whose kinds index the previous set; set it
+    // before the game starts.
+    void SetEnemyTables(const EnemyTables& enemyTables);
+    // Player ignores enemy contact; for soak tests and long benchmark runs
+    void SetInvulnerable(bool enabled) { invulnerable = enabled; }
+    // Hard cap on live particles; clears the current ones
+    void SetParticleBudget(int capacity) { particles.SetCapacity(capacity); }
+    // Cosmetic particle detail, e.g. from a QualityGovernor. Changes the
+    // simulation (and its hash) below 100%; recorded in input logs.
+    void SetEffectDetail(const EffectDetail& detail) { particles.SetDetail(detail); }
+    const EffectDetail& GetEffectDetail() const { return particles.GetDetail(); }
+    // Hard cap on live enemy projectiles; clears the current ones. Shots past
+    // it are dropped, which changes the simulation, and input logs do not
+    // record it: for benchmarks.
+    void SetProjectileBudget(int capacity) { projectiles.SetCapacity(capacity); }
+    
+    GameState GetState() const { return state; }
+    const FrameContext& GetFrameContext() const { return frame; }
+    const Player& GetPlayer() const { return player; }
+    const Archetype& GetBullets() const { return bullets; }
+    const Archetype& GetEnemies() const { return enemies; }
+    const ParticleManager& GetParticles() const { return particles; }
+    const ProjectileManager& GetProjectiles() const { return projectiles; }
+    const FrameArena& GetFrameArena() const { return arena; }
+    int GetWave() const { return wave; }
+    const EnemyTables& GetEnemyTables() const { return tables; }
+    
+    // O(1); returns an invalid handle only if the pool is at its limit
+    PoolHandle SpawnBullet(Vec2 pos, Vec2 vel);
+    // `kind` indexes GetEnemyTables().types; health <= 0 takes the type's
+    PoolHandle SpawnEnemy(int kind, Vec2 pos, Vec2 vel, int health = 0);
+    void SpawnExplosion(Vec2 pos, Rgba color) { particles.AddExplosion(pos, color, explosionRng); }
+    
+    // Writes everything needed to continue exactly where this game is: tick
+    // rate, viewport, timers, player, bullets, enemies, particles, enemy
+    // projectiles and the RNG streams. Reuses the writer's
+    // buffer, so repeated saves do not allocate.
+    void SaveSnapshot(SnapshotWriter& out) const;
+    // Restores a SaveSnapshot; the next Update() adapts to the current
+    // viewport as after a resize. Returns false (with `error` set) on a
+    // corrupt or foreign snapshot; a failure past the header leaves a fresh
+    // game at the menu.
+    bool LoadSnapshot(const unsigned char* data, size_t size, const char** error = nullptr);
+    
+    // FNV-1a over player, live entities, particles and projectiles; equal
+    // hashes after the same inputs mean the runs matched
+    uint64_t StateHash() const;
+    
+private:
+    void RebuildFrameContext(const Viewport& viewport);
+    void SavePreviousState();
+    void UpdateGame();
+    void SpawnEnemy();
+    void RemoveInactive();
+    void FireEnemyWeapons();
+    void CheckCollisions();
+    void CheckProjectileHits();
+    void FindBulletHits(int begin, int end, int* hits, float* toi) const;
+    int FindBulletHit(int bullet) const;
+    void GatherBulletPairs(int bullet, int slot, SweptPairBatch& batch, int* hits, float* toi) const;
+    
+    template <typename Fn>
+    void ParallelFor(int count, int grain, Fn&& fn) {
+        if (jobs) jobs->ParallelFor(count, grain, fn);
+        else fn(0, count);
+    }
+};
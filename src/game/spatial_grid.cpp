@@ -0,0 +1,40 @@
+#include "spatial_grid.hpp"
+
+void SpatialGrid::Begin(float width, float height, float cellSize, int maxItems) {
+    if (cellSize < 1.0f) cellSize = 1.0f;
+    invCellSize = 1.0f / cellSize;
+    cols = (int)(width * invCellSize) + 1;
+    rows = (int)(height * invCellSize) + 1;
+    if (cols < 1) cols = 1;
+    if (rows < 1) rows = 1;
+    items.clear();
+    if (maxItems > 0) {
+        items.reserve(maxItems);
+        sorted.reserve(maxItems);
+    }
+}
+
+void SpatialGrid::Insert(int index, Vec2 position) {
+    items.push_back(Item{CellY(position.y) * cols + CellX(position.x), index});
+}
+
+void SpatialGrid::Finish() {
+    int cellCount = cols * rows;
+    cellStart.assign(cellCount + 1, 0);
+    for (const Item& item : items) {
+        cellStart[item.cell + 1]++;
+    }
+    for (int c = 0; c < cellCount; c++) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    
+    // Scatter using a running cursor per cell, then restore the starts
+    sorted.resize(items.size());
+    for (const Item& item : items) {
+        sorted[cellStart[item.cell]++] = item.index;
+    }
+    for (int c = cellCount; c > 0; c--) {
+        cellStart[c] = cellStart[c - 1];
+    }
+    cellStart[0] = 0;
+}
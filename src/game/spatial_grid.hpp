@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include "types.hpp"
+
+// Uniform-grid broadphase, rebuilt from scratch every tick. Items are
+// bucketed by the cell containing their center with a counting sort, so a
+// rebuild is O(n) and, once the vectors have grown, allocation-free.
+// Positions outside the grid are clamped to the border cells.
+class SpatialGrid {
+public:
+    // Starts a rebuild covering [0, width) x [0, height). `maxItems` reserves
+    // room up front (e.g. the owning pool's capacity) so a new peak count
+    // does not reallocate mid-tick.
+    void Begin(float width, float height, float cellSize, int maxItems = 0);
+    void Insert(int index, Vec2 position);
+    void Finish();
+    
+    // Calls fn(index) for every item whose cell overlaps the square of
+    // half-size `reach` around position. Each item is reported once, in
+    // ascending cell order (not index order).
+    template <typename Fn>
+    void Query(Vec2 position, float reach, Fn&& fn) const {
+        QueryBox(Vec2(position.x - reach, position.y - reach), Vec2(position.x + reach, position.y + reach), fn);
+    }
+    
+    // Same for the box [min, max], e.g. around a swept segment
+    template <typename Fn>
+    void QueryBox(Vec2 min, Vec2 max, Fn&& fn) const {
+        int x0 = CellX(min.x), x1 = CellX(max.x);
+        int y0 = CellY(min.y), y1 = CellY(max.y);
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                int cell = cy * cols + cx;
+                for (int i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+                    fn(sorted[i]);
+                }
+            }
+        }
+    }
+    
+    int Columns() const { return cols; }
+    int Rows() const { return rows; }
+    int Count() const { return (int)items.size(); }
+    
+private:
+    struct Item {
+        int cell;
+        int index;
+    };
+    
+    int CellX(float x) const {
+        int c = (int)(x * invCellSize);
+        return c < 0 ? 0 : (c >= cols ? cols - 1 : c);
+    }
+    int CellY(float y) const {
+        int c = (int)(y * invCellSize);
+        return c < 0 ? 0 : (c >= rows ? rows - 1 : c);
+    }
+    
+    int cols = 1;
+    int rows = 1;
+    float invCellSize = 1.0f;
+    std::vector<Item> items;
+    std::vector<int> cellStart;  // cols * rows + 1 prefix sums
+    std::vector<int> sorted;     // item indices grouped by cell
+};
@@ -0,0 +1,87 @@
+#include "starfield.hpp"
+#include <cmath>
+
+// Far layers are dense, dim and slow; the near layer is sparse, bright and
+// fast. Together they match the old single layer's ~100 stars at 800 px.
+static const Starfield::LayerSpec DEFAULT_LAYERS[Starfield::LAYER_COUNT] = {
+    {75.0f, 12.0f, 60, 140, 1.0f},
+    {40.0f, 30.0f, 110, 200, 1.0f},
+    {12.0f, 60.0f, 190, 255, 2.0f},
+};
+
+// xorshift32; each layer restarts from a fixed seed, so a resolution always
+// produces the same sky and a lower density keeps a prefix of its stars
+static uint32_t NextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+Starfield::Starfield()
+    : viewport(0, 0), scale(1.0f), density(1.0f), generation(0) {
+    for (int i = 0; i < LAYER_COUNT; i++) {
+        specs[i] = DEFAULT_LAYERS[i];
+        offsets[i] = 0;
+    }
+}
+
+bool Starfield::Resize(const Viewport& vp) {
+    if (vp == viewport) return false;
+    viewport = vp;
+    scale = vp.GetScaleFactor();
+    for (int i = 0; i < LAYER_COUNT; i++) offsets[i] = 0;
+    Generate();
+    return true;
+}
+
+void Starfield::SetDensity(float value) {
+    if (value < 0) value = 0;
+    if (value == density) return;
+    density = value;
+    // Scroll offsets carry over, so the sky thins out instead of jumping
+    if (viewport.width > 0 && viewport.height > 0) Generate();
+}
+
+void Starfield::Generate() {
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        const LayerSpec& spec = specs[layer];
+        int count = (int)(spec.density * density * viewport.width / 1000.0f);
+        uint32_t state = 0x9E3779B9u + (uint32_t)layer * 0x85EBCA6Bu;
+        stars[layer].resize(count);
+        int range = spec.maxBrightness - spec.minBrightness + 1;
+        for (Star& star : stars[layer]) {
+            star.x = (float)(NextRandom(state) % (uint32_t)(viewport.width > 0 ? viewport.width : 1));
+            star.y = (float)(NextRandom(state) % (uint32_t)(viewport.height > 0 ? viewport.height : 1));
+            star.brightness = (unsigned char)(spec.minBrightness + NextRandom(state) % (uint32_t)range);
+        }
+    }
+    generation++;
+}
+
+void Starfield::Advance(float dt) {
+    float height = (float)viewport.height;
+    if (height <= 0) return;
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        float offset = offsets[layer] + specs[layer].speed * scale * dt;
+        if (offset >= height) offset = fmodf(offset, height);
+        offsets[layer] = offset;
+    }
+}
+
+float Starfield::StarSize(int layer) const {
+    float size = specs[layer].size * scale;
+    return size < 1.0f ? 1.0f : size;
+}
+
+int Starfield::StarCount() const {
+    int total = 0;
+    for (int layer = 0; layer < LAYER_COUNT; layer++) total += (int)stars[layer].size();
+    return total;
+}
+
+float Starfield::ScreenY(int layer, int index) const {
+    float y = stars[layer][index].y + offsets[layer];
+    float height = (float)viewport.height;
+    return y >= height ? y - height : y;
+}
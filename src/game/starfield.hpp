@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "viewport.hpp"
+
+// Parallax starfield. Star positions are generated once per resolution (and
+// density) in layer-local coordinates; per frame only each layer's scroll
+// offset changes. A renderer can bake every layer into a screen-sized tile
+// once and draw it twice per layer, wrapped by the offset.
+class Starfield {
+public:
+    struct Star {
+        float x;
+        float y;
+        unsigned char brightness;
+    };
+    
+    struct LayerSpec {
+        float density;              // stars per 1000 px of screen width
+        float speed;                // pixels per second at scale 1
+        unsigned char minBrightness;
+        unsigned char maxBrightness;
+        float size;                 // pixel size at scale 1
+    };
+    
+    static const int LAYER_COUNT = 3;
+    
+    Starfield();
+    
+    // Regenerates when the size changed; returns true if it did
+    bool Resize(const Viewport& viewport);
+    // Multiplier on every layer's star count; regenerates if it changed,
+    // keeping the scroll offsets
+    void SetDensity(float density);
+    float GetDensity() const { return density; }
+    
+    void Advance(float dt);
+    
+    int LayerCount() const { return LAYER_COUNT; }
+    const LayerSpec& Spec(int layer) const { return specs[layer]; }
+    const std::vector<Star>& Stars(int layer) const { return stars[layer]; }
+    // Scroll offset in [0, height)
+    float Offset(int layer) const { return offsets[layer]; }
+    // Star size in pixels at the current scale, at least 1
+    float StarSize(int layer) const;
+    int Width() const { return viewport.width; }
+    int Height() const { return viewport.height; }
+    int StarCount() const;
+    // Bumped on every regeneration so renderers know to rebake
+    uint32_t Generation() const { return generation; }
+    
+    // Where star `index` of `layer` is on screen right now
+    float ScreenY(int layer, int index) const;
+    
+private:
+    void Generate();
+    
+    LayerSpec specs[LAYER_COUNT];
+    std::vector<Star> stars[LAYER_COUNT];
+    float offsets[LAYER_COUNT];
+    Viewport viewport;
+    float scale;
+    float density;
+    uint32_t generation;
+};
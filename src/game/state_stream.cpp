@@ -0,0 +1,816 @@
+#include "state_stream.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "space_shooter.hpp"
+
+static const char STREAM_MAGIC[4] = {'S', 'D', 'G', 'S'};
+static const char STREAM_END_MAGIC[4] = {'S', 'D', 'G', 'E'};
+static const uint16_t STREAM_VERSION = 2;
+static const uint16_t STREAM_HEADER_SIZE = 32;
+
+enum StreamTag : uint8_t {
+    TAG_PLAYER = 1 << 0,   // 0x00..0x07: one tick with these sections
+    TAG_BULLETS = 1 << 1,
+    TAG_ENEMIES = 1 << 2,
+    TAG_IDLE = 0x10,
+    TAG_KEYFRAME = 0x20,
+    TAG_END = 0x30,
+};
+
+enum PlayerField : uint8_t {
+    PLAYER_POSITION = 1 << 0,
+    PLAYER_HEALTH = 1 << 1,
+    PLAYER_SCORE = 1 << 2,
+    PLAYER_WAVE = 1 << 3,
+    PLAYER_STATE = 1 << 4,
+    PLAYER_INVINCIBLE = 1 << 5,
+};
+
+enum EntityChange : uint8_t {
+    ENTITY_SPAWN = 1 << 0,
+    ENTITY_REMOVE = 1 << 1,
+    ENTITY_POSITION = 1 << 2,
+    ENTITY_VELOCITY = 1 << 3,
+    ENTITY_HEALTH = 1 << 4,
+};
+
+// Model precision: 1/4096 px, so velocity rounding drifts by less than
+// 1/8 px over several hundred ticks
+static const int MODEL_SHIFT = 12;
+static const uint32_t MAX_SLOTS = 1u << 24;
+// Bytes collected before a write to the sink, unless low latency
+static const size_t EMIT_BATCH = 4096;
+
+static int32_t ToModel(float v) {
+    double scaled = std::floor((double)v * (1 << MODEL_SHIFT) + 0.5);
+    if (scaled > (double)(1 << 30)) scaled = (double)(1 << 30);
+    if (scaled < -(double)(1 << 30)) scaled = -(double)(1 << 30);
+    return (int32_t)scaled;
+}
+
+// Model units to 1/8 px, rounding half up; floor division so negative
+// coordinates round the same way
+static int32_t ModelToEighths(int32_t m) {
+    const int32_t unit = 1 << (MODEL_SHIFT - 3);
+    int32_t v = m + unit / 2;
+    return v >= 0 ? v / unit : -((-v + unit - 1) / unit);
+}
+
+static int32_t ToEighths(float v) {
+    return (int32_t)std::floor((double)v * 8.0 + 0.5);
+}
+
+static void PutVarint(std::vector<unsigned char>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back((unsigned char)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((unsigned char)v);
+}
+
+static void PutZigzag(std::vector<unsigned char>& out, int64_t v) {
+    PutVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+// False if the varint runs past `end` (more bytes needed)
+static bool GetVarint(const unsigned char*& p, const unsigned char* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end) return false;
+        unsigned char byte = *p++;
+        v |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static bool GetZigzag(const unsigned char*& p, const unsigned char* end, int64_t& v) {
+    uint64_t u;
+    if (!GetVarint(p, end, u)) return false;
+    v = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+    return true;
+}
+
+static bool GetZigzag32(const unsigned char*& p, const unsigned char* end, int32_t& v) {
+    int64_t wide;
+    if (!GetZigzag(p, end, wide)) return false;
+    v = (int32_t)wide;
+    return true;
+}
+
+static void PutLE(unsigned char* p, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static uint64_t GetLE(const unsigned char* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+// ---------------------------------------------------------------------------
+
+bool GhostFrame::operator==(const GhostFrame& o) const {
+    return tick == o.tick && state == o.state && playerX8 == o.playerX8 && playerY8 == o.playerY8 &&
+           health == o.health && score == o.score && wave == o.wave && invincible == o.invincible &&
+           bullets == o.bullets && enemies == o.enemies;
+}
+
+uint64_t GhostFrame::Hash() const {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](int64_t v) {
+        for (int i = 0; i < 8; i++) {
+            h ^= (uint64_t)(v >> (8 * i)) & 0xFF;
+            h *= 1099511628211ull;
+        }
+    };
+    mix((int64_t)tick);
+    mix(state);
+    mix(playerX8);
+    mix(playerY8);
+    mix(health);
+    mix(score);
+    mix(wave);
+    mix(invincible);
+    for (const auto* list : {&bullets, &enemies}) {
+        mix((int64_t)list->size());
+        for (const GhostEntity& e : *list) {
+            mix(e.id);
+            mix(e.x8);
+            mix(e.y8);
+            mix(e.health);
+        }
+    }
+    return h;
+}
+
+static void CaptureEntities(const Archetype& archetype, std::vector<GhostEntity>& out) {
+    out.clear();
+    const float* x = archetype.Column(COL_X);
+    const float* y = archetype.Column(COL_Y);
+    const int* health = archetype.Health();
+    for (int row = 0; row < archetype.Size(); row++) {
+        GhostEntity e;
+        e.id = archetype.HandleAt(row).slot;
+        e.x8 = ModelToEighths(ToModel(x[row]));
+        e.y8 = ModelToEighths(ToModel(y[row]));
+        e.health = health ? health[row] : 0;
+        out.push_back(e);
+    }
+    std::sort(out.begin(), out.end(), [](const GhostEntity& a, const GhostEntity& b) { return a.id < b.id; });
+}
+
+void GhostFrame::Capture(const SpaceShooter& game, GhostFrame& out) {
+    const Player& p = game.GetPlayer();
+    out.tick = game.GetTickCount();
+    out.state = game.GetState();
+    out.playerX8 = ToEighths(p.position.x);
+    out.playerY8 = ToEighths(p.position.y);
+    out.health = p.health;
+    out.score = p.score;
+    out.wave = game.GetWave();
+    out.invincible = p.invincible;
+    CaptureEntities(game.GetBullets(), out.bullets);
+    CaptureEntities(game.GetEnemies(), out.enemies);
+}
+
+// ---------------------------------------------------------------------------
+
+bool FileStreamSink::Open(const std::string& path) {
+    Close();
+    file = std::fopen(path.c_str(), "wb");
+    failed = false;
+    return file != nullptr;
+}
+
+bool FileStreamSink::Close() {
+    if (!file) return false;
+    bool ok = std::fclose(file) == 0 && !failed;
+    file = nullptr;
+    return ok;
+}
+
+bool FileStreamSink::Write(const unsigned char* bytes, size_t size) {
+    if (!file) return false;
+    if (std::fwrite(bytes, 1, size, file) != size) failed = true;
+    return !failed;
+}
+
+bool LoopbackSink::Write(const unsigned char* bytes, size_t size) {
+    size_t packet = packetSize > 0 ? packetSize : size;
+    for (size_t i = 0; i < size; i += packet) {
+        reader.Feed(bytes + i, std::min(packet, size - i));
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+
+bool StateStreamWriter::Open(StreamSink& target, const StateStreamHeader& info) {
+    sink = &target;
+    header = info;
+    if (header.keyframeInterval == 0) header.keyframeInterval = 1;
+    started = false;
+    idleTicks = 0;
+    written = 0;
+    keyTicks.clear();
+    keyOffsets.clear();
+    
+    out.assign(STREAM_HEADER_SIZE, 0);
+    std::memcpy(out.data(), STREAM_MAGIC, 4);
+    PutLE(out.data() + 4, STREAM_VERSION, 2);
+    PutLE(out.data() + 6, STREAM_HEADER_SIZE, 2);
+    PutLE(out.data() + 8, (uint16_t)header.tickRate, 2);
+    PutLE(out.data() + 10, (uint16_t)header.viewport.width, 2);
+    PutLE(out.data() + 12, (uint16_t)header.viewport.height, 2);
+    PutLE(out.data() + 14, (uint16_t)header.frameRate, 2);
+    PutLE(out.data() + 16, header.keyframeInterval, 4);
+    PutLE(out.data() + 24, header.seed, 8);
+    Emit();
+    return true;
+}
+
+void StateStreamWriter::Emit() {
+    if (out.empty()) return;
+    sink->Write(out.data(), out.size());
+    written += out.size();
+    out.clear();
+}
+
+void StateStreamWriter::FlushIdle() {
+    if (idleTicks == 0) return;
+    out.push_back(TAG_IDLE);
+    PutVarint(out, idleTicks);
+    idleTicks = 0;
+}
+
+void StateStreamWriter::Stage(const Archetype& archetype, Kind& kind, uint64_t tick) {
+    size_t slots = (size_t)archetype.Capacity();
+    if (kind.models.size() < slots) {
+        kind.models.resize(slots, Model{0, 0, 0, 0, 0, 0, false});
+        kind.staged.resize(slots, Staged{UINT64_MAX, 0, 0, 0, 0, 0, 0});
+    }
+    const float* x = archetype.Column(COL_X);
+    const float* y = archetype.Column(COL_Y);
+    const float* vx = archetype.Column(COL_VX);
+    const float* vy = archetype.Column(COL_VY);
+    const int* health = archetype.Health();
+    for (int row = 0; row < archetype.Size(); row++) {
+        PoolHandle handle = archetype.HandleAt(row);
+        Staged& s = kind.staged[handle.slot];
+        s.tick = tick;
+        s.generation = handle.generation;
+        s.x = ToModel(x[row]);
+        s.y = ToModel(y[row]);
+        s.vx = ToModel(vx[row]);
+        s.vy = ToModel(vy[row]);
+        s.health = health ? health[row] : 0;
+    }
+}
+
+void StateStreamWriter::WriteKeyframe(const SpaceShooter& game, uint64_t tick) {
+    FlushIdle();
+    keyTicks.push_back(tick);
+    keyOffsets.push_back(written + out.size());
+    
+    const Player& p = game.GetPlayer();
+    player.state = game.GetState();
+    player.playerX8 = prevPlayerX8 = ToEighths(p.position.x);
+    player.playerY8 = prevPlayerY8 = ToEighths(p.position.y);
+    player.health = p.health;
+    player.score = p.score;
+    player.wave = game.GetWave();
+    player.invincible = p.invincible;
+    
+    out.push_back(TAG_KEYFRAME);
+    PutVarint(out, tick);
+    out.push_back((uint8_t)player.state);
+    PutZigzag(out, player.playerX8);
+    PutZigzag(out, player.playerY8);
+    PutZigzag(out, player.health);
+    PutZigzag(out, player.score);
+    PutZigzag(out, player.wave);
+    out.push_back(player.invincible ? 1 : 0);
+    
+    Kind* kinds[2] = {&bullets, &enemies};
+    const Archetype* archetypes[2] = {&game.GetBullets(), &game.GetEnemies()};
+    for (int k = 0; k < 2; k++) {
+        Kind& kind = *kinds[k];
+        Stage(*archetypes[k], kind, tick);
+        bool withHealth = archetypes[k]->Health() != nullptr;
+        uint64_t count = 0;
+        section.clear();
+        int64_t prevSlot = -1;
+        for (size_t slot = 0; slot < kind.models.size(); slot++) {
+            Model& m = kind.models[slot];
+            const Staged& s = kind.staged[slot];
+            m.live = s.tick == tick;
+            if (!m.live) continue;
+            m = Model{s.generation, s.x, s.y, s.vx, s.vy, s.health, true};
+            PutVarint(section, (uint64_t)((int64_t)slot - prevSlot - 1));
+            PutZigzag(section, m.x);
+            PutZigzag(section, m.y);
+            PutZigzag(section, m.vx);
+            PutZigzag(section, m.vy);
+            if (withHealth) PutZigzag(section, m.health);
+            prevSlot = (int64_t)slot;
+            count++;
+        }
+        PutVarint(out, count);
+        out.insert(out.end(), section.begin(), section.end());
+    }
+}
+
+// Changes of one kind since the model's prediction, in slot order
+bool StateStreamWriter::WriteEntityDelta(Kind& kind, bool withHealth) {
+    uint64_t count = 0;
+    section.clear();
+    int64_t prevSlot = -1;
+    for (size_t slot = 0; slot < kind.models.size(); slot++) {
+        Model& m = kind.models[slot];
+        const Staged& s = kind.staged[slot];
+        bool present = s.tick == lastTick;
+        if (!present && !m.live) continue;
+        
+        uint8_t mask = 0;
+        if (present && (!m.live || m.generation != s.generation)) {
+            mask = ENTITY_SPAWN;
+        } else if (!present) {
+            mask = ENTITY_REMOVE;
+        } else {
+            if (ModelToEighths(m.x) != ModelToEighths(s.x) || ModelToEighths(m.y) != ModelToEighths(s.y)) {
+                mask |= ENTITY_POSITION;
+            }
+            if (m.vx != s.vx || m.vy != s.vy) mask |= ENTITY_VELOCITY;
+            if (withHealth && m.health != s.health) mask |= ENTITY_HEALTH;
+            if (mask == 0) continue;
+        }
+        
+        PutVarint(section, (uint64_t)((int64_t)slot - prevSlot - 1));
+        section.push_back(mask);
+        prevSlot = (int64_t)slot;
+        count++;
+        if (mask & ENTITY_SPAWN) {
+            m = Model{s.generation, s.x, s.y, s.vx, s.vy, s.health, true};
+            PutZigzag(section, m.x);
+            PutZigzag(section, m.y);
+            PutZigzag(section, m.vx);
+            PutZigzag(section, m.vy);
+            if (withHealth) PutZigzag(section, m.health);
+            continue;
+        }
+        if (mask & ENTITY_REMOVE) {
+            m.live = false;
+            continue;
+        }
+        if (mask & ENTITY_POSITION) {
+            PutZigzag(section, (int64_t)s.x - m.x);
+            PutZigzag(section, (int64_t)s.y - m.y);
+            m.x = s.x;
+            m.y = s.y;
+        }
+        if (mask & ENTITY_VELOCITY) {
+            PutZigzag(section, s.vx);
+            PutZigzag(section, s.vy);
+            m.vx = s.vx;
+            m.vy = s.vy;
+        }
+        if (mask & ENTITY_HEALTH) {
+            PutZigzag(section, s.health);
+            m.health = s.health;
+        }
+    }
+    if (count == 0) return false;
+    std::vector<unsigned char>& target = withHealth ? enemyBytes : bulletBytes;
+    target.clear();
+    PutVarint(target, count);
+    target.insert(target.end(), section.begin(), section.end());
+    return true;
+}
+
+void StateStreamWriter::Record(const SpaceShooter& game) {
+    if (!sink) return;
+    uint64_t tick = game.GetTickCount();
+    bool keyframe = !started || tick != lastTick + 1 || tick - keyTicks.back() >= header.keyframeInterval;
+    started = true;
+    lastTick = tick;
+    if (keyframe) {
+        WriteKeyframe(game, tick);
+        if (lowLatency || out.size() >= EMIT_BATCH) Emit();
+        return;
+    }
+    
+    // Dead reckoning, exactly as the reader does it
+    for (Kind* kind : {&bullets, &enemies}) {
+        for (Model& m : kind->models) {
+            if (!m.live) continue;
+            m.x += m.vx;
+            m.y += m.vy;
+        }
+    }
+    Stage(game.GetBullets(), bullets, tick);
+    Stage(game.GetEnemies(), enemies, tick);
+    
+    // Player, predicted from its last two positions
+    const Player& p = game.GetPlayer();
+    int32_t x8 = ToEighths(p.position.x);
+    int32_t y8 = ToEighths(p.position.y);
+    int32_t predX = 2 * player.playerX8 - prevPlayerX8;
+    int32_t predY = 2 * player.playerY8 - prevPlayerY8;
+    uint8_t mask = 0;
+    if (x8 != predX || y8 != predY) mask |= PLAYER_POSITION;
+    if (p.health != player.health) mask |= PLAYER_HEALTH;
+    if (p.score != player.score) mask |= PLAYER_SCORE;
+    if (game.GetWave() != player.wave) mask |= PLAYER_WAVE;
+    if (game.GetState() != player.state) mask |= PLAYER_STATE;
+    if (p.invincible != player.invincible) mask |= PLAYER_INVINCIBLE;
+    playerBytes.clear();
+    if (mask) {
+        playerBytes.push_back(mask);
+        if (mask & PLAYER_POSITION) {
+            PutZigzag(playerBytes, (int64_t)x8 - predX);
+            PutZigzag(playerBytes, (int64_t)y8 - predY);
+        }
+        if (mask & PLAYER_HEALTH) PutZigzag(playerBytes, p.health);
+        if (mask & PLAYER_SCORE) PutZigzag(playerBytes, p.score);
+        if (mask & PLAYER_WAVE) PutZigzag(playerBytes, game.GetWave());
+        if (mask & PLAYER_STATE) playerBytes.push_back((uint8_t)game.GetState());
+        if (mask & PLAYER_INVINCIBLE) playerBytes.push_back(p.invincible ? 1 : 0);
+    }
+    prevPlayerX8 = player.playerX8;
+    prevPlayerY8 = player.playerY8;
+    player.playerX8 = x8;
+    player.playerY8 = y8;
+    player.health = p.health;
+    player.score = p.score;
+    player.wave = game.GetWave();
+    player.state = game.GetState();
+    player.invincible = p.invincible;
+    
+    uint8_t tag = 0;
+    if (mask) tag |= TAG_PLAYER;
+    if (WriteEntityDelta(bullets, false)) tag |= TAG_BULLETS;
+    if (WriteEntityDelta(enemies, true)) tag |= TAG_ENEMIES;
+    
+    if (tag == 0 && !lowLatency) {
+        idleTicks++;
+        return;
+    }
+    FlushIdle();
+    out.push_back(tag);
+    if (tag & TAG_PLAYER) out.insert(out.end(), playerBytes.begin(), playerBytes.end());
+    if (tag & TAG_BULLETS) out.insert(out.end(), bulletBytes.begin(), bulletBytes.end());
+    if (tag & TAG_ENEMIES) out.insert(out.end(), enemyBytes.begin(), enemyBytes.end());
+    if (lowLatency || out.size() >= EMIT_BATCH) Emit();
+}
+
+bool StateStreamWriter::Close() {
+    if (!sink) return false;
+    FlushIdle();
+    uint64_t endOffset = written + out.size();
+    out.push_back(TAG_END);
+    PutVarint(out, keyTicks.size());
+    uint64_t prevTick = 0, prevOffset = 0;
+    for (size_t i = 0; i < keyTicks.size(); i++) {
+        PutVarint(out, keyTicks[i] - prevTick);
+        PutVarint(out, keyOffsets[i] - prevOffset);
+        prevTick = keyTicks[i];
+        prevOffset = keyOffsets[i];
+    }
+    unsigned char trailer[8];
+    PutLE(trailer, endOffset, 4);
+    std::memcpy(trailer + 4, STREAM_END_MAGIC, 4);
+    out.insert(out.end(), trailer, trailer + 8);
+    Emit();
+    sink = nullptr;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+
+bool StateStreamReader::Open(const std::string& path) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        error = "cannot open file";
+        return false;
+    }
+    unsigned char chunk[16 * 1024];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) Feed(chunk, n);
+    std::fclose(f);
+    if (!ParseHeader()) {
+        if (!error) error = "not a state stream";
+        return false;
+    }
+    ReadIndex();
+    return true;
+}
+
+void StateStreamReader::Feed(const unsigned char* bytes, size_t size) {
+    data.insert(data.end(), bytes, bytes + size);
+}
+
+bool StateStreamReader::ParseHeader() {
+    if (headerParsed) return true;
+    if (data.size() < STREAM_HEADER_SIZE) return false;
+    const unsigned char* p = data.data();
+    if (std::memcmp(p, STREAM_MAGIC, 4) != 0) {
+        error = "not a state stream";
+        return false;
+    }
+    int version = (int)GetLE(p + 4, 2);
+    if (version < 1 || version > STREAM_VERSION) {
+        error = "unsupported state stream version";
+        return false;
+    }
+    size_t headerSize = (size_t)GetLE(p + 6, 2);
+    if (headerSize < STREAM_HEADER_SIZE) {
+        error = "bad header size";
+        return false;
+    }
+    if (data.size() < headerSize) return false;
+    header.tickRate = (int)GetLE(p + 8, 2);
+    header.viewport = Viewport((int)GetLE(p + 10, 2), (int)GetLE(p + 12, 2));
+    header.frameRate = version >= 2 ? (int)GetLE(p + 14, 2) : 0;
+    header.keyframeInterval = (uint32_t)GetLE(p + 16, 4);
+    header.seed = GetLE(p + 24, 8);
+    cursor = headerSize;
+    headerParsed = true;
+    return true;
+}
+
+// The trailer is optional: a stream cut short, or still being fed, is
+// indexed as its keyframes are decoded
+bool StateStreamReader::ReadIndex() {
+    if (data.size() < STREAM_HEADER_SIZE + 8) return false;
+    const unsigned char* trailer = data.data() + data.size() - 8;
+    if (std::memcmp(trailer + 4, STREAM_END_MAGIC, 4) != 0) return false;
+    size_t offset = (size_t)GetLE(trailer, 4);
+    if (offset >= data.size() - 8 || data[offset] != TAG_END) return false;
+    const unsigned char* p = data.data() + offset + 1;
+    const unsigned char* end = trailer;
+    uint64_t count;
+    if (!GetVarint(p, end, count)) return false;
+    std::vector<uint64_t> ticks;
+    std::vector<size_t> offsets;
+    uint64_t t = 0, o = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t dt, dof;
+        if (!GetVarint(p, end, dt) || !GetVarint(p, end, dof)) return false;
+        t += dt;
+        o += dof;
+        if (o >= offset) return false;
+        ticks.push_back(t);
+        offsets.push_back((size_t)o);
+    }
+    keyTicks.swap(ticks);
+    keyOffsets.swap(offsets);
+    return true;
+}
+
+bool StateStreamReader::ReadPlayer(const unsigned char*& p, const unsigned char* end, bool apply) {
+    if (p == end) return false;
+    uint8_t mask = *p++;
+    int32_t dx = 0, dy = 0, health = 0, score = 0, wave = 0;
+    uint8_t state = 0, invincible = 0;
+    if (mask & PLAYER_POSITION) {
+        if (!GetZigzag32(p, end, dx) || !GetZigzag32(p, end, dy)) return false;
+    }
+    if ((mask & PLAYER_HEALTH) && !GetZigzag32(p, end, health)) return false;
+    if ((mask & PLAYER_SCORE) && !GetZigzag32(p, end, score)) return false;
+    if ((mask & PLAYER_WAVE) && !GetZigzag32(p, end, wave)) return false;
+    if (mask & PLAYER_STATE) {
+        if (p == end) return false;
+        state = *p++;
+    }
+    if (mask & PLAYER_INVINCIBLE) {
+        if (p == end) return false;
+        invincible = *p++;
+    }
+    if (!apply) return true;
+    // Position: the prediction was already applied by Step()
+    player.playerX8 += dx;
+    player.playerY8 += dy;
+    if (mask & PLAYER_HEALTH) player.health = health;
+    if (mask & PLAYER_SCORE) player.score = score;
+    if (mask & PLAYER_WAVE) player.wave = wave;
+    if (mask & PLAYER_STATE) player.state = (GameState)state;
+    if (mask & PLAYER_INVINCIBLE) player.invincible = invincible != 0;
+    return true;
+}
+
+bool StateStreamReader::ReadEntities(const unsigned char*& p, const unsigned char* end, std::vector<Model>& models,
+                                     bool withHealth, bool keyframe, bool apply) {
+    uint64_t count;
+    if (!GetVarint(p, end, count)) return false;
+    if (apply && keyframe) {
+        for (Model& m : models) m.live = false;
+    }
+    int64_t slot = -1;
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t gap;
+        if (!GetVarint(p, end, gap)) return false;
+        slot += (int64_t)gap + 1;
+        if (slot >= (int64_t)MAX_SLOTS) {
+            error = "entity slot out of range";
+            return false;
+        }
+        uint8_t mask = ENTITY_SPAWN;
+        if (!keyframe) {
+            if (p == end) return false;
+            mask = *p++;
+        }
+        int32_t a = 0, b = 0, c = 0, d = 0, health = 0;
+        if (mask & ENTITY_SPAWN) {
+            if (!GetZigzag32(p, end, a) || !GetZigzag32(p, end, b) || !GetZigzag32(p, end, c) ||
+                !GetZigzag32(p, end, d)) return false;
+            if (withHealth && !GetZigzag32(p, end, health)) return false;
+        } else if (!(mask & ENTITY_REMOVE)) {
+            if ((mask & ENTITY_POSITION) && (!GetZigzag32(p, end, a) || !GetZigzag32(p, end, b))) return false;
+            if ((mask & ENTITY_VELOCITY) && (!GetZigzag32(p, end, c) || !GetZigzag32(p, end, d))) return false;
+            if ((mask & ENTITY_HEALTH) && !GetZigzag32(p, end, health)) return false;
+        }
+        if (!apply) continue;
+        
+        if ((size_t)slot >= models.size()) models.resize((size_t)slot + 1, Model{0, 0, 0, 0, 0, false});
+        Model& m = models[(size_t)slot];
+        if (mask & ENTITY_SPAWN) {
+            m = Model{a, b, c, d, health, true};
+        } else if (mask & ENTITY_REMOVE) {
+            m.live = false;
+        } else {
+            if (mask & ENTITY_POSITION) {
+                m.x += a;
+                m.y += b;
+            }
+            if (mask & ENTITY_VELOCITY) {
+                m.vx = c;
+                m.vy = d;
+            }
+            if (mask & ENTITY_HEALTH) m.health = health;
+        }
+    }
+    return true;
+}
+
+void StateStreamReader::Step() {
+    tick++;
+    for (std::vector<Model>* models : {&bullets, &enemies}) {
+        for (Model& m : *models) {
+            if (!m.live) continue;
+            m.x += m.vx;
+            m.y += m.vy;
+        }
+    }
+    int32_t x8 = player.playerX8, y8 = player.playerY8;
+    player.playerX8 = 2 * x8 - prevPlayerX8;
+    player.playerY8 = 2 * y8 - prevPlayerY8;
+    prevPlayerX8 = x8;
+    prevPlayerY8 = y8;
+}
+
+bool StateStreamReader::DecodeRecord() {
+    const unsigned char* begin = data.data() + cursor;
+    const unsigned char* end = data.data() + data.size();
+    if (begin == end) return false;
+    uint8_t tag = *begin;
+    
+    if (tag == TAG_END) {
+        ended = true;
+        return false;
+    }
+    if (tag == TAG_IDLE) {
+        const unsigned char* p = begin + 1;
+        uint64_t n;
+        if (!GetVarint(p, end, n)) return false;
+        if (!started) {
+            error = "stream does not start with a keyframe";
+            return false;
+        }
+        cursor += (size_t)(p - begin);
+        idleLeft = (uint32_t)n;
+        return true;
+    }
+    if (tag == TAG_KEYFRAME) {
+        // Dry run first, so a partial record leaves everything untouched
+        const unsigned char* p = begin + 1;
+        uint64_t keyTick;
+        int32_t values[5];
+        if (!GetVarint(p, end, keyTick) || p == end) return false;
+        uint8_t state = *p++;
+        for (int32_t& v : values) {
+            if (!GetZigzag32(p, end, v)) return false;
+        }
+        if (p == end) return false;
+        uint8_t invincible = *p++;
+        const unsigned char* entities = p;
+        if (!ReadEntities(p, end, bullets, false, true, false) || !ReadEntities(p, end, enemies, true, true, false)) {
+            return false;
+        }
+        size_t offset = cursor;
+        p = entities;
+        ReadEntities(p, end, bullets, false, true, true);
+        ReadEntities(p, end, enemies, true, true, true);
+        cursor += (size_t)(p - begin);
+        
+        tick = keyTick;
+        player.state = (GameState)state;
+        player.playerX8 = prevPlayerX8 = values[0];
+        player.playerY8 = prevPlayerY8 = values[1];
+        player.health = values[2];
+        player.score = values[3];
+        player.wave = values[4];
+        player.invincible = invincible != 0;
+        started = true;
+        ready = true;
+        if (std::find(keyTicks.begin(), keyTicks.end(), keyTick) == keyTicks.end()) {
+            keyTicks.push_back(keyTick);
+            keyOffsets.push_back(offset);
+        }
+        return true;
+    }
+    if (tag > (TAG_PLAYER | TAG_BULLETS | TAG_ENEMIES)) {
+        error = "bad record tag";
+        return false;
+    }
+    if (!started) {
+        error = "stream does not start with a keyframe";
+        return false;
+    }
+    
+    const unsigned char* p = begin + 1;
+    if ((tag & TAG_PLAYER) && !ReadPlayer(p, end, false)) return false;
+    if ((tag & TAG_BULLETS) && !ReadEntities(p, end, bullets, false, false, false)) return false;
+    if ((tag & TAG_ENEMIES) && !ReadEntities(p, end, enemies, true, false, false)) return false;
+    Step();
+    p = begin + 1;
+    if (tag & TAG_PLAYER) ReadPlayer(p, end, true);
+    if (tag & TAG_BULLETS) ReadEntities(p, end, bullets, false, false, true);
+    if (tag & TAG_ENEMIES) ReadEntities(p, end, enemies, true, false, true);
+    cursor += (size_t)(p - begin);
+    ready = true;
+    return true;
+}
+
+void StateStreamReader::Output(GhostFrame& frame) const {
+    frame.tick = tick;
+    frame.state = player.state;
+    frame.playerX8 = player.playerX8;
+    frame.playerY8 = player.playerY8;
+    frame.health = player.health;
+    frame.score = player.score;
+    frame.wave = player.wave;
+    frame.invincible = player.invincible;
+    auto list = [](const std::vector<Model>& models, std::vector<GhostEntity>& out) {
+        out.clear();
+        for (size_t slot = 0; slot < models.size(); slot++) {
+            const Model& m = models[slot];
+            if (m.live) out.push_back(GhostEntity{(uint32_t)slot, ModelToEighths(m.x), ModelToEighths(m.y), m.health});
+        }
+    };
+    list(bullets, frame.bullets);
+    list(enemies, frame.enemies);
+}
+
+bool StateStreamReader::Next(GhostFrame& frame) {
+    if (error || !ParseHeader()) return false;
+    while (!ready) {
+        if (idleLeft > 0) {
+            idleLeft--;
+            Step();
+            ready = true;
+            break;
+        }
+        if (ended || !DecodeRecord()) return false;
+    }
+    ready = false;
+    Output(frame);
+    return true;
+}
+
+bool StateStreamReader::Seek(uint64_t target, GhostFrame& frame) {
+    if (error || !ParseHeader()) return false;
+    int best = -1;
+    for (size_t i = 0; i < keyTicks.size(); i++) {
+        if (keyTicks[i] <= target && (best < 0 || keyTicks[i] > keyTicks[(size_t)best])) best = (int)i;
+    }
+    // Restart from the keyframe unless continuing forward is shorter
+    bool ahead = started && !ready && tick <= target && (best < 0 || keyTicks[(size_t)best] <= tick);
+    if (best >= 0 && !ahead) {
+        cursor = keyOffsets[(size_t)best];
+        started = false;
+        ended = false;
+        ready = false;
+        idleLeft = 0;
+    }
+    if (started && !ready && tick == target) {
+        Output(frame);
+        return true;
+    }
+    while (Next(frame)) {
+        if (frame.tick == target) return true;
+        if (frame.tick > target) return false;
+    }
+    return false;
+}
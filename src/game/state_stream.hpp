@@ -0,0 +1,249 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "entities.hpp"
+#include "viewport.hpp"
+
+class SpaceShooter;
+
+// Compact per-tick stream of what a game looked like, for ghost runs,
+// spectating and high-score verification. Unlike a snapshot it carries
+// only what a viewer needs, quantized: the player, every bullet and enemy
+// position to 1/8 px, health, score, wave and game state. Particles and
+// spin are cosmetic and left to the viewer; enemy projectiles are not
+// carried either, too many for the stream to stay small.
+//
+// Entities are keyed by their handle slot. Writer and reader both keep a
+// dead-reckoning model of every entity in 1/4096 px fixed point and step
+// it by its velocity each tick; the writer only emits spawns, removals,
+// health and velocity changes, and a correction when the model's 1/8 px
+// position would differ from the game's. The player is predicted from its
+// last two positions. Ticks with nothing to say cost a byte or less.
+//
+// A keyframe with the full state is written every `keyframeInterval`
+// ticks, so a reader can start from any keyframe and Seek to any tick.
+//
+// Layout, all little-endian, numbers as LEB128 varints (z: zigzag):
+//   header (32 bytes)
+//     char[4] magic "SDGS", u16 version, u16 header size
+//     u16 tick rate, u16 viewport width, u16 viewport height, u16 frame rate
+//     u32 keyframe interval, u32 reserved, u64 RNG seed of the run
+//   records
+//     0x00                  one tick, nothing changed
+//     0x01..0x07            one tick; bit 0 player, bit 1 bullets,
+//                           bit 2 enemies sections follow
+//     0x10 n                n ticks, nothing changed
+//     0x20 tick state       keyframe at `tick`, replaces that tick's delta
+//     0x30 ...              end: keyframe index, then u32 offset of the
+//                           0x30 byte and "SDGE" as the last 8 bytes
+//   player section   u8 mask (1 position, 2 health, 4 score, 8 wave,
+//                    16 state, 32 invincible) then z fields in that order;
+//                    position is the residual from the prediction
+//   entity section   count, then per change: slot gap, u8 mask (1 spawn,
+//                    2 remove, 4 position, 8 velocity, 16 health) and the
+//                    z fields; spawn carries position, velocity and health
+
+// 1/8 px: the precision a reader is guaranteed
+struct GhostEntity {
+    uint32_t id;      // handle slot
+    int32_t x8;
+    int32_t y8;
+    int32_t health;
+    
+    Vec2 Position() const { return Vec2(x8 / 8.0f, y8 / 8.0f); }
+    bool operator==(const GhostEntity& o) const {
+        return id == o.id && x8 == o.x8 && y8 == o.y8 && health == o.health;
+    }
+};
+
+struct GhostFrame {
+    uint64_t tick = 0;
+    GameState state = MENU;
+    int32_t playerX8 = 0;
+    int32_t playerY8 = 0;
+    int32_t health = 0;
+    int32_t score = 0;
+    int32_t wave = 0;
+    bool invincible = false;
+    std::vector<GhostEntity> bullets;   // ascending id
+    std::vector<GhostEntity> enemies;
+    
+    Vec2 PlayerPosition() const { return Vec2(playerX8 / 8.0f, playerY8 / 8.0f); }
+    bool operator==(const GhostFrame& o) const;
+    bool operator!=(const GhostFrame& o) const { return !(*this == o); }
+    // FNV-1a of the fields above, for cheap comparisons
+    uint64_t Hash() const;
+    
+    // What a reader reproduces for `game` at its current tick
+    static void Capture(const SpaceShooter& game, GhostFrame& out);
+};
+
+struct StateStreamHeader {
+    uint64_t seed = 0;
+    int tickRate = 60;
+    // Updates per second of the recording run. Autopilot input is polled
+    // once per update, so re-simulating needs the same rate. 0 in version 1
+    // streams, which did not record it.
+    int frameRate = 60;
+    Viewport viewport;
+    uint32_t keyframeInterval = 1800;   // 30 s at 60 Hz
+};
+
+// Where encoded bytes go: a file, or a loopback link to a reader
+class StreamSink {
+public:
+    virtual ~StreamSink() = default;
+    virtual bool Write(const unsigned char* data, size_t size) = 0;
+};
+
+class FileStreamSink : public StreamSink {
+public:
+    ~FileStreamSink() override { Close(); }
+    bool Open(const std::string& path);
+    bool Close();
+    bool Write(const unsigned char* data, size_t size) override;
+    
+private:
+    std::FILE* file = nullptr;
+    bool failed = false;
+};
+
+class StateStreamReader;
+
+// Delivers writes to a reader in packets of at most `packetSize` bytes,
+// the way a socket would, so record reassembly is exercised in-process
+class LoopbackSink : public StreamSink {
+public:
+    LoopbackSink(StateStreamReader& reader, size_t packetSize) : reader(reader), packetSize(packetSize) {}
+    bool Write(const unsigned char* data, size_t size) override;
+    
+private:
+    StateStreamReader& reader;
+    size_t packetSize;
+};
+
+class StateStreamWriter {
+public:
+    // The sink must outlive the writer or the next Close
+    bool Open(StreamSink& sink, const StateStreamHeader& header);
+    // Called after every tick (SpaceShooter::SetStateStream does that)
+    void Record(const SpaceShooter& game);
+    // Flushes pending idle ticks and writes the keyframe index
+    bool Close();
+    
+    // Low latency hands every tick to the sink at once, idle ones included,
+    // so a spectator is never behind; costs a byte per idle tick. Otherwise
+    // idle ticks are run-length coded and writes batched into a few KB.
+    void SetLowLatency(bool enabled) { lowLatency = enabled; }
+    bool IsOpen() const { return sink != nullptr; }
+    uint64_t BytesWritten() const { return written; }
+    int KeyframeCount() const { return (int)keyTicks.size(); }
+    
+private:
+    struct Model {
+        uint32_t generation;
+        int32_t x, y, vx, vy;   // 1/4096 px
+        int32_t health;
+        bool live;
+    };
+    struct Staged {
+        uint64_t tick;          // staged this tick if equal to the current tick
+        uint32_t generation;
+        int32_t x, y, vx, vy;
+        int32_t health;
+    };
+    struct Kind {
+        std::vector<Model> models;
+        std::vector<Staged> staged;
+    };
+    
+    void Stage(const Archetype& archetype, Kind& kind, uint64_t tick);
+    void WriteKeyframe(const SpaceShooter& game, uint64_t tick);
+    bool WriteEntityDelta(Kind& kind, bool withHealth);
+    void FlushIdle();
+    void Emit();
+    
+    StreamSink* sink = nullptr;
+    StateStreamHeader header;
+    bool lowLatency = false;
+    std::vector<unsigned char> out;      // encoded, not yet handed to the sink
+    std::vector<unsigned char> section;  // scratch for entity sections
+    std::vector<unsigned char> playerBytes, bulletBytes, enemyBytes;
+    uint64_t written = 0;
+    uint64_t lastTick = 0;
+    bool started = false;
+    uint32_t idleTicks = 0;
+    std::vector<uint64_t> keyTicks;
+    std::vector<uint64_t> keyOffsets;
+    
+    GhostFrame player;                   // entity lists unused
+    int32_t prevPlayerX8 = 0, prevPlayerY8 = 0;
+    Kind bullets;
+    Kind enemies;
+};
+
+// Decodes a stream fed to it in pieces of any size; Next() returns ticks
+// once their records are complete. Everything fed is kept, so Seek works
+// over the whole stream.
+class StateStreamReader {
+public:
+    // Reads a whole stream file, using its keyframe index if it has one
+    bool Open(const std::string& path);
+    void Feed(const unsigned char* data, size_t size);
+    
+    // Header fields are valid once HasHeader()
+    bool HasHeader() const { return headerParsed; }
+    const StateStreamHeader& Header() const { return header; }
+    
+    // Decodes the next tick; false if more bytes are needed, at the end of
+    // the stream, or on an error (see Error())
+    bool Next(GhostFrame& frame);
+    // Rebuilds `tick` from the nearest keyframe at or before it
+    bool Seek(uint64_t tick, GhostFrame& frame);
+    
+    bool Ended() const { return ended; }
+    const char* Error() const { return error; }
+    // Keyframes from the index, or those decoded so far without one
+    int KeyframeCount() const { return (int)keyTicks.size(); }
+    size_t BytesFed() const { return data.size(); }
+    
+private:
+    struct Model {
+        int32_t x, y, vx, vy;
+        int32_t health;
+        bool live;
+    };
+    
+    bool ParseHeader();
+    bool ReadIndex();
+    // One record from `cursor`; false with cursor unchanged if incomplete
+    bool DecodeRecord();
+    // Sections are parsed once with apply = false to check they are
+    // complete, then again to update the models
+    bool ReadPlayer(const unsigned char*& p, const unsigned char* end, bool apply);
+    bool ReadEntities(const unsigned char*& p, const unsigned char* end, std::vector<Model>& models,
+                      bool withHealth, bool keyframe, bool apply);
+    void Step();
+    void Output(GhostFrame& frame) const;
+    
+    std::vector<unsigned char> data;
+    size_t cursor = 0;
+    bool headerParsed = false;
+    bool ended = false;
+    const char* error = nullptr;
+    StateStreamHeader header;
+    
+    uint64_t tick = 0;
+    bool started = false;
+    uint32_t idleLeft = 0;     // idle ticks still to hand out
+    bool ready = false;        // a decoded tick waits for Next()
+    std::vector<uint64_t> keyTicks;
+    std::vector<size_t> keyOffsets;
+    
+    GhostFrame player;
+    int32_t prevPlayerX8 = 0, prevPlayerY8 = 0;
+    std::vector<Model> bullets;
+    std::vector<Model> enemies;
+};
@@ -0,0 +1,150 @@
+#include "swept_collision.hpp"
+#include <cmath>
+#include "simd_support.hpp"
+
+// Clang contracts a * b + c into an FMA by default, which arm64 always
+// has; the vector kernels never fuse, so the scalar one must not either
+#ifdef __clang__
+    #pragma STDC FP_CONTRACT OFF
+#endif
+
+// With c = |offset|^2 - radius^2, a = |motion|^2 and b = offset . motion,
+// contact starts at the smaller root of  a t^2 + 2 b t + c = 0. Only pairs
+// closing in (b < 0) with a real root can touch, and then the root is >= 0.
+static void SweptScalar(const SweptPairArrays& p, int count) {
+    for (int i = 0; i < count; i++) {
+        float x = p.x[i], y = p.y[i], dx = p.dx[i], dy = p.dy[i], r = p.radius[i];
+        float c = (x * x + y * y) - r * r;
+        float a = dx * dx + dy * dy;
+        float b = x * dx + y * dy;
+        float disc = b * b - a * c;
+        float toi = SWEPT_MISS;
+        if (c <= 0) {
+            toi = 0;
+        } else if (b < 0 && disc >= 0) {
+            float t = (-b - std::sqrt(disc)) / a;
+            if (t <= 1) toi = t;
+        }
+        p.toi[i] = toi;
+    }
+}
+
+// The last count % width pairs of a batch; a batch is rarely a multiple of
+// the vector width, so every call ends here
+static void SweptTail(const SweptPairArrays& p, int start, int count) {
+    SweptPairArrays tail{p.x + start, p.y + start, p.dx + start, p.dy + start, p.radius + start, p.toi + start};
+    SweptScalar(tail, count - start);
+}
+
+// The vector kernels evaluate every lane and mask the result, so lanes
+// that miss may divide by zero or take the root of a negative; those
+// values are discarded. 0 - b equals the scalar -b wherever b < 0.
+
+#ifdef SIMD_HAVE_SSE2
+static void SweptSSE2(const SweptPairArrays& p, int count) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 miss = _mm_set1_ps(SWEPT_MISS);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(p.x + i), y = _mm_loadu_ps(p.y + i);
+        __m128 dx = _mm_loadu_ps(p.dx + i), dy = _mm_loadu_ps(p.dy + i);
+        __m128 r = _mm_loadu_ps(p.radius + i);
+        __m128 c = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(r, r));
+        __m128 a = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 b = _mm_add_ps(_mm_mul_ps(x, dx), _mm_mul_ps(y, dy));
+        __m128 disc = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c));
+        __m128 t = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(zero, b), _mm_sqrt_ps(disc)), a);
+        __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(b, zero), _mm_cmpge_ps(disc, zero)), _mm_cmple_ps(t, one));
+        __m128 toi = _mm_or_ps(_mm_and_ps(hit, t), _mm_andnot_ps(hit, miss));
+        _mm_storeu_ps(p.toi + i, _mm_andnot_ps(_mm_cmple_ps(c, zero), toi));
+    }
+    SweptTail(p, i, count);
+}
+#endif
+
+#ifdef SIMD_HAVE_AVX2
+__attribute__((target("avx2")))
+static void SweptAVX2(const SweptPairArrays& p, int count) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 miss = _mm256_set1_ps(SWEPT_MISS);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(p.x + i), y = _mm256_loadu_ps(p.y + i);
+        __m256 dx = _mm256_loadu_ps(p.dx + i), dy = _mm256_loadu_ps(p.dy + i);
+        __m256 r = _mm256_loadu_ps(p.radius + i);
+        __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(r, r));
+        __m256 a = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        __m256 b = _mm256_add_ps(_mm256_mul_ps(x, dx), _mm256_mul_ps(y, dy));
+        __m256 disc = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(a, c));
+        __m256 t = _mm256_div_ps(_mm256_sub_ps(_mm256_sub_ps(zero, b), _mm256_sqrt_ps(disc)), a);
+        __m256 hit = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(b, zero, _CMP_LT_OQ), _mm256_cmp_ps(disc, zero, _CMP_GE_OQ)),
+                                   _mm256_cmp_ps(t, one, _CMP_LE_OQ));
+        __m256 toi = _mm256_blendv_ps(miss, t, hit);
+        _mm256_storeu_ps(p.toi + i, _mm256_andnot_ps(_mm256_cmp_ps(c, zero, _CMP_LE_OQ), toi));
+    }
+    SweptTail(p, i, count);
+}
+#endif
+
+#ifdef SIMD_HAVE_NEON
+static void SweptNEON(const SweptPairArrays& p, int count) {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t miss = vdupq_n_f32(SWEPT_MISS);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t x = vld1q_f32(p.x + i), y = vld1q_f32(p.y + i);
+        float32x4_t dx = vld1q_f32(p.dx + i), dy = vld1q_f32(p.dy + i);
+        float32x4_t r = vld1q_f32(p.radius + i);
+        float32x4_t c = vsubq_f32(vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y)), vmulq_f32(r, r));
+        float32x4_t a = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy));
+        float32x4_t b = vaddq_f32(vmulq_f32(x, dx), vmulq_f32(y, dy));
+        float32x4_t disc = vsubq_f32(vmulq_f32(b, b), vmulq_f32(a, c));
+        float32x4_t t = vdivq_f32(vsubq_f32(vsubq_f32(zero, b), vsqrtq_f32(disc)), a);
+        uint32x4_t hit = vandq_u32(vandq_u32(vcltq_f32(b, zero), vcgeq_f32(disc, zero)), vcleq_f32(t, one));
+        float32x4_t toi = vbslq_f32(hit, t, miss);
+        vst1q_f32(p.toi + i, vbslq_f32(vcleq_f32(c, zero), zero, toi));
+    }
+    SweptTail(p, i, count);
+}
+#endif
+
+SweptTestFn GetSweptKernel(ParticleKernel kernel) {
+    if (!IsParticleKernelAvailable(kernel)) return nullptr;
+    switch (kernel) {
+        case ParticleKernel::Scalar: return SweptScalar;
+#ifdef SIMD_HAVE_SSE2
+        case ParticleKernel::SSE2: return SweptSSE2;
+#endif
+#ifdef SIMD_HAVE_AVX2
+        case ParticleKernel::AVX2: return SweptAVX2;
+#endif
+#ifdef SIMD_HAVE_NEON
+        case ParticleKernel::NEON: return SweptNEON;
+#endif
+        default: return nullptr;
+    }
+}
+
+void SweptCircleTest(const SweptPairArrays& p, int count) {
+    // Picked on the first batch and fixed for the run; unlike the particle
+    // kernel there is no override, check-kernels reaches the others through
+    // GetSweptKernel
+    static const SweptTestFn best = GetSweptKernel(BestParticleKernel());
+    best(p, count);
+}
+
+void SweptPairBatch::Resolve(int* hits, float* times) {
+    Test();
+    for (int k = 0; k < count; k++) {
+        int s = slot[k];
+        float t = toi[k];
+        if (t < times[s] || (t == times[s] && hits[s] >= 0 && id[k] < hits[s])) {
+            times[s] = t;
+            hits[s] = id[k];
+        }
+    }
+    count = 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "particle_simd.hpp"
+#include "types.hpp"
+
+// Swept circle-vs-circle test over one tick. For each pair, with `offset`
+// the second centre minus the first at the start of the tick, `motion` the
+// second circle's movement minus the first's and `radius` the sum of the
+// radii, finds the first t in [0, 1] with  |offset + motion * t| <= radius.
+// Pairs overlapping at the start report 0, pairs that never touch during
+// the tick report SWEPT_MISS.
+//
+// Same rules as the particle kernels: every implementation performs the
+// same IEEE operations in the same order (no FMA, no reassociation, sqrt
+// and division correctly rounded), so all kernels are bit-identical to the
+// scalar one. Kernels are selected by the same instruction set ids.
+
+const float SWEPT_MISS = 2.0f;
+
+struct SweptPairArrays {
+    const float* x;        // offset
+    const float* y;
+    const float* dx;       // motion
+    const float* dy;
+    const float* radius;
+    float* toi;            // out: time of first contact
+};
+
+typedef void (*SweptTestFn)(const SweptPairArrays& p, int count);
+
+// nullptr if the kernel is not available on this build and CPU
+SweptTestFn GetSweptKernel(ParticleKernel kernel);
+
+// Runs BestParticleKernel()'s instruction set
+void SweptCircleTest(const SweptPairArrays& p, int count);
+
+// Pairs are appended one at a time as the broadphase finds them and tested
+// a full batch at a time. `slot` and `id` are the caller's, e.g. which
+// result a pair reduces into and which object it hit.
+struct SweptPairBatch {
+    static const int CAPACITY = 256;
+    
+    float x[CAPACITY];
+    float y[CAPACITY];
+    float dx[CAPACITY];
+    float dy[CAPACITY];
+    float radius[CAPACITY];
+    float toi[CAPACITY];
+    int slot[CAPACITY];
+    int id[CAPACITY];
+    int count = 0;
+    
+    bool Full() const { return count == CAPACITY; }
+    
+    void Add(int pairSlot, int pairId, Vec2 offset, Vec2 motion, float radii) {
+        x[count] = offset.x;
+        y[count] = offset.y;
+        dx[count] = motion.x;
+        dy[count] = motion.y;
+        radius[count] = radii;
+        slot[count] = pairSlot;
+        id[count] = pairId;
+        count++;
+    }
+    
+    // Fills toi for the pairs added so far
+    void Test() {
+        SweptCircleTest(SweptPairArrays{x, y, dx, dy, radius, toi}, count);
+    }
+    
+    // Tests the batch, keeps the earliest contact per slot in hits[slot] and
+    // times[slot], and empties it. Ties go to the lowest id, so the result
+    // does not depend on query order, batch boundaries or thread count.
+    void Resolve(int* hits, float* times);
+};
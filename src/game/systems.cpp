@@ -0,0 +1,55 @@
+#include "systems.hpp"
+#include <cstring>
+
+void SavePreviousSystem(Archetype& a) {
+    int n = a.Size();
+    if (a.Has(COMP_POSITION | COMP_PREV_POSITION) && n > 0) {
+        std::memcpy(a.Column(COL_PREV_X), a.Column(COL_X), sizeof(float) * n);
+        std::memcpy(a.Column(COL_PREV_Y), a.Column(COL_Y), sizeof(float) * n);
+    }
+    if (a.Has(COMP_SPIN) && n > 0) {
+        std::memcpy(a.Column(COL_PREV_ROTATION), a.Column(COL_ROTATION), sizeof(float) * n);
+    }
+}
+
+void MoveSystem(Archetype& a, int begin, int end) {
+    if (!a.Has(COMP_POSITION | COMP_VELOCITY)) return;
+    float* x = a.Column(COL_X);
+    float* y = a.Column(COL_Y);
+    const float* vx = a.Column(COL_VX);
+    const float* vy = a.Column(COL_VY);
+    for (int i = begin; i < end; i++) {
+        x[i] += vx[i];
+        y[i] += vy[i];
+    }
+}
+
+void SpinSystem(Archetype& a, float tickScale, int begin, int end) {
+    if (!a.Has(COMP_SPIN)) return;
+    float* rotation = a.Column(COL_ROTATION);
+    float* prevRotation = a.Column(COL_PREV_ROTATION);
+    const float* spin = a.Column(COL_SPIN);
+    for (int i = begin; i < end; i++) {
+        rotation[i] += spin[i] * tickScale;
+        // Keep the angle small so float precision holds in long sessions
+        if (rotation[i] >= 360.0f) {
+            rotation[i] -= 360.0f;
+            prevRotation[i] -= 360.0f;
+        } else if (rotation[i] < 0.0f) {
+            rotation[i] += 360.0f;
+            prevRotation[i] += 360.0f;
+        }
+    }
+}
+
+void DespawnSystem(Archetype& a, const DespawnBounds& bounds, int begin, int end) {
+    if (!a.Has(COMP_POSITION)) return;
+    const float* x = a.Column(COL_X);
+    const float* y = a.Column(COL_Y);
+    uint8_t* alive = a.Alive();
+    for (int i = begin; i < end; i++) {
+        if (x[i] < bounds.minX || x[i] > bounds.maxX || y[i] < bounds.minY || y[i] > bounds.maxY) {
+            alive[i] = 0;
+        }
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "ecs.hpp"
+
+// Systems over archetype columns. Each touches only the components it
+// needs, skips archetypes that lack them, and works on a row range so the
+// caller can split it across a JobSystem.
+
+// Axis-aligned region; entities whose position leaves it are killed
+struct DespawnBounds {
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+};
+
+// PREV_POSITION = POSITION, prevRotation = rotation
+void SavePreviousSystem(Archetype& a);
+
+// POSITION += VELOCITY
+void MoveSystem(Archetype& a, int begin, int end);
+
+// rotation += spin * tickScale, wrapped to [0, 360) with the previous angle
+// shifted alongside so interpolation stays continuous
+void SpinSystem(Archetype& a, float tickScale, int begin, int end);
+
+// Clears alive for rows outside the bounds
+void DespawnSystem(Archetype& a, const DespawnBounds& bounds, int begin, int end);
@@ -0,0 +1,34 @@
+#include "text_layout.hpp"
+#include <cstdio>
+
+static long formatCount = 0;
+static long measureCount = 0;
+
+long CachedText::FormatCount() { return formatCount; }
+long CachedText::MeasureCount() { return measureCount; }
+
+void CachedText::Measure(MeasureTextFn measure) {
+    width = measure ? measure(text, fontSize) : 0;
+    measureCount++;
+}
+
+bool CachedText::Set(const char* literal, int size, MeasureTextFn measure) {
+    if (text == literal && format == nullptr && fontSize == size) return false;
+    text = literal;
+    format = nullptr;
+    fontSize = size;
+    Measure(measure);
+    return true;
+}
+
+bool CachedText::SetInt(const char* fmt, int newValue, int size, MeasureTextFn measure) {
+    if (format == fmt && value == newValue && fontSize == size) return false;
+    format = fmt;
+    value = newValue;
+    fontSize = size;
+    std::snprintf(buffer, sizeof(buffer), fmt, newValue);
+    formatCount++;
+    text = buffer;
+    Measure(measure);
+    return true;
+}
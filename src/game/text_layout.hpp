@@ -0,0 +1,81 @@
+#pragma once
+#include <vector>
+#include "types.hpp"
+#include "viewport.hpp"
+
+// Retained text for the HUD and menus. A CachedText re-formats and
+// re-measures only when its value, format or font size changes, and a
+// TextDrawList keeps the positioned draws until something in it changes,
+// so steady-state UI drawing does no formatting or measuring at all.
+// Measuring is injected (raylib's MeasureText in the game) to keep this
+// usable without a window.
+
+typedef int (*MeasureTextFn)(const char* text, int fontSize);
+
+class CachedText {
+public:
+    static const int MAX_LENGTH = 64;
+    
+    // `literal` must outlive the cache (string literals); returns true if changed
+    bool Set(const char* literal, int fontSize, MeasureTextFn measure);
+    // Formats `format` with one int, e.g. "SCORE: %d"; returns true if changed
+    bool SetInt(const char* format, int value, int fontSize, MeasureTextFn measure);
+    
+    const char* Text() const { return text; }
+    int Width() const { return width; }
+    int FontSize() const { return fontSize; }
+    
+    // Format and measure calls made by every CachedText, for checking that
+    // steady-state frames do none
+    static long FormatCount();
+    static long MeasureCount();
+    
+private:
+    void Measure(MeasureTextFn measure);
+    
+    char buffer[MAX_LENGTH] = {};
+    const char* text = "";
+    const char* format = nullptr;
+    int value = 0;
+    int fontSize = -1;
+    int width = 0;
+};
+
+struct TextCommand {
+    const CachedText* text;
+    int x;
+    int y;
+    Rgba color;
+};
+
+class TextDrawList {
+public:
+    // Room for the largest screen (the menu), so a screen first shown after
+    // warm-up, like the first game over, does not allocate
+    static const int RESERVED_COMMANDS = 8;
+    
+    TextDrawList() { commands.reserve(RESERVED_COMMANDS); }
+    
+    // True when the list must be rebuilt: first use, viewport change or Invalidate()
+    bool NeedsRebuild(const Viewport& viewport) const { return dirty || viewport != key; }
+    void Invalidate() { dirty = true; }
+    
+    void Begin(const Viewport& viewport) {
+        commands.clear();
+        key = viewport;
+        dirty = false;
+    }
+    void Add(const CachedText& text, int x, int y, Rgba color) {
+        commands.push_back(TextCommand{&text, x, y, color});
+    }
+    void AddCentered(const CachedText& text, int centerX, int y, Rgba color) {
+        Add(text, centerX - text.Width() / 2, y, color);
+    }
+    
+    const std::vector<TextCommand>& Commands() const { return commands; }
+    
+private:
+    std::vector<TextCommand> commands;
+    Viewport key;
+    bool dirty = true;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+// Plain value types shared by the simulation core. The core never includes
+// raylib so it can be built and run on machines without a GPU.
+
+constexpr float DEG_TO_RAD = 3.14159265358979323846f / 180.0f;
+
+struct Vec2 {
+    float x;
+    float y;
+    
+    constexpr Vec2() : x(0), y(0) {}
+    constexpr Vec2(float x, float y) : x(x), y(y) {}
+};
+
+struct Rgba {
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+};
+
+// A coloured 2D vertex, as submitted to the GPU in batches
+struct MeshVertex {
+    float x;
+    float y;
+    Rgba color;
+};
+
+// How much cosmetic particle work the simulation does, in percent of full
+// detail. Integers so a recorded session replays bit-exact.
+struct EffectDetail {
+    int particlePercent = 100;   // particles per explosion
+    int trailPercent = 100;      // engine trail puffs actually emitted
+    
+    bool operator==(const EffectDetail& o) const {
+        return particlePercent == o.particlePercent && trailPercent == o.trailPercent;
+    }
+    bool operator!=(const EffectDetail& o) const { return !(*this == o); }
+};
+
+// Same values as the raylib palette so the renderer can pass them straight through
+namespace Palette {
+    constexpr Rgba Red       {230, 41, 55, 255};
+    constexpr Rgba Orange    {255, 161, 0, 255};
+    constexpr Rgba Blue      {0, 121, 241, 255};
+    constexpr Rgba Purple    {200, 122, 255, 255};
+    constexpr Rgba Pink      {255, 109, 194, 255};
+    constexpr Rgba Yellow    {253, 249, 0, 255};
+    constexpr Rgba SkyBlue   {102, 191, 255, 255};
+    constexpr Rgba DarkBlue  {0, 82, 172, 255};
+    constexpr Rgba Lime      {0, 158, 47, 255};
+    constexpr Rgba LightGray {200, 200, 200, 255};
+    constexpr Rgba White     {255, 255, 255, 255};
+    constexpr Rgba Black     {0, 0, 0, 255};
+}
+
+// Linear blend between two states, used for render interpolation
+inline Vec2 Interpolate(Vec2 from, Vec2 to, float t) {
+    return Vec2(from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t);
+}
+
+// Equivalent to raylib's CheckCollisionCircles without the square root
+inline bool CirclesOverlap(Vec2 center1, float radius1, Vec2 center2, float radius2) {
+    float dx = center2.x - center1.x;
+    float dy = center2.y - center1.y;
+    float radii = radius1 + radius2;
+    return dx * dx + dy * dy <= radii * radii;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Screen metrics the simulation runs against. The window build fills this
+// from raylib every frame, the headless build uses a fixed size.
+struct Viewport {
+    int width;
+    int height;
+    
+    constexpr Viewport() : width(800), height(600) {}
+    constexpr Viewport(int w, int h) : width(w), height(h) {}
+    
+    int GetGameWidth() const { return width; }
+    int GetGameHeight() const { return height; }
+    bool IsPortrait() const { return height > width; }
+    bool IsLandscape() const { return width >= height; }
+    
+    bool operator==(const Viewport& other) const { return width == other.width && height == other.height; }
+    bool operator!=(const Viewport& other) const { return !(*this == other); }
+    
+    // Game constants - will be scaled based on screen size
+    float GetScaleFactor() const {
+        float baseWidth = IsPortrait() ? 600.0f : 800.0f;
+        return width / baseWidth;
+    }
+};
+
+constexpr float BASE_PLAYER_SPEED = 5.0f;
+constexpr float BASE_BULLET_SPEED = 8.0f;
+constexpr float BASE_ENEMY_SPEED = 2.0f;
+constexpr float BASE_PLAYER_RADIUS = 15.0f;
+constexpr float BASE_BULLET_RADIUS = 4.0f;
+constexpr float BASE_ENEMY_RADIUS = 15.0f;
+// Initial pool sizes; the pools double on demand up to the limits
+const int MAX_BULLETS = 50;
+const int MAX_ENEMIES = 20;
+const int BULLET_POOL_LIMIT = 1 << 16;
+const int ENEMY_POOL_LIMIT = 1 << 14;
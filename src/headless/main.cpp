@@ -0,0 +1,766 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "game/alloc_counter.hpp"
+#include "game/enemy_tables.hpp"
+#include "game/headless_services.hpp"
+#include "game/input_log.hpp"
+#include "game/particle_simd.hpp"
+#include "game/profiler.hpp"
+#include "game/quality_governor.hpp"
+#include "game/scene_recorder.hpp"
+#include "game/snapshot.hpp"
+#include "game/software_raster.hpp"
+#include "game/space_shooter.hpp"
+#include "game/state_stream.hpp"
+#include "game/swept_collision.hpp"
+
+// Runs the simulation without a window:
+//   headless [--ticks N] [--seed S] [--size WxH] [--particles N]
+//            [--tick-rate HZ] [--frame-rate FPS] [--threads N] [--record FILE]
+//            [--profile FILE.json|FILE.csv] [--check-allocs WARMUP_TICKS]
+//            [--quality LEVEL]   (effect detail of a QualityGovernor level)
+//            [--load-snapshot FILE] [--save-snapshot FILE]
+//            (a loaded snapshot replaces seed, tick rate, viewport and
+//            budget; --ticks still counts from tick 0)
+//            [--stream FILE]   (state stream for ghosts and spectating)
+//            [--loopback PACKET_BYTES]   (stream through an in-process link
+//            in packets of that size and check every tick as it arrives)
+//            [--render EVERY]   (software-render every EVERY-th frame and
+//            report fill cost and overdraw)
+//            [--frames-out DIR] [--frames-check DIR]   (write the rendered
+//            frames as PPM, or compare them with ones written before;
+//            every 600th frame unless --render says otherwise)
+//            [--enemies FILE]   (enemy and wave tables instead of the
+//            built-in set; also for --replay and --verify-stream, which
+//            only reproduce under the tables they were recorded with)
+//   headless --replay FILE [--threads N] [--profile FILE] [--stream FILE]
+//            (seed, tick rate, viewport and particle budget come from the log)
+//   headless --verify-stream FILE [--replay LOG]
+//            (re-simulates the run, from the stream's seed with the autopilot
+//            or from LOG, and checks every tick and keyframe seeks)
+//   headless check-kernels   (SIMD kernels vs scalar, exit code 1 on mismatch)
+//   headless check-governor  (quality governor on synthetic frame timings)
+//   headless write-enemies FILE   (the built-in enemy tables, as a starting point)
+
+struct Options {
+    long ticks = 100000;
+    uint64_t seed = 1;
+    int width = 800;
+    int height = 600;
+    int particleBudget = ParticleManager::DEFAULT_CAPACITY;
+    int tickRate = DEFAULT_TICK_RATE;
+    int frameRate = DEFAULT_TICK_RATE;  // how often the fake clock "renders"
+    int threads = 1;                    // including the main thread
+    std::string recordPath;
+    std::string replayPath;
+    std::string profilePath;  // profiler builds only
+    long allocWarmup = -1;    // debug builds only; < 0 disables the check
+    int quality = 0;
+    std::string loadSnapshotPath;
+    std::string saveSnapshotPath;   // written after the last tick
+    std::string streamPath;
+    std::string verifyStreamPath;
+    int loopbackPacket = 0;         // > 0 streams through a LoopbackSink
+    int renderEvery = 0;            // > 0 software-renders every Nth frame
+    std::string framesOutPath;
+    std::string framesCheckPath;
+    std::string enemiesPath;
+    EnemyTables enemyTables = BuiltinEnemyTables();
+};
+
+static bool ParseOptions(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "missing value for %s\n", arg);
+            return false;
+        }
+        if (std::strcmp(arg, "--ticks") == 0) opt.ticks = std::atol(value);
+        else if (std::strcmp(arg, "--seed") == 0) opt.seed = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(arg, "--size") == 0) {
+            if (std::sscanf(value, "%dx%d", &opt.width, &opt.height) != 2) {
+                std::fprintf(stderr, "--size expects WxH, got %s\n", value);
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--particles") == 0) opt.particleBudget = std::atoi(value);
+        else if (std::strcmp(arg, "--tick-rate") == 0) opt.tickRate = std::atoi(value);
+        else if (std::strcmp(arg, "--frame-rate") == 0) opt.frameRate = std::atoi(value);
+        else if (std::strcmp(arg, "--threads") == 0) opt.threads = std::atoi(value);
+        else if (std::strcmp(arg, "--record") == 0) opt.recordPath = value;
+        else if (std::strcmp(arg, "--replay") == 0) opt.replayPath = value;
+        else if (std::strcmp(arg, "--profile") == 0) opt.profilePath = value;
+        else if (std::strcmp(arg, "--check-allocs") == 0) opt.allocWarmup = std::atol(value);
+        else if (std::strcmp(arg, "--quality") == 0) opt.quality = std::atoi(value);
+        else if (std::strcmp(arg, "--load-snapshot") == 0) opt.loadSnapshotPath = value;
+        else if (std::strcmp(arg, "--save-snapshot") == 0) opt.saveSnapshotPath = value;
+        else if (std::strcmp(arg, "--stream") == 0) opt.streamPath = value;
+        else if (std::strcmp(arg, "--verify-stream") == 0) opt.verifyStreamPath = value;
+        else if (std::strcmp(arg, "--loopback") == 0) opt.loopbackPacket = std::atoi(value);
+        else if (std::strcmp(arg, "--render") == 0) opt.renderEvery = std::atoi(value);
+        else if (std::strcmp(arg, "--frames-out") == 0) opt.framesOutPath = value;
+        else if (std::strcmp(arg, "--frames-check") == 0) opt.framesCheckPath = value;
+        else if (std::strcmp(arg, "--enemies") == 0) opt.enemiesPath = value;
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            return false;
+        }
+        i++;
+    }
+    if (opt.frameRate <= 0) opt.frameRate = DEFAULT_TICK_RATE;
+    const char* error = nullptr;
+    if (!opt.enemiesPath.empty() && !ReadEnemyTablesFile(opt.enemiesPath, opt.enemyTables, &error)) {
+        std::fprintf(stderr, "cannot load %s: %s\n", opt.enemiesPath.c_str(), error);
+        return false;
+    }
+    if (opt.renderEvery <= 0 && (!opt.framesOutPath.empty() || !opt.framesCheckPath.empty())) opt.renderEvery = 600;
+    if (!opt.loadSnapshotPath.empty() && !opt.recordPath.empty()) {
+        // A log replays from a fresh game; it has no way to carry the snapshot
+        std::fprintf(stderr, "--record cannot start from a snapshot\n");
+        return false;
+    }
+    if (!opt.streamPath.empty() && opt.loopbackPacket > 0) {
+        std::fprintf(stderr, "--stream and --loopback are exclusive\n");
+        return false;
+    }
+#ifndef ENABLE_PROFILER
+    if (!opt.profilePath.empty()) {
+        std::fprintf(stderr, "--profile needs a build with ENABLE_PROFILER (xmake f --profiler=y)\n");
+        return false;
+    }
+#endif
+#ifndef ENABLE_ALLOC_COUNTER
+    if (opt.allocWarmup >= 0) {
+        std::fprintf(stderr, "--check-allocs needs a debug build (ENABLE_ALLOC_COUNTER)\n");
+        return false;
+    }
+#endif
+    return true;
+}
+
+#ifdef ENABLE_ALLOC_COUNTER
+static long allocViolations = 0;
+
+static void CountViolation(const char* scope, uint64_t allocations) {
+    if (allocViolations++ < 10) {
+        std::fprintf(stderr, "%llu heap allocation(s) in %s\n", (unsigned long long)allocations, scope);
+    }
+}
+#endif
+
+// Runs every available SIMD kernel against the scalar one on the same
+// random data, including odd counts that exercise the scalar tail.
+static int CheckKernels() {
+    const int counts[] = {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 1000, 4099};
+    const ParticleKernel kernels[] = {ParticleKernel::SSE2, ParticleKernel::AVX2, ParticleKernel::NEON};
+    ParticleIntegrateFn scalar = GetParticleIntegrator(ParticleKernel::Scalar);
+    SeededRandom rng(12345);
+    int failures = 0;
+    
+    for (ParticleKernel kernel : kernels) {
+        if (!IsParticleKernelAvailable(kernel)) {
+            std::printf("%-6s skipped (not available)\n", ParticleKernelName(kernel));
+            continue;
+        }
+        ParticleIntegrateFn fn = GetParticleIntegrator(kernel);
+        bool ok = true;
+        for (int count : counts) {
+            std::vector<float> a(count * 5), b;
+            for (auto& v : a) v = rng.GetRandomValue(-100000, 100000) / 997.0f;
+            b = a;
+            ParticleArrays pa{a.data(), a.data() + count, a.data() + 2 * count, a.data() + 3 * count, a.data() + 4 * count};
+            ParticleArrays pb{b.data(), b.data() + count, b.data() + 2 * count, b.data() + 3 * count, b.data() + 4 * count};
+            for (int step = 0; step < 60; step++) {
+                scalar(pa, count, 1.0f / 60.0f, ParticleManager::GRAVITY);
+                fn(pb, count, 1.0f / 60.0f, ParticleManager::GRAVITY);
+            }
+            if (!a.empty() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) != 0) {
+                std::printf("%-6s MISMATCH at count %d\n", ParticleKernelName(kernel), count);
+                ok = false;
+            }
+        }
+        if (ok) std::printf("%-6s matches scalar bit for bit\n", ParticleKernelName(kernel));
+        else failures++;
+    }
+    
+    // Swept circle tests: offsets and motions on the scale of a tick, so
+    // the inputs mix overlaps, contacts inside the tick and misses
+    SweptTestFn sweptScalar = GetSweptKernel(ParticleKernel::Scalar);
+    for (ParticleKernel kernel : kernels) {
+        SweptTestFn fn = GetSweptKernel(kernel);
+        if (!fn) continue;
+        bool ok = true;
+        for (int count : counts) {
+            std::vector<float> in(count * 5), a(count), b(count);
+            for (int i = 0; i < count * 4; i++) in[i] = rng.GetRandomValue(-60000, 60000) / 997.0f;
+            for (int i = count * 4; i < count * 5; i++) in[i] = rng.GetRandomValue(500, 30000) / 997.0f;
+            const float* f = in.data();
+            sweptScalar(SweptPairArrays{f, f + count, f + 2 * count, f + 3 * count, f + 4 * count, a.data()}, count);
+            fn(SweptPairArrays{f, f + count, f + 2 * count, f + 3 * count, f + 4 * count, b.data()}, count);
+            if (count > 0 && std::memcmp(a.data(), b.data(), count * sizeof(float)) != 0) {
+                std::printf("%-6s swept MISMATCH at count %d\n", ParticleKernelName(kernel), count);
+                ok = false;
+            }
+        }
+        if (ok) std::printf("%-6s swept matches scalar bit for bit\n", ParticleKernelName(kernel));
+        else failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Synthetic frame cost for one quality level: `update` is per tick and is
+// paid once per 60 Hz tick covered by the frame, `effects` scales with
+// particle detail, `draw` is fixed and `cliff` is extra draw time only at
+// full detail (say, a fill-rate cliff the lower levels stay clear of)
+struct SyntheticLoad {
+    float update;
+    float effects;
+    float draw;
+    float cliff = 0;
+};
+
+struct GovernorScenario {
+    const char* name;
+    int frames;
+    // Load for a given frame; phases switch the load mid-run
+    SyntheticLoad (*load)(int frame);
+    int expectLevel;      // level at the end of the run
+    int maxDecisions;
+};
+
+static void CollectDecision(const QualityDecision& decision, void* user) {
+    static_cast<std::vector<QualityDecision>*>(user)->push_back(decision);
+}
+
+// Runs scripted timing profiles through a QualityGovernor with the default
+// config and checks where it settles and that it does not oscillate. The
+// decision log is printed so thresholds can be tuned against it.
+static int CheckGovernor() {
+    const GovernorScenario scenarios[] = {
+        // Comfortably inside the budget: never touched
+        {"light", 3000, [](int) { return SyntheticLoad{2.0f, 3.0f, 3.0f}; }, 0, 0},
+        // Full effects over budget, "low" fits with no room to climb back
+        {"effects_overload", 3000, [](int) { return SyntheticLoad{3.0f, 12.0f, 5.0f}; }, 2, 2},
+        // A 60 ms hitch every two seconds must not cost any quality
+        {"isolated_spikes", 3000, [](int f) {
+            return SyntheticLoad{2.0f, 3.0f, f % 120 == 0 ? 60.0f : 3.0f};
+        }, 0, 0},
+        // Heavy for ten seconds, then light again: steps down, then all the way back up
+        {"burst_then_recover", 6000, [](int f) {
+            return f < 600 ? SyntheticLoad{4.0f, 16.0f, 4.0f} : SyntheticLoad{1.0f, 2.0f, 2.0f};
+        }, 0, 8},
+        // "medium" has plenty of headroom but "high" falls off a cliff; failed
+        // upshifts must back off instead of flipping every few seconds
+        {"full_detail_cliff", 12000, [](int) { return SyntheticLoad{1.0f, 4.0f, 2.0f, 12.0f}; }, 1, 24},
+        // Fixed CPU cost no effect setting can fix: ends up at 30 FPS
+        {"cpu_bound", 3000, [](int) { return SyntheticLoad{6.0f, 0.0f, 12.0f}; }, 4, 4},
+    };
+    
+    int failures = 0;
+    for (const GovernorScenario& scenario : scenarios) {
+        QualityGovernor governor;
+        std::vector<QualityDecision> decisions;
+        governor.SetLogger(&CollectDecision, &decisions);
+        for (int f = 0; f < scenario.frames; f++) {
+            const QualityLevel& level = governor.Current();
+            SyntheticLoad load = scenario.load(f);
+            float ticks = (float)DEFAULT_TICK_RATE / level.targetFps;
+            float updateMs = load.update * ticks + load.effects * 0.5f * level.effects.particlePercent / 100.0f;
+            float drawMs = load.draw + load.effects * 0.5f * level.effects.trailPercent / 100.0f;
+            if (level.effects.particlePercent == 100) drawMs += load.cliff;
+            governor.Sample(updateMs, drawMs);
+        }
+        
+        bool ok = governor.GetLevel() == scenario.expectLevel && governor.DecisionCount() <= scenario.maxDecisions;
+        std::printf("%-20s %s: level %s (expected %s), %d decision(s) (max %d)\n", scenario.name,
+                    ok ? "ok  " : "FAIL", governor.Current().name, QualityGovernor::Level(scenario.expectLevel).name,
+                    governor.DecisionCount(), scenario.maxDecisions);
+        for (const QualityDecision& decision : decisions) {
+            char line[160];
+            QualityGovernor::FormatDecision(decision, line, sizeof(line));
+            std::printf("    %s\n", line);
+        }
+        if (!ok) failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Writes the profiler's event ring as CSV or Chrome trace JSON by extension
+static bool WriteProfile(const std::string& path) {
+#ifdef ENABLE_PROFILER
+    if (path.empty()) return true;
+    bool csv = path.size() > 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    bool ok = csv ? Profiler::Get().WriteCsv(path.c_str()) : Profiler::Get().WriteChromeTrace(path.c_str());
+    if (!ok) std::fprintf(stderr, "cannot write %s\n", path.c_str());
+    return ok;
+#else
+    (void)path;
+    return true;
+#endif
+}
+
+static double Percentile(std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[i];
+}
+
+static StateStreamHeader StreamHeaderFor(const SpaceShooter& game, uint64_t seed, int frameRate) {
+    StateStreamHeader header;
+    header.seed = seed;
+    header.tickRate = game.GetTickRate();
+    header.frameRate = frameRate;
+    header.viewport = game.GetFrameContext().viewport;
+    return header;
+}
+
+static void PrintStreamStats(const StateStreamWriter& stream, uint64_t ticks, int tickRate) {
+    double seconds = ticks > 0 ? (double)ticks / tickRate : 0.0;
+    std::printf("stream:       %llu bytes, %.0f bytes/s, %.2f bytes/tick, %d keyframes\n",
+                (unsigned long long)stream.BytesWritten(), seconds > 0 ? stream.BytesWritten() / seconds : 0.0,
+                ticks > 0 ? (double)stream.BytesWritten() / ticks : 0.0, stream.KeyframeCount());
+}
+
+// Golden frames may differ by rounding between compilers and CPUs: a pixel
+// counts as changed past this channel difference, and a frame fails when
+// more than one pixel in a thousand changed
+static const int FRAME_TOLERANCE = 8;
+static const int FRAME_CHANGED_PER_MILLE = 1;
+
+// Software-rendered frames for golden-image checks and fill statistics
+class FrameRenderer {
+public:
+    FrameRenderer(const Options& opt, JobSystem& jobs)
+        : opt(opt), scene(&SoftwareRenderBackend::MeasureText), raster(opt.width, opt.height) {
+        raster.SetJobSystem(&jobs);
+        raster.SetOverdrawTracking(true);
+    }
+    
+    // Records, rasterizes and writes or checks one frame; false on a mismatch
+    bool Render(const SpaceShooter& game, long frame) {
+        const Viewport& vp = game.GetFrameContext().viewport;
+        if (vp.width != raster.Width() || vp.height != raster.Height()) raster.Resize(vp.width, vp.height);
+        SceneFrameInfo info{(double)frame / opt.frameRate, (float)opt.renderEvery / opt.frameRate, opt.frameRate};
+        auto start = std::chrono::steady_clock::now();
+        scene.Record(game, info, list);
+        recordMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        raster.Submit(list);
+        
+        const RasterStats& stats = raster.Stats();
+        frames++;
+        binMs += stats.binMs;
+        rasterMs += stats.rasterMs;
+        fragments += stats.fragments;
+        primitives += stats.primitives;
+        if (stats.maxOverdraw > maxOverdraw) maxOverdraw = stats.maxOverdraw;
+        
+        char name[32];
+        std::snprintf(name, sizeof(name), "/frame_%08llu.ppm", (unsigned long long)game.GetTickCount());
+        if (!opt.framesOutPath.empty() && !WritePpm(opt.framesOutPath + name, raster.Pixels(), raster.Width(), raster.Height())) {
+            std::fprintf(stderr, "cannot write %s%s\n", opt.framesOutPath.c_str(), name);
+            mismatches++;
+            return false;
+        }
+        if (opt.framesCheckPath.empty()) return true;
+        int width = 0, height = 0;
+        if (!ReadPpm(opt.framesCheckPath + name, golden, width, height)) {
+            std::fprintf(stderr, "cannot read %s%s\n", opt.framesCheckPath.c_str(), name);
+            mismatches++;
+            return false;
+        }
+        ImageDiff diff = CompareImages(raster.Pixels(), golden, FRAME_TOLERANCE);
+        bool same = width == raster.Width() && height == raster.Height() &&
+                    (long)diff.differing * 1000 <= (long)golden.size() * FRAME_CHANGED_PER_MILLE;
+        if (!same && mismatches++ < 5) {
+            std::fprintf(stderr, "%s: %dx%d vs %dx%d, %d pixels differ (max channel delta %d)\n", name + 1,
+                         raster.Width(), raster.Height(), width, height, diff.differing, diff.maxDelta);
+        }
+        return same;
+    }
+    
+    long Mismatches() const { return mismatches; }
+    
+    void PrintStats(int threads) const {
+        if (frames == 0) return;
+        double pixels = (double)raster.Width() * raster.Height();
+        std::printf("render:       %ld frames at %dx%d, %.1f primitives each, %d threads\n", frames, raster.Width(),
+                    raster.Height(), (double)primitives / frames, threads);
+        std::printf("render ms:    record %.3f, bin %.3f, raster %.3f per frame\n", recordMs / frames,
+                    binMs / frames, rasterMs / frames);
+        std::printf("overdraw:     %.2f fragments per pixel, deepest pixel %d\n",
+                    pixels > 0 ? fragments / (frames * pixels) : 0.0, maxOverdraw);
+        if (!opt.framesOutPath.empty()) std::printf("frames out:   %s\n", opt.framesOutPath.c_str());
+        if (!opt.framesCheckPath.empty()) {
+            std::printf("frames check: %s, %ld of %ld frames differ\n", opt.framesCheckPath.c_str(), mismatches, frames);
+        }
+    }
+    
+private:
+    const Options& opt;
+    SceneRecorder scene;
+    RenderCommandList list;
+    SoftwareRenderBackend raster;
+    std::vector<uint32_t> golden;
+    long frames = 0;
+    long mismatches = 0;
+    double recordMs = 0, binMs = 0, rasterMs = 0;
+    double fragments = 0;
+    long primitives = 0;
+    int maxOverdraw = 0;
+};
+
+// Feeds a recorded session through the simulation tick by tick and reports
+// per-tick timings, so the same real play session can be compared across builds
+static int Replay(const Options& opt) {
+    InputLogReader log;
+    if (!log.Open(opt.replayPath)) {
+        std::fprintf(stderr, "cannot replay %s: %s\n", opt.replayPath.c_str(), log.Error());
+        return 2;
+    }
+    const InputLogHeader& header = log.Header();
+    
+    FixedClock clock(1.0f / header.tickRate);
+    SeededRandom random(header.seed);
+    AutopilotInput input;  // never polled; ticks carry their own input
+    FixedViewport viewport(header.viewport);
+    SpaceShooter game(Services{clock, random, input, viewport});
+    if (header.particleBudget > 0) game.SetParticleBudget((int)header.particleBudget);
+    game.SetTickRate(header.tickRate);
+    game.SetEnemyTables(opt.enemyTables);
+    JobSystem jobs(opt.threads - 1);
+    game.SetJobSystem(&jobs);
+    
+    FileStreamSink streamFile;
+    StateStreamWriter stream;
+    if (!opt.streamPath.empty()) {
+        if (!streamFile.Open(opt.streamPath)) {
+            std::fprintf(stderr, "cannot stream to %s\n", opt.streamPath.c_str());
+            return 2;
+        }
+        StateStreamHeader streamHeader = StreamHeaderFor(game, header.seed, header.tickRate);
+        streamHeader.viewport = header.viewport;
+        stream.Open(streamFile, streamHeader);
+        game.SetStateStream(&stream);
+    }
+    
+    std::vector<double> tickMicros;
+    tickMicros.reserve(header.tickCount);
+    InputLogTick tick;
+    while (log.Next(tick)) {
+        PROFILE_BEGIN_FRAME();
+        auto t0 = std::chrono::steady_clock::now();
+        game.ReplayTick(tick);
+        auto t1 = std::chrono::steady_clock::now();
+        PROFILE_END_FRAME();
+        tickMicros.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+    }
+    if (log.Error()) {
+        std::fprintf(stderr, "replay stopped early: %s\n", log.Error());
+        return 1;
+    }
+    if (stream.IsOpen() && (!stream.Close() || !streamFile.Close())) {
+        std::fprintf(stderr, "failed to write %s\n", opt.streamPath.c_str());
+        return 1;
+    }
+    if (!WriteProfile(opt.profilePath)) return 1;
+    
+    double total = 0;
+    for (double t : tickMicros) total += t;
+    std::sort(tickMicros.begin(), tickMicros.end());
+    
+    std::printf("replay:       %s (%s)\n", opt.replayPath.c_str(), log.IsMapped() ? "mapped" : "streamed");
+    std::printf("ticks:        %zu of %u at %d Hz\n", tickMicros.size(), header.tickCount, header.tickRate);
+    std::printf("seed:         %llu\n", (unsigned long long)header.seed);
+    std::printf("viewport:     %dx%d\n", header.viewport.width, header.viewport.height);
+    std::printf("elapsed:      %.3f s\n", total / 1e6);
+    std::printf("tick us:      mean %.2f, p50 %.2f, p99 %.2f, max %.2f\n",
+                tickMicros.empty() ? 0.0 : total / tickMicros.size(), Percentile(tickMicros, 0.5),
+                Percentile(tickMicros, 0.99), Percentile(tickMicros, 1.0));
+    std::printf("final:        wave %d, score %d, health %d\n",
+                game.GetWave(), game.GetPlayer().score, game.GetPlayer().health);
+    std::printf("threads:      %d\n", jobs.ThreadCount());
+    std::printf("kernel:       %s\n", ParticleKernelName(GetActiveParticleKernel()));
+    if (!opt.streamPath.empty()) PrintStreamStats(stream, tickMicros.size(), header.tickRate);
+    std::printf("state hash:   %016llx\n", (unsigned long long)game.StateHash());
+    return tickMicros.size() == header.tickCount ? 0 : 1;
+}
+
+static void PrintFrameMismatch(const GhostFrame& expected, const GhostFrame& decoded) {
+    std::fprintf(stderr, "tick %llu: stream has player (%d, %d) health %d score %d, %zu bullets, %zu enemies; "
+                 "game has (%d, %d) health %d score %d, %zu bullets, %zu enemies\n",
+                 (unsigned long long)expected.tick, decoded.playerX8, decoded.playerY8, decoded.health, decoded.score,
+                 decoded.bullets.size(), decoded.enemies.size(), expected.playerX8, expected.playerY8,
+                 expected.health, expected.score, expected.bullets.size(), expected.enemies.size());
+}
+
+// Re-simulates the run a stream was recorded from and checks that every
+// decoded tick matches the game, then seeks back and forth through it.
+// Particle budget and quality do not matter: effects draw from their own
+// RNG streams.
+static int VerifyStream(const Options& opt) {
+    StateStreamReader reader;
+    if (!reader.Open(opt.verifyStreamPath)) {
+        std::fprintf(stderr, "cannot read %s: %s\n", opt.verifyStreamPath.c_str(), reader.Error());
+        return 2;
+    }
+    const StateStreamHeader& header = reader.Header();
+    InputLogReader log;
+    bool useLog = !opt.replayPath.empty();
+    if (useLog && !log.Open(opt.replayPath)) {
+        std::fprintf(stderr, "cannot replay %s: %s\n", opt.replayPath.c_str(), log.Error());
+        return 2;
+    }
+    
+    // Without a log the autopilot is polled once per update, so the updates
+    // must land where the recording's did; version 1 streams fall back to
+    // --frame-rate
+    int frameRate = header.frameRate > 0 ? header.frameRate : opt.frameRate;
+    FixedClock clock(1.0f / frameRate);
+    SeededRandom random(header.seed);
+    AutopilotInput input;
+    FixedViewport viewport(header.viewport);
+    SpaceShooter game(Services{clock, random, input, viewport});
+    game.SetTickRate(header.tickRate);
+    game.SetEnemyTables(opt.enemyTables);
+    
+    GhostFrame decoded, expected;
+    std::vector<uint64_t> hashes;   // decoded frame hash by tick, for the seeks
+    long ticks = 0, mismatches = 0;
+    bool simulating = true;
+    while (reader.Next(decoded)) {
+        while (simulating && game.GetTickCount() < decoded.tick) {
+            if (useLog) {
+                InputLogTick tick;
+                if (log.Next(tick)) game.ReplayTick(tick);
+                else simulating = false;
+            } else {
+                game.Update();
+            }
+        }
+        if (!simulating || game.GetTickCount() != decoded.tick) break;
+        GhostFrame::Capture(game, expected);
+        if (expected != decoded && mismatches++ < 5) PrintFrameMismatch(expected, decoded);
+        if (hashes.size() <= decoded.tick) hashes.resize(decoded.tick + 1, 0);
+        hashes[decoded.tick] = decoded.Hash();
+        ticks++;
+    }
+    if (reader.Error()) {
+        std::fprintf(stderr, "stream stopped early: %s\n", reader.Error());
+        return 1;
+    }
+    if (!simulating || game.GetTickCount() != decoded.tick) {
+        std::fprintf(stderr, "simulation cannot reach tick %llu of the stream\n", (unsigned long long)decoded.tick);
+        return 1;
+    }
+    // A stream cut short (the writer crashed) still verifies up to its end
+    if (!reader.Ended()) std::fprintf(stderr, "stream has no end record, checked up to tick %ld\n", ticks);
+    
+    // Backwards, so every seek has to go through the keyframe index
+    long seeks = 0, seekMismatches = 0;
+    for (uint64_t t = hashes.size(); t-- > 1;) {
+        if (hashes[t] == 0 || (t % 997 != 0 && t % (header.keyframeInterval ? header.keyframeInterval : 1) > 1)) {
+            continue;
+        }
+        seeks++;
+        if (!reader.Seek(t, decoded) || decoded.Hash() != hashes[t]) {
+            if (seekMismatches++ < 5) std::fprintf(stderr, "seek to tick %llu failed\n", (unsigned long long)t);
+        }
+    }
+    
+    std::printf("stream:       %s\n", opt.verifyStreamPath.c_str());
+    std::printf("ticks:        %ld at %d Hz (%s)\n", ticks, header.tickRate,
+                useLog ? "input log" : (header.frameRate > 0 ? "autopilot" : "autopilot, --frame-rate"));
+    if (!useLog) std::printf("frame rate:   %d FPS\n", frameRate);
+    std::printf("seed:         %llu\n", (unsigned long long)header.seed);
+    std::printf("viewport:     %dx%d\n", header.viewport.width, header.viewport.height);
+    std::printf("size:         %zu bytes, %.0f bytes/s, %d keyframes\n", reader.BytesFed(),
+                ticks > 0 ? reader.BytesFed() / ((double)ticks / header.tickRate) : 0.0, reader.KeyframeCount());
+    std::printf("mismatches:   %ld ticks, %ld of %ld seeks\n", mismatches, seekMismatches, seeks);
+    return mismatches == 0 && seekMismatches == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "check-kernels") == 0) {
+        return CheckKernels();
+    }
+    if (argc > 1 && std::strcmp(argv[1], "check-governor") == 0) {
+        return CheckGovernor();
+    }
+    if (argc > 2 && std::strcmp(argv[1], "write-enemies") == 0) {
+        if (!WriteEnemyTablesFile(argv[2], BuiltinEnemyTables())) {
+            std::fprintf(stderr, "cannot write %s\n", argv[2]);
+            return 2;
+        }
+        return 0;
+    }
+    
+    Options opt;
+    if (!ParseOptions(argc, argv, opt)) return 2;
+    if (!opt.verifyStreamPath.empty()) return VerifyStream(opt);
+    if (!opt.replayPath.empty()) return Replay(opt);
+    
+    FixedClock clock(1.0f / opt.frameRate);
+    SeededRandom random(opt.seed);
+    AutopilotInput input;
+    FixedViewport viewport(Viewport(opt.width, opt.height));
+    SpaceShooter game(Services{clock, random, input, viewport});
+    game.SetParticleBudget(opt.particleBudget);
+    game.SetTickRate(opt.tickRate);
+    game.SetEffectDetail(QualityGovernor::Level(opt.quality).effects);
+    game.SetEnemyTables(opt.enemyTables);
+    JobSystem jobs(opt.threads - 1);
+    game.SetJobSystem(&jobs);
+    
+    if (!opt.loadSnapshotPath.empty()) {
+        std::vector<unsigned char> bytes;
+        const char* error = "cannot read file";
+        if (!ReadSnapshotFile(opt.loadSnapshotPath, bytes) || !game.LoadSnapshot(bytes.data(), bytes.size(), &error)) {
+            std::fprintf(stderr, "cannot load %s: %s\n", opt.loadSnapshotPath.c_str(), error);
+            return 2;
+        }
+        // Sizes below report the snapshot's game, not the options
+        opt.width = game.GetFrameContext().viewport.width;
+        opt.height = game.GetFrameContext().viewport.height;
+        viewport = FixedViewport(game.GetFrameContext().viewport);
+        input.Seek(game.GetTickCount());
+    }
+    
+    InputLogWriter recorder;
+    if (!opt.recordPath.empty()) {
+        InputLogHeader header;
+        header.seed = opt.seed;
+        header.tickRate = game.GetTickRate();
+        header.viewport = viewport.GetViewport();
+        header.particleBudget = (uint32_t)opt.particleBudget;
+        if (!recorder.Open(opt.recordPath, header)) {
+            std::fprintf(stderr, "cannot record to %s\n", opt.recordPath.c_str());
+            return 2;
+        }
+        game.SetInputRecorder(&recorder);
+    }
+    
+    FileStreamSink streamFile;
+    StateStreamReader spectator;
+    LoopbackSink loopback(spectator, (size_t)std::max(opt.loopbackPacket, 0));
+    StateStreamWriter stream;
+    if (!opt.streamPath.empty()) {
+        if (!streamFile.Open(opt.streamPath)) {
+            std::fprintf(stderr, "cannot stream to %s\n", opt.streamPath.c_str());
+            return 2;
+        }
+        stream.Open(streamFile, StreamHeaderFor(game, opt.seed, opt.frameRate));
+        game.SetStateStream(&stream);
+    } else if (opt.loopbackPacket > 0) {
+        stream.SetLowLatency(true);
+        stream.Open(loopback, StreamHeaderFor(game, opt.seed, opt.frameRate));
+        game.SetStateStream(&stream);
+    }
+    GhostFrame spectated, expected;
+    long spectatedTicks = 0, spectatorMismatches = 0;
+    FrameRenderer renderer(opt, jobs);
+    
+#ifdef ENABLE_ALLOC_COUNTER
+    if (opt.allocWarmup >= 0) SetAllocationViolationHandler(&CountViolation);
+#endif
+    
+    int gamesPlayed = 0;
+    int bestScore = 0;
+    GameState lastState = game.GetState();
+    
+    auto start = std::chrono::steady_clock::now();
+    long frames = 0;
+    while ((long)game.GetTickCount() < opt.ticks) {
+#ifdef ENABLE_ALLOC_COUNTER
+        if (opt.allocWarmup >= 0 && (long)game.GetTickCount() >= opt.allocWarmup) SetAllocationChecksArmed(true);
+#endif
+        PROFILE_BEGIN_FRAME();
+        game.Update();
+        PROFILE_END_FRAME();
+        frames++;
+        if (opt.renderEvery > 0 && frames % opt.renderEvery == 0) renderer.Render(game, frames);
+        if (opt.loopbackPacket > 0) {
+            // Low latency: everything up to the current tick has arrived
+            bool current = false;
+            while (spectator.Next(spectated)) {
+                spectatedTicks++;
+                current = spectated.tick == game.GetTickCount();
+            }
+            if (current) {
+                GhostFrame::Capture(game, expected);
+                if (expected != spectated && spectatorMismatches++ < 5) PrintFrameMismatch(expected, spectated);
+            } else if (game.GetTickCount() > 0 && spectatorMismatches++ < 5) {
+                std::fprintf(stderr, "tick %llu did not reach the spectator\n", (unsigned long long)game.GetTickCount());
+            }
+        }
+        GameState s = game.GetState();
+        if (s == GAME_OVER && lastState != GAME_OVER) {
+            gamesPlayed++;
+            if (game.GetPlayer().score > bestScore) bestScore = game.GetPlayer().score;
+        }
+        lastState = s;
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (recorder.IsOpen() && !recorder.Close()) {
+        std::fprintf(stderr, "failed to write %s\n", opt.recordPath.c_str());
+        return 1;
+    }
+    if (stream.IsOpen() && (!stream.Close() || (!opt.streamPath.empty() && !streamFile.Close()))) {
+        std::fprintf(stderr, "failed to write %s\n", opt.streamPath.c_str());
+        return 1;
+    }
+    if (!WriteProfile(opt.profilePath)) return 1;
+    if (!opt.saveSnapshotPath.empty()) {
+        SnapshotWriter snapshot;
+        game.SaveSnapshot(snapshot);
+        if (!WriteSnapshotFile(opt.saveSnapshotPath, snapshot)) {
+            std::fprintf(stderr, "cannot write %s\n", opt.saveSnapshotPath.c_str());
+            return 1;
+        }
+    }
+    double seconds = std::chrono::duration<double>(end - start).count();
+    
+    long ticks = (long)game.GetTickCount();
+    std::printf("ticks:        %ld at %d Hz (%ld frames at %d FPS)\n", ticks, game.GetTickRate(), frames, opt.frameRate);
+    std::printf("seed:         %llu\n", (unsigned long long)opt.seed);
+    std::printf("viewport:     %dx%d\n", opt.width, opt.height);
+    std::printf("elapsed:      %.3f s\n", seconds);
+    std::printf("ticks/s:      %.0f\n", seconds > 0 ? ticks / seconds : 0.0);
+    std::printf("games over:   %d (best score %d)\n", gamesPlayed, bestScore);
+    std::printf("final:        wave %d, score %d, health %d\n",
+                game.GetWave(), game.GetPlayer().score, game.GetPlayer().health);
+    std::printf("particles:    %d live, %ld dropped (budget %d)\n", game.GetParticles().Count(),
+                game.GetParticles().Dropped(), game.GetParticles().Capacity());
+    std::printf("projectiles:  %d live, %ld dropped (budget %d)\n", game.GetProjectiles().Count(),
+                game.GetProjectiles().Dropped(), game.GetProjectiles().Capacity());
+    std::printf("pools:        bullets %d/%d, enemies %d/%d (dropped %ld/%ld)\n",
+                game.GetBullets().Size(), game.GetBullets().Capacity(),
+                game.GetEnemies().Size(), game.GetEnemies().Capacity(),
+                game.GetBullets().Dropped(), game.GetEnemies().Dropped());
+    std::printf("threads:      %d\n", jobs.ThreadCount());
+    std::printf("kernel:       %s\n", ParticleKernelName(GetActiveParticleKernel()));
+    std::printf("frame arena:  %zu bytes peak of %zu\n", game.GetFrameArena().HighWater(), game.GetFrameArena().Capacity());
+    renderer.PrintStats(jobs.ThreadCount());
+    if (!opt.streamPath.empty() || opt.loopbackPacket > 0) PrintStreamStats(stream, game.GetTickCount(), game.GetTickRate());
+    if (opt.loopbackPacket > 0) {
+        // Drains the end record
+        spectator.Next(spectated);
+        std::printf("loopback:     %ld ticks in %d-byte packets, %ld mismatches%s\n", spectatedTicks,
+                    opt.loopbackPacket, spectatorMismatches, spectator.Ended() ? "" : ", no end record");
+        if (spectatorMismatches > 0 || !spectator.Ended()) return 1;
+    }
+#ifdef ENABLE_ALLOC_COUNTER
+    if (opt.allocWarmup >= 0) {
+        std::printf("allocations:  %ld tick(s) allocated after %ld warm-up ticks\n", allocViolations, opt.allocWarmup);
+        if (allocViolations > 0) return 1;
+    }
+#endif
+    std::printf("state hash:   %016llx\n", (unsigned long long)game.StateHash());
+    return renderer.Mismatches() == 0 ? 0 : 1;
+}
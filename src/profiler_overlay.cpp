@@ -0,0 +1,51 @@
+#include "profiler_overlay.hpp"
+
+#ifdef ENABLE_PROFILER
+#include <cstdio>
+#include <raylib-cpp/raylib-cpp.hpp>
+
+void ProfilerOverlay::Draw(const Profiler& profiler, const FrameContext& frame) const {
+    if (!visible) return;
+    
+    const float budgetMs = 1000.0f / 60.0f;
+    const float graphMaxMs = 2 * budgetMs;
+    int graphWidth = Profiler::FRAME_HISTORY * 2;
+    int graphHeight = (int)(80 * frame.scale);
+    int x0 = 10;
+    int y0 = frame.viewport.height - graphHeight - 40;
+    if (graphWidth > frame.viewport.width - 20) graphWidth = frame.viewport.width - 20;
+    
+    DrawRectangle(x0, y0, graphWidth, graphHeight, {0, 0, 0, 160});
+    
+    // One bar per frame, newest on the right; over budget turns red
+    int count = profiler.FrameCount();
+    float barWidth = (float)graphWidth / Profiler::FRAME_HISTORY;
+    for (int i = 0; i < count; i++) {
+        float ms = profiler.FrameMs(i);
+        float h = ms / graphMaxMs;
+        if (h > 1.0f) h = 1.0f;
+        int barHeight = (int)(h * graphHeight);
+        int x = x0 + graphWidth - (int)((count - i) * barWidth);
+        DrawRectangle(x, y0 + graphHeight - barHeight, (int)barWidth > 0 ? (int)barWidth : 1, barHeight,
+                      ms > budgetMs ? RED : LIME);
+    }
+    int budgetY = y0 + graphHeight - (int)(budgetMs / graphMaxMs * graphHeight);
+    DrawLine(x0, budgetY, x0 + graphWidth, budgetY, YELLOW);
+    
+    char line[96];
+    if (count > 0) {
+        std::snprintf(line, sizeof(line), "frame %.2f ms", profiler.FrameMs(count - 1));
+        DrawText(line, x0 + 4, y0 + 4, 10, WHITE);
+    }
+    
+    // Scope breakdown of the last frame, indented by nesting depth
+    int lineY = 60;
+    for (int i = 0; i < profiler.LastFrameTotalCount(); i++) {
+        const ScopeTotal& t = profiler.LastFrameTotals()[i];
+        std::snprintf(line, sizeof(line), "%*s%-16s %6.3f ms x%d", t.depth * 2, "", t.name, t.ms, t.calls);
+        DrawText(line, x0, lineY, 10, LIGHTGRAY);
+        lineY += 12;
+    }
+}
+
+#endif  // ENABLE_PROFILER
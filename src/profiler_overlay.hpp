@@ -0,0 +1,19 @@
+#pragma once
+#include "game/frame_context.hpp"
+#include "game/profiler.hpp"
+
+#ifdef ENABLE_PROFILER
+
+// Frame-time graph plus the per-scope totals of the last frame, drawn over
+// the game. Only exists in profiler builds.
+class ProfilerOverlay {
+public:
+    void Toggle() { visible = !visible; }
+    bool IsVisible() const { return visible; }
+    void Draw(const Profiler& profiler, const FrameContext& frame) const;
+    
+private:
+    bool visible = false;
+};
+
+#endif  // ENABLE_PROFILER
@@ -0,0 +1,92 @@
+#include "renderer.hpp"
+#include <rlgl.h>
+#include "game/alloc_counter.hpp"
+#include "game/profiler.hpp"
+
+void RaylibRenderBackend::Submit(const RenderCommandList& list) {
+    PROFILE_SCOPE("Submit");
+    ALLOC_FREE_SCOPE("Submit");
+    const CircleInstance* circles = list.Circles();
+    const MeshVertex* vertices = list.Vertices();
+    int transforms = 0;
+    for (const RenderCommand& cmd : list.Commands()) {
+        raylib::Color color = ToRaylib(cmd.color);
+        switch (cmd.op) {
+            case RenderOp::Clear:
+                ClearBackground(color);
+                break;
+            
+            case RenderOp::Circle:
+                DrawCircleV(raylib::Vector2(cmd.v[0], cmd.v[1]), cmd.v[2], color);
+                break;
+            
+            case RenderOp::Rect:
+                DrawRectangleRec(Rectangle{cmd.v[0], cmd.v[1], cmd.v[2], cmd.v[3]}, color);
+                break;
+            
+            case RenderOp::Line:
+                DrawLineV(raylib::Vector2(cmd.v[0], cmd.v[1]), raylib::Vector2(cmd.v[2], cmd.v[3]), color);
+                break;
+            
+            case RenderOp::Text:
+                DrawText(list.TextPool() + cmd.first, (int)cmd.v[0], (int)cmd.v[1], cmd.size, color);
+                break;
+            
+            case RenderOp::Circles:
+                // Batches hold thousands of small particles. Zero segments
+                // lets raylib size the fan to the radius (about 8 at 4 px)
+                // instead of DrawCircleV's fixed 36.
+                for (uint32_t i = cmd.first; i < cmd.first + cmd.count; i++) {
+                    const CircleInstance& c = circles[i];
+                    DrawCircleSector(raylib::Vector2(c.x, c.y), c.radius, 0, 360, 0, ToRaylib(c.color));
+                }
+                break;
+            
+            case RenderOp::Vertices:
+                DrawVertexBatch(vertices + cmd.first, (int)cmd.count,
+                                cmd.mode == (uint8_t)PrimitiveMode::Lines ? RL_LINES : RL_TRIANGLES);
+                break;
+            
+            case RenderOp::SetTransform:
+                rlPushMatrix();
+                rlTranslatef(cmd.v[0], cmd.v[1], 0);
+                rlScalef(cmd.v[2], cmd.v[2], 1);
+                transforms++;
+                break;
+            
+            case RenderOp::ResetTransform:
+                if (transforms > 0) {
+                    rlPopMatrix();
+                    transforms--;
+                }
+                break;
+            
+            case RenderOp::BakeStarLayer:
+                starfieldRenderer.BakeLayer(cmd.size, (int)cmd.v[0], (int)cmd.v[1], cmd.v[2], vertices + cmd.first,
+                                            (int)cmd.count);
+                break;
+            
+            case RenderOp::DrawStars:
+                starfieldRenderer.Draw(cmd.v, cmd.size);
+                break;
+        }
+    }
+    // A list that ends inside a transform must not leak it into the overlay
+    while (transforms-- > 0) rlPopMatrix();
+}
+
+void RaylibRenderBackend::DrawVertexBatch(const MeshVertex* vertices, int count, int mode) {
+    // Chunks divisible by both 2 and 3 so no primitive straddles a batch flush
+    const int CHUNK = 6 * 1024;
+    for (int start = 0; start < count; start += CHUNK) {
+        int end = start + CHUNK < count ? start + CHUNK : count;
+        rlCheckRenderBatchLimit(end - start);
+        rlBegin(mode);
+        for (int i = start; i < end; i++) {
+            const MeshVertex& v = vertices[i];
+            rlColor4ub(v.color.r, v.color.g, v.color.b, v.color.a);
+            rlVertex2f(v.x, v.y);
+        }
+        rlEnd();
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <raylib-cpp/raylib-cpp.hpp>
+#include "game/render_commands.hpp"
+#include "starfield_renderer.hpp"
+
+inline raylib::Vector2 ToRaylib(Vec2 v) { return raylib::Vector2(v.x, v.y); }
+inline raylib::Color ToRaylib(Rgba c) { return raylib::Color(c.r, c.g, c.b, c.a); }
+inline Rgba FromRaylib(::Color c) { return Rgba{c.r, c.g, c.b, c.a}; }
+
+// Replays a recorded frame with raylib immediate-mode calls. Call between
+// BeginDrawing and EndDrawing on the window's thread.
+class RaylibRenderBackend : public RenderBackend {
+public:
+    void Submit(const RenderCommandList& list) override;
+    
+private:
+    static void DrawVertexBatch(const MeshVertex* vertices, int count, int mode);
+    
+    StarfieldRenderer starfieldRenderer;
+};
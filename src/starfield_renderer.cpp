@@ -0,0 +1,49 @@
+#include "starfield_renderer.hpp"
+
+StarfieldRenderer::~StarfieldRenderer() {
+    for (int l = 0; l < Starfield::LAYER_COUNT; l++) {
+        Unload(l);
+    }
+}
+
+void StarfieldRenderer::Unload(int layer) {
+    if (!baked[layer]) return;
+    UnloadRenderTexture(layers[layer]);
+    baked[layer] = false;
+}
+
+void StarfieldRenderer::BakeLayer(int layer, int width, int height, float size, const MeshVertex* stars, int count) {
+    if (layer < 0 || layer >= Starfield::LAYER_COUNT) return;
+    // Same size: draw over the old texture instead of reallocating it
+    if (baked[layer] && (layers[layer].texture.width != width || layers[layer].texture.height != height)) {
+        Unload(layer);
+    }
+    if (!baked[layer]) {
+        layers[layer] = LoadRenderTexture(width, height);
+        baked[layer] = true;
+    }
+    BeginTextureMode(layers[layer]);
+    ClearBackground(BLANK);
+    for (int i = 0; i < count; i++) {
+        const MeshVertex& star = stars[i];
+        raylib::Color color(star.color.r, star.color.g, star.color.b, star.color.a);
+        if (size <= 1.0f) {
+            DrawPixel((int)star.x, (int)star.y, color);
+        } else {
+            DrawRectangleV(raylib::Vector2(star.x, star.y), raylib::Vector2(size, size), color);
+        }
+    }
+    EndTextureMode();
+}
+
+void StarfieldRenderer::Draw(const float* offsets, int layerCount) {
+    for (int l = 0; l < layerCount && l < Starfield::LAYER_COUNT; l++) {
+        if (!baked[l]) continue;
+        float width = (float)layers[l].texture.width;
+        float height = (float)layers[l].texture.height;
+        // Render textures are stored upside down, hence the negative height
+        Rectangle source = {0, 0, width, -height};
+        DrawTextureRec(layers[l].texture, source, raylib::Vector2(0, offsets[l]), WHITE);
+        DrawTextureRec(layers[l].texture, source, raylib::Vector2(0, offsets[l] - height), WHITE);
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <raylib-cpp/raylib-cpp.hpp>
+#include "game/starfield.hpp"
+#include "game/types.hpp"
+
+// Keeps each starfield layer baked into a screen-sized render texture and
+// draws every layer as two wrapped tiles: two draw calls per layer
+// regardless of star count. Layers are baked from the star points recorded
+// in a command list, which only carries them when the starfield regenerates.
+class StarfieldRenderer {
+public:
+    StarfieldRenderer() = default;
+    ~StarfieldRenderer();
+    
+    StarfieldRenderer(const StarfieldRenderer&) = delete;
+    StarfieldRenderer& operator=(const StarfieldRenderer&) = delete;
+    
+    // Stars are points of `size` pixels in layer coordinates
+    void BakeLayer(int layer, int width, int height, float size, const MeshVertex* stars, int count);
+    // offsets[l] scrolls layer l down, wrapping at the layer height
+    void Draw(const float* offsets, int layerCount);
+    
+private:
+    void Unload(int layer);
+    
+    RenderTexture2D layers[Starfield::LAYER_COUNT] = {};
+    bool baked[Starfield::LAYER_COUNT] = {};
+};
@@ -9,9 +9,37 @@ end
 
 add_requires("raylib-cpp 5.5.0")
 
+-- 帧分析器: debug 模式默认开启, release/Android 用 xmake f --profiler=y 开启
+option("profiler")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Enable the frame profiler (overlay, trace export) in release builds")
+option_end()
+
+-- 纯模拟核心，不依赖 raylib，可在无 GPU 的机器上运行
+target("game")
+    set_kind("static")
+    set_languages("c++17")
+    add_files("src/game/*.cpp")
+    add_includedirs("src", {public = true})
+    if is_mode("debug") or has_config("profiler") then
+        add_defines("ENABLE_PROFILER", {public = true})
+    end
+    -- debug 模式统计堆分配, 预热后 UpdateGame/Draw 中出现分配即断言
+    if is_mode("debug") then
+        add_defines("ENABLE_ALLOC_COUNTER", {public = true})
+    end
+    if is_plat("linux") then
+        add_syslinks("pthread", {public = true})
+    end
+    if is_plat("android") then
+        add_cxflags("-fPIC")
+    end
+
 target("cppray")
     set_kind("binary")
     set_languages("c++17")
+    add_deps("game")
     add_files("src/*.cpp") 
     add_packages("raylib-cpp")
     
@@ -26,4 +54,23 @@ target("cppray")
             package_name = "com.game.raygame",
         })
     end
- 
\ No newline at end of file
+
+-- 无窗口运行 N 帧: xmake run headless [--ticks N] [--seed S] [--size WxH] [--particles N] [--tick-rate HZ] [--frame-rate FPS]
+if not is_plat("android") then
+    target("headless")
+        set_kind("binary")
+        set_default(false)
+        set_languages("c++17")
+        add_deps("game")
+        add_files("src/headless/*.cpp")
+
+    -- 性能测试: xmake run bench [broadphase|swept|jobs|starfield|ui|mesh|snapshot|rng|render|raster]
+    -- 压力场景: xmake run bench stress --json out.json --baseline base.json --threshold 15
+    -- 弹幕压力: xmake run bench projectiles --budget-ms 4.17 (超出预算时返回 1)
+    target("bench")
+        set_kind("binary")
+        set_default(false)
+        set_languages("c++17")
+        add_deps("game")
+        add_files("src/bench/*.cpp")
+end